@@ -20,49 +20,60 @@
 import Foundation
 
 protocol ChallengeAPIClientProtocol {
-  func get(withSid sid: String, withFactor factor: Factor, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock)
-  func getAll(forFactor factor: Factor, status: String?, pageSize: Int, order: ChallengeListOrder, pageToken: String?, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock)
-  func update(_ challenge: FactorChallenge, withAuthPayload authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock)
+  @discardableResult
+  func get(withSid sid: String, withFactor factor: Factor, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func getAll(forFactor factor: Factor, status: String?, pageSize: Int, order: ChallengeListOrder, pageToken: String?, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func update(_ challenge: FactorChallenge, withAuthPayload authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
 }
 
 class ChallengeAPIClient: BaseAPIClient {
   private let networkProvider: NetworkProvider
   private let authentication: Authentication
-  private let baseURL: String
+  private let urlTemplates: URLTemplateCache
+  private let compression: CompressionConfig
   
-  init(networkProvider: NetworkProvider = NetworkAdapter(), authentication: Authentication, baseURL: String, dateProvider: DateProvider = DateAdapter()) {
+  init(networkProvider: NetworkProvider = NetworkAdapter(), authentication: Authentication, baseURL: String,
+       compression: CompressionConfig = .default, dateProvider: DateProvider = DateAdapter()) {
     self.networkProvider = networkProvider
     self.authentication = authentication
-    self.baseURL = baseURL
+    urlTemplates = URLTemplateCache(baseURL: baseURL)
+    self.compression = compression
     super.init(dateProvider: dateProvider)
   }
 }
 
 extension ChallengeAPIClient: ChallengeAPIClientProtocol {
-  func get(withSid sid: String, withFactor factor: Factor, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) {
+  func get(withSid sid: String, withFactor factor: Factor, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     func getChallenge(retries: Int = BaseAPIClient.Constants.retryTimes) {
+      guard !token.isCancelled else { return }
       do {
         let authToken = try authentication.generateJWT(forFactor: factor)
-        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken))
+        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken), compression: compression)
         let request = try URLRequestBuilder(withURL: getChallengeURL(forSid: sid, forFactor: factor), requestHelper: requestHelper)
           .setHTTPMethod(.get)
           .build()
-        networkProvider.execute(request, success: success, failure: { error in
+        token.add(networkProvider.execute(request, success: success, failure: { error in
           self.validateFailureResponse(withError: error, retries: retries, retryBlock: getChallenge, failure: failure)
-        })
+        }))
       } catch {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
     }
     getChallenge()
+    return token
   }
   
-  func getAll(forFactor factor: Factor, status: String?, pageSize: Int, order: ChallengeListOrder, pageToken: String?, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) {
+  func getAll(forFactor factor: Factor, status: String?, pageSize: Int, order: ChallengeListOrder, pageToken: String?, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     func getAllChallenges(retries: Int = BaseAPIClient.Constants.retryTimes) {
+      guard !token.isCancelled else { return }
       do {
         let authToken = try authentication.generateJWT(forFactor: factor)
-        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken))
+        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken), compression: compression)
         var parameters = [Parameter(name: Constants.factorSidKey, value: factor.sid),
                           Parameter(name: Constants.pageSizeKey, value: pageSize),
                           Parameter(name: Constants.orderKey, value: order.rawValue)]
@@ -75,61 +86,57 @@ extension ChallengeAPIClient: ChallengeAPIClientProtocol {
         let request = try URLRequestBuilder(withURL: getChallengesURL(forFactor: factor), requestHelper: requestHelper)
           .setParameters(parameters)
           .build()
-        networkProvider.execute(request, success: success, failure: { error in
+        token.add(networkProvider.execute(request, success: success, failure: { error in
           self.validateFailureResponse(withError: error, retries: retries, retryBlock: getAllChallenges, failure: failure)
-        })
+        }))
       } catch {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
     }
     getAllChallenges()
+    return token
   }
   
-  func update(_ challenge: FactorChallenge, withAuthPayload authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) {
+  func update(_ challenge: FactorChallenge, withAuthPayload authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     func updateChallenge(retries: Int = BaseAPIClient.Constants.retryTimes) {
+      guard !token.isCancelled else { return }
       do {
         guard let factor = challenge.factor else {
           failure(InputError.invalidInput(field: "factor for challenge"))
           return
         }
         let authToken = try authentication.generateJWT(forFactor: factor)
-        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken))
+        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken), compression: compression)
         let request = try URLRequestBuilder(withURL: updateChallengeURL(forSid: challenge.sid, forFactor: factor), requestHelper: requestHelper)
           .setHTTPMethod(.post)
           .setParameters(updateChallengeBody(authPayload: authPayload))
           .build()
-        networkProvider.execute(request, success: success, failure: { error in
+        token.add(networkProvider.execute(request, success: success, failure: { error in
           self.validateFailureResponse(withError: error, retries: retries, retryBlock: updateChallenge, failure: failure)
-        })
+        }))
       } catch {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
     }
     updateChallenge()
+    return token
   }
 }
 
 private extension ChallengeAPIClient {
-  func getChallengeURL(forSid sid: String, forFactor factor: Factor) -> String {
-    "\(baseURL)\(Constants.getChallengeURL)"
-      .replacingOccurrences(of: APIConstants.serviceSidPath, with: factor.serviceSid)
-      .replacingOccurrences(of: APIConstants.identityPath, with: factor.identity)
-      .replacingOccurrences(of: APIConstants.challengeSidPath, with: sid)
+  func getChallengeURL(forSid sid: String, forFactor factor: Factor) throws -> URL {
+    try urlTemplates.url(for: Constants.getChallengeURL, serviceSid: factor.serviceSid, identity: factor.identity, values: [.challengeSid: sid])
   }
   
-  func getChallengesURL(forFactor factor: Factor) -> String {
-    "\(baseURL)\(Constants.getChallengesURL)"
-      .replacingOccurrences(of: APIConstants.serviceSidPath, with: factor.serviceSid)
-      .replacingOccurrences(of: APIConstants.identityPath, with: factor.identity)
+  func getChallengesURL(forFactor factor: Factor) throws -> URL {
+    try urlTemplates.url(for: Constants.getChallengesURL, serviceSid: factor.serviceSid, identity: factor.identity)
   }
   
-  func updateChallengeURL(forSid sid: String, forFactor factor: Factor) -> String {
-    "\(baseURL)\(Constants.updateChallengeURL)"
-      .replacingOccurrences(of: APIConstants.serviceSidPath, with: factor.serviceSid)
-      .replacingOccurrences(of: APIConstants.identityPath, with: factor.identity)
-      .replacingOccurrences(of: APIConstants.challengeSidPath, with: sid)
+  func updateChallengeURL(forSid sid: String, forFactor factor: Factor) throws -> URL {
+    try urlTemplates.url(for: Constants.updateChallengeURL, serviceSid: factor.serviceSid, identity: factor.identity, values: [.challengeSid: sid])
   }
   
   func updateChallengeBody(authPayload: String) -> [Parameter] {
@@ -20,70 +20,83 @@
 import Foundation
 
 protocol FactorAPIClientProtocol {
-  func create(withPayload payload: CreateFactorPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock)
-  func verify(_ factor: Factor, authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock)
-  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock)
-  func update(_ factor: Factor, updateFactorDataPayload: UpdateFactorDataPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock)
+  @discardableResult
+  func create(withPayload payload: CreateFactorPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func verify(_ factor: Factor, authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func update(_ factor: Factor, updateFactorDataPayload: UpdateFactorDataPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
 }
 
 class FactorAPIClient: BaseAPIClient {
   
   private let networkProvider: NetworkProvider
   private let authentication: Authentication
-  private let baseURL: String
+  private let urlTemplates: URLTemplateCache
+  private let compression: CompressionConfig
   
-  init(networkProvider: NetworkProvider = NetworkAdapter(), authentication: Authentication, baseURL: String, dateProvider: DateProvider = DateAdapter()) {
+  init(networkProvider: NetworkProvider = NetworkAdapter(), authentication: Authentication, baseURL: String,
+       compression: CompressionConfig = .default, dateProvider: DateProvider = DateAdapter()) {
     self.networkProvider = networkProvider
     self.authentication = authentication
-    self.baseURL = baseURL
+    urlTemplates = URLTemplateCache(baseURL: baseURL)
+    self.compression = compression
     super.init(dateProvider: dateProvider)
   }
 }
 
 extension FactorAPIClient: FactorAPIClientProtocol {
-  func create(withPayload payload: CreateFactorPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) {
+  func create(withPayload payload: CreateFactorPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
     do {
-      let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: payload.accessToken))
+      let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: payload.accessToken), compression: compression)
       let request = try URLRequestBuilder(withURL: createURL(createFactorPayload: payload), requestHelper: requestHelper)
         .setHTTPMethod(.post)
         .setParameters(createFactorBody(createFactorPayload: payload))
         .build()
-      networkProvider.execute(request, success: success, failure: failure)
+      return networkProvider.execute(request, success: success, failure: failure)
     } catch {
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(error)
+      return .finished
     }
   }
   
-  func verify(_ factor: Factor, authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) {
+  func verify(_ factor: Factor, authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     func verifyFactor(retries: Int = BaseAPIClient.Constants.retryTimes) {
+      guard !token.isCancelled else { return }
       do {
         let authToken = try authentication.generateJWT(forFactor: factor)
-        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken))
+        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken), compression: compression)
         let request = try URLRequestBuilder(withURL: verifyURL(for: factor), requestHelper: requestHelper)
           .setHTTPMethod(.post)
           .setParameters(verifyFactorBody(authPayload: authPayload))
           .build()
-        networkProvider.execute(request, success: success, failure: { error in
+        token.add(networkProvider.execute(request, success: success, failure: { error in
           self.validateFailureResponse(withError: error, retries: retries, retryBlock: verifyFactor, failure: failure)
-        })
+        }))
       } catch {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
     }
     verifyFactor()
+    return token
   }
   
-  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) {
+  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     func deleteFactor(retries: Int = BaseAPIClient.Constants.retryTimes) {
+      guard !token.isCancelled else { return }
       do {
         let authToken = try authentication.generateJWT(forFactor: factor)
-        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken))
+        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken), compression: compression)
         let request = try URLRequestBuilder(withURL: deleteURL(for: factor), requestHelper: requestHelper)
           .setHTTPMethod(.delete)
           .build()
-        networkProvider.execute(request, success: { _ in
+        token.add(networkProvider.execute(request, success: { _ in
           success()
         }, failure: { error in
           guard let networkError = error as? NetworkError,
@@ -103,41 +116,43 @@ extension FactorAPIClient: FactorAPIClientProtocol {
             default:
               self.validateFailureResponse(withError: error, retries: retries, retryBlock: deleteFactor, failure: failure)
           }
-        })
+        }))
       } catch {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
     }
     deleteFactor()
+    return token
   }
   
-  func update(_ factor: Factor, updateFactorDataPayload: UpdateFactorDataPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) {
+  func update(_ factor: Factor, updateFactorDataPayload: UpdateFactorDataPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     func updateFactor(retries: Int = BaseAPIClient.Constants.retryTimes) {
+      guard !token.isCancelled else { return }
       do {
         let authToken = try authentication.generateJWT(forFactor: factor)
-        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken))
+        let requestHelper = RequestHelper(authorization: BasicAuthorization(username: APIConstants.jwtAuthenticationUser, password: authToken), compression: compression)
         let request = try URLRequestBuilder(withURL: updateURL(for: factor), requestHelper: requestHelper)
           .setHTTPMethod(.post)
           .setParameters(updateFactorBody(updateFactorDataPayload: updateFactorDataPayload))
           .build()
-        networkProvider.execute(request, success: success, failure: { error in
+        token.add(networkProvider.execute(request, success: success, failure: { error in
           self.validateFailureResponse(withError: error, retries: retries, retryBlock: updateFactor, failure: failure)
-        })
+        }))
       } catch {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
     }
     updateFactor()
+    return token
   }
 }
 
 private extension FactorAPIClient {
-  func createURL(createFactorPayload: CreateFactorPayload) -> String {
-    "\(baseURL)\(Constants.createFactorURL)"
-      .replacingOccurrences(of: APIConstants.serviceSidPath, with: createFactorPayload.serviceSid)
-      .replacingOccurrences(of: APIConstants.identityPath, with: createFactorPayload.identity)
+  func createURL(createFactorPayload: CreateFactorPayload) throws -> URL {
+    try urlTemplates.url(for: Constants.createFactorURL, serviceSid: createFactorPayload.serviceSid, identity: createFactorPayload.identity)
   }
   
   func createFactorBody(createFactorPayload: CreateFactorPayload) throws -> [Parameter] {
@@ -157,29 +172,20 @@ private extension FactorAPIClient {
     return body
   }
   
-  func verifyURL(for factor: Factor) -> String {
-    "\(baseURL)\(Constants.verifyFactorURL)"
-      .replacingOccurrences(of: APIConstants.serviceSidPath, with: factor.serviceSid)
-      .replacingOccurrences(of: APIConstants.identityPath, with: factor.identity)
-      .replacingOccurrences(of: APIConstants.factorSidPath, with: factor.sid)
+  func verifyURL(for factor: Factor) throws -> URL {
+    try urlTemplates.url(for: Constants.verifyFactorURL, serviceSid: factor.serviceSid, identity: factor.identity, values: [.factorSid: factor.sid])
   }
   
   func verifyFactorBody(authPayload: String) -> [Parameter] {
     [Parameter(name: Constants.authPayloadKey, value: authPayload)]
   }
   
-  func deleteURL(for factor: Factor) -> String {
-    "\(baseURL)\(Constants.deleteFactorURL)"
-      .replacingOccurrences(of: APIConstants.serviceSidPath, with: factor.serviceSid)
-      .replacingOccurrences(of: APIConstants.identityPath, with: factor.identity)
-      .replacingOccurrences(of: APIConstants.factorSidPath, with: factor.sid)
+  func deleteURL(for factor: Factor) throws -> URL {
+    try urlTemplates.url(for: Constants.deleteFactorURL, serviceSid: factor.serviceSid, identity: factor.identity, values: [.factorSid: factor.sid])
   }
   
-  func updateURL(for factor: Factor) -> String {
-    "\(baseURL)\(Constants.updateFactorURL)"
-      .replacingOccurrences(of: APIConstants.serviceSidPath, with: factor.serviceSid)
-      .replacingOccurrences(of: APIConstants.identityPath, with: factor.identity)
-      .replacingOccurrences(of: APIConstants.factorSidPath, with: factor.sid)
+  func updateURL(for factor: Factor) throws -> URL {
+    try urlTemplates.url(for: Constants.updateFactorURL, serviceSid: factor.serviceSid, identity: factor.identity, values: [.factorSid: factor.sid])
   }
   
   func updateFactorBody(updateFactorDataPayload: UpdateFactorDataPayload) throws -> [Parameter] {
@@ -0,0 +1,160 @@
+//
+//  URLTemplate.swift
+//  TwilioVerify
+//
+//  Copyright © 2020 Twilio.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Foundation
+
+/// API path parsed once into literal segments and placeholders, literals are percent-encoded at parse time
+/// so rendering only appends strings and escapes the inserted values.
+struct URLTemplate {
+  private let segments: [Segment]
+
+  init(_ template: String) {
+    var segments = [Segment]()
+    var remaining = template[...]
+    while let start = remaining.firstIndex(of: "{"),
+      let end = remaining[start...].firstIndex(of: "}"),
+      let placeholder = Placeholder(rawValue: String(remaining[start...end])) {
+      segments.append(.literal(URLTemplate.encodeLiteral(remaining[..<start])))
+      segments.append(.placeholder(placeholder))
+      remaining = remaining[remaining.index(after: end)...]
+    }
+    segments.append(.literal(URLTemplate.encodeLiteral(remaining)))
+    self.init(segments: segments)
+  }
+
+  private init(segments: [Segment]) {
+    var merged = [Segment]()
+    for segment in segments {
+      switch (segment, merged.last) {
+        case (.literal(let next), _) where next.isEmpty:
+          continue
+        case (.literal(let next), .literal(let previous)?):
+          merged[merged.count - 1] = .literal(previous + next)
+        default:
+          merged.append(segment)
+      }
+    }
+    self.segments = merged
+  }
+
+  /// Substitutes the given placeholders and keeps the rest, e.g. to cache a template per service and identity.
+  func binding(_ values: [Placeholder: String]) -> URLTemplate {
+    URLTemplate(segments: segments.map { segment in
+      guard case .placeholder(let placeholder) = segment, let value = values[placeholder] else {
+        return segment
+      }
+      return .literal(URLTemplate.encodeValue(value))
+    })
+  }
+
+  func render(_ values: [Placeholder: String] = [:]) throws -> URL {
+    var url = String()
+    for segment in segments {
+      switch segment {
+        case .literal(let literal):
+          url.append(literal)
+        case .placeholder(let placeholder):
+          guard let value = values[placeholder] else {
+            throw NetworkError.invalidURL
+          }
+          url.append(URLTemplate.encodeValue(value))
+      }
+    }
+    guard let renderedURL = URL(string: url) else {
+      throw NetworkError.invalidURL
+    }
+    return renderedURL
+  }
+}
+
+extension URLTemplate {
+  enum Placeholder: String {
+    case serviceSid = "{ServiceSid}"
+    case identity = "{Identity}"
+    case factorSid = "{FactorSid}"
+    case challengeSid = "{ChallengeSid}"
+  }
+
+  private enum Segment {
+    case literal(String)
+    case placeholder(Placeholder)
+  }
+
+  private static func encodeLiteral(_ literal: Substring) -> String {
+    literal.addingPercentEncoding(withAllowedCharacters: .urlQueryAllowed) ?? String(literal)
+  }
+
+  private static func encodeValue(_ value: String) -> String {
+    value.addingPercentEncoding(withAllowedCharacters: .urlPathSegmentAllowed) ?? value
+  }
+}
+
+/// Compiled templates for an API client plus the templates bound to each (serviceSid, identity) pair.
+final class URLTemplateCache {
+  private let baseURL: String
+  private let limit: Int
+  private let lock = NSLock()
+  private var templates: [String: URLTemplate] = [:]
+  private var boundTemplates: [Key: URLTemplate] = [:]
+
+  init(baseURL: String, limit: Int = Constants.defaultLimit) {
+    self.baseURL = baseURL
+    self.limit = limit
+  }
+
+  func url(for path: String, serviceSid: String, identity: String, values: [URLTemplate.Placeholder: String] = [:]) throws -> URL {
+    try boundTemplate(for: Key(path: path, serviceSid: serviceSid, identity: identity)).render(values)
+  }
+}
+
+private extension URLTemplateCache {
+  struct Key: Hashable {
+    let path: String
+    let serviceSid: String
+    let identity: String
+  }
+
+  func boundTemplate(for key: Key) -> URLTemplate {
+    lock.lock()
+    defer { lock.unlock() }
+    if let template = boundTemplates[key] {
+      return template
+    }
+    let template = templates[key.path] ?? URLTemplate(baseURL + key.path)
+    templates[key.path] = template
+    if boundTemplates.count >= limit {
+      boundTemplates.removeAll(keepingCapacity: true)
+    }
+    let boundTemplate = template.binding([.serviceSid: key.serviceSid, .identity: key.identity])
+    boundTemplates[key] = boundTemplate
+    return boundTemplate
+  }
+}
+
+extension URLTemplateCache {
+  struct Constants {
+    static let defaultLimit = 32
+  }
+}
+
+extension CharacterSet {
+  static let urlPathSegmentAllowed: CharacterSet = {
+    CharacterSet.urlPathAllowed.subtracting(CharacterSet(charactersIn: "/"))
+  }()
+}
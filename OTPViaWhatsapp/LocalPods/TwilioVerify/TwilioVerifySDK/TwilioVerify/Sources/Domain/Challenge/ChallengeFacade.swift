@@ -20,9 +20,12 @@
 import Foundation
 
 protocol ChallengeFacadeProtocol {
-  func get(withSid sid: String, withFactorSid factorSid: String, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
-  func update(withPayload updateChallengePayload: UpdateChallengePayload, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
-  func getAll(withPayload challengeListPayload: ChallengeListPayload, success: @escaping (ChallengeList) -> (), failure: @escaping TwilioVerifyErrorBlock)
+  @discardableResult
+  func get(withSid sid: String, withFactorSid factorSid: String, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
+  @discardableResult
+  func update(withPayload updateChallengePayload: UpdateChallengePayload, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
+  @discardableResult
+  func getAll(withPayload challengeListPayload: ChallengeListPayload, success: @escaping (ChallengeList) -> (), failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
 }
 
 class ChallengeFacade {
@@ -39,69 +42,77 @@ class ChallengeFacade {
 }
 
 extension ChallengeFacade: ChallengeFacadeProtocol {
-  func get(withSid sid: String, withFactorSid factorSid: String, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func get(withSid sid: String, withFactorSid factorSid: String, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     guard !sid.isEmpty else {
       let error: InputError = .emptyChallengeSid
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
-      return failure(.inputError(error: error))
+      failure(.inputError(error: error))
+      return .finished
     }
+    let token = VerifyCancellationToken()
     factorFacade.get(withSid: factorSid, success: { [weak self] factor in
       guard let strongSelf = self else { return }
       switch factor {
         case is PushFactor:
           // swiftlint:disable:next force_cast
-          strongSelf.pushChallengeProcessor.getChallenge(withSid: sid, withFactor: factor as! PushFactor, success: success, failure: failure)
+          token.add(strongSelf.pushChallengeProcessor.getChallenge(withSid: sid, withFactor: factor as! PushFactor, success: success, failure: failure))
         default:
           let error =  InputError.invalidInput(field: "invalid factor")
           Logger.shared.log(withLevel: .error, message: error.localizedDescription)
           failure(TwilioVerifyError.inputError(error: error))
       }
     }, failure: failure)
+    return token
   }
 
-  func update(withPayload updateChallengePayload: UpdateChallengePayload, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func update(withPayload updateChallengePayload: UpdateChallengePayload, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     factorFacade.get(withSid: updateChallengePayload.factorSid, success: { [weak self] factor in
       guard let strongSelf = self else { return }
       switch factor {
         case is PushFactor:
           // swiftlint:disable:next force_cast
-          strongSelf.updatePushChallenge(updateChallengePayload: updateChallengePayload, factor: factor as! PushFactor, success: success, failure: failure)
+          token.add(strongSelf.updatePushChallenge(updateChallengePayload: updateChallengePayload, factor: factor as! PushFactor, success: success, failure: failure))
         default:
           let error = InputError.invalidInput(field: "invalid factor")
           Logger.shared.log(withLevel: .error, message: error.localizedDescription)
           failure(TwilioVerifyError.inputError(error: error))
       }
     }, failure: failure)
+    return token
   }
 
-  func getAll(withPayload challengeListPayload: ChallengeListPayload, success: @escaping (ChallengeList) -> (), failure: @escaping TwilioVerifyErrorBlock) {
+  func getAll(withPayload challengeListPayload: ChallengeListPayload, success: @escaping (ChallengeList) -> (), failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     factorFacade.get(withSid: challengeListPayload.factorSid, success: { [weak self] factor in
       guard let strongSelf = self else { return }
-      strongSelf.repository.getAll(for: factor, status: challengeListPayload.status,
+      token.add(strongSelf.repository.getAll(for: factor, status: challengeListPayload.status,
                                    pageSize: challengeListPayload.pageSize, order: challengeListPayload.order, pageToken: challengeListPayload.pageToken, success: success) { error in
         failure(TwilioVerifyError.networkError(error: error))
-      }
+      })
     }, failure: failure)
+    return token
   }
 }
 
 private extension ChallengeFacade {
   private func updatePushChallenge(updateChallengePayload: UpdateChallengePayload, factor: PushFactor, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock
-  ) {
+  ) -> VerifyCancellationToken {
     guard let payload = updateChallengePayload as? UpdatePushChallengePayload else {
       let error: InputError = .invalidUpdateChallengePayload(
         factorType: factor.type
       )
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(TwilioVerifyError.inputError(error: error))
-      return
+      return .finished
     }
     guard !updateChallengePayload.challengeSid.isEmpty else {
       let error: InputError = .emptyChallengeSid
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
-      return failure(TwilioVerifyError.inputError(error: error))
+      failure(TwilioVerifyError.inputError(error: error))
+      return .finished
     }
-    pushChallengeProcessor.updateChallenge(withSid: payload.challengeSid, withFactor: factor, status: payload.status, success: success, failure: failure)
+    return pushChallengeProcessor.updateChallenge(withSid: payload.challengeSid, withFactor: factor, status: payload.status, success: success, failure: failure)
   }
 }
 
@@ -113,6 +124,7 @@ extension ChallengeFacade {
     private var factorFacade: FactorFacadeProtocol!
     private var url: String!
     private var authentication: Authentication!
+    private var compression: CompressionConfig = .default
     
     func setNetworkProvider(_ networkProvider: NetworkProvider) -> Self {
       self.networkProvider = networkProvider
@@ -139,8 +151,13 @@ extension ChallengeFacade {
       return self
     }
     
+    func setCompression(_ compression: CompressionConfig) -> Self {
+      self.compression = compression
+      return self
+    }
+    
     func build() -> ChallengeFacadeProtocol {
-      let challengeAPIClient = ChallengeAPIClient(networkProvider: networkProvider, authentication: authentication, baseURL: url)
+      let challengeAPIClient = ChallengeAPIClient(networkProvider: networkProvider, authentication: authentication, baseURL: url, compression: compression)
       let repository = ChallengeRepository(apiClient: challengeAPIClient)
       let pushChallengeProcessor = PushChallengeProcessor(challengeProvider: repository, jwtGenerator: jwtGenerator)
       return ChallengeFacade(pushChallengeProcessor: pushChallengeProcessor, factorFacade: factorFacade, repository: repository)
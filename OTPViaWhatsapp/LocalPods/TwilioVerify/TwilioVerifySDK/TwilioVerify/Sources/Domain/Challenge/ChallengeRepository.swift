@@ -20,10 +20,13 @@
 import Foundation
 
 protocol ChallengeProvider {
-  func get(withSid sid: String, withFactor factor: Factor, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock)
-  func update(_ challenge: Challenge, payload: String, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock)
+  @discardableResult
+  func get(withSid sid: String, withFactor factor: Factor, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func update(_ challenge: Challenge, payload: String, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
   func getAll(for factor: Factor, status: ChallengeStatus?, pageSize: Int, order: ChallengeListOrder, pageToken: String?,
-              success: @escaping (ChallengeList) -> (), failure: @escaping FailureBlock)
+              success: @escaping (ChallengeList) -> (), failure: @escaping FailureBlock) -> VerifyCancellationToken
 }
 
 class ChallengeRepository {
@@ -40,9 +43,10 @@ class ChallengeRepository {
 }
 
 extension ChallengeRepository: ChallengeProvider {
-  func get(withSid sid: String, withFactor factor: Factor, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock) {
-    apiClient.get(withSid: sid, withFactor: factor, success: { [weak self] response in
-      guard let strongSelf = self else { return }
+  func get(withSid sid: String, withFactor factor: Factor, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
+    token.add(apiClient.get(withSid: sid, withFactor: factor, success: { [weak self] response in
+      guard let strongSelf = self, !token.isCancelled else { return }
       do {
         var challenge = try strongSelf.challengeMapper.fromAPI(withData: response.data,
                                                                signatureFieldsHeader: response.headers.first {
@@ -60,43 +64,48 @@ extension ChallengeRepository: ChallengeProvider {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
-    }, failure: failure)
+    }, failure: failure))
+    return token
   }
   
-  func update(_ challenge: Challenge, payload: String, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock) {
+  func update(_ challenge: Challenge, payload: String, success: @escaping ChallengeSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
     guard let factorChallenge = challenge as? FactorChallenge else {
       let error: InputError = .invalidChallenge
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(error)
-      return
+      return .finished
     }
     guard let factor = factorChallenge.factor else {
       let error: InputError = .invalidFactor
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(error)
-      return
+      return .finished
     }
     if factorChallenge.status == .expired {
       let error: InputError = .expiredChallenge
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
-      return failure(error)
+      failure(error)
+      return .finished
     }
     guard factorChallenge.status == .pending else {
       let error: InputError = .alreadyUpdatedChallenge
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(error)
-      return
+      return .finished
     }
-    apiClient.update(factorChallenge, withAuthPayload: payload, success: { [weak self] _ in
-      guard let strongSelf = self else { return }
-      strongSelf.get(withSid: factorChallenge.sid, withFactor: factor, success: success, failure: failure)
-    }, failure: failure)
+    let token = VerifyCancellationToken()
+    token.add(apiClient.update(factorChallenge, withAuthPayload: payload, success: { [weak self] _ in
+      guard let strongSelf = self, !token.isCancelled else { return }
+      token.add(strongSelf.get(withSid: factorChallenge.sid, withFactor: factor, success: success, failure: failure))
+    }, failure: failure))
+    return token
   }
   
   func getAll(for factor: Factor, status: ChallengeStatus?, pageSize: Int, order: ChallengeListOrder, pageToken: String?,
-              success: @escaping (ChallengeList) -> (), failure: @escaping FailureBlock) {
-    apiClient.getAll(forFactor: factor, status: status?.rawValue, pageSize: pageSize, order: order, pageToken: pageToken, success: { [weak self] response in
-      guard let strongSelf = self else { return }
+              success: @escaping (ChallengeList) -> (), failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
+    token.add(apiClient.getAll(forFactor: factor, status: status?.rawValue, pageSize: pageSize, order: order, pageToken: pageToken, success: { [weak self] response in
+      guard let strongSelf = self, !token.isCancelled else { return }
       do {
         let challengeList = try strongSelf.challengeListMapper.fromAPI(withData: response.data)
         success(challengeList)
@@ -104,7 +113,8 @@ extension ChallengeRepository: ChallengeProvider {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
-    }, failure: failure)
+    }, failure: failure))
+    return token
   }
 }
 
@@ -20,8 +20,10 @@
 import Foundation
 
 protocol PushChallengeProcessorProtocol {
-  func getChallenge(withSid sid: String, withFactor factor: PushFactor, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
-  func updateChallenge(withSid sid: String, withFactor factor: PushFactor, status: ChallengeStatus, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
+  @discardableResult
+  func getChallenge(withSid sid: String, withFactor factor: PushFactor, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
+  @discardableResult
+  func updateChallenge(withSid sid: String, withFactor factor: PushFactor, status: ChallengeStatus, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
 }
 
 class PushChallengeProcessor {
@@ -44,9 +46,9 @@ extension PushChallengeProcessor: PushChallengeProcessorProtocol {
     withFactor factor: PushFactor,
     success: @escaping ChallengeSuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  ) {
+  ) -> VerifyCancellationToken {
     Logger.shared.log(withLevel: .info, message: "Getting challenge \(sid) with factor \(factor.sid)")
-    challengeProvider.get(withSid: sid, withFactor: factor, success: success, failure: { error in
+    return challengeProvider.get(withSid: sid, withFactor: factor, success: success, failure: { error in
       failure(TwilioVerifyError.inputError(error: error))
     })
   }
@@ -57,10 +59,11 @@ extension PushChallengeProcessor: PushChallengeProcessorProtocol {
     status: ChallengeStatus,
     success: @escaping EmptySuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  ) {
+  ) -> VerifyCancellationToken {
     Logger.shared.log(withLevel: .info, message: "Updating challenge \(sid) with factor \(factor.sid) to new status \(status)")
-    getChallenge(withSid: sid, withFactor: factor, success: { [weak self] challenge in
-      guard let strongSelf = self else { return }
+    let token = VerifyCancellationToken()
+    token.add(getChallenge(withSid: sid, withFactor: factor, success: { [weak self] challenge in
+      guard let strongSelf = self, !token.isCancelled else { return }
       guard let factorChallenge = challenge as? FactorChallenge else {
         let error: InputError = .invalidChallenge
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
@@ -114,7 +117,8 @@ extension PushChallengeProcessor: PushChallengeProcessorProtocol {
       do {
         let authPayload = try strongSelf.generateSignature(withSignatureFields: signatureFields, withResponse: response, status: status, signerTemplate: signerTemplate)
         Logger.shared.log(withLevel: .debug, message: "Update challenge with auth payload \(authPayload)")
-        strongSelf.challengeProvider.update(challenge, payload: authPayload, success: { updatedChallenge in
+        guard !token.isCancelled else { return }
+        token.add(strongSelf.challengeProvider.update(challenge, payload: authPayload, success: { updatedChallenge in
           if updatedChallenge.status == status {
             success()
           } else {
@@ -124,12 +128,13 @@ extension PushChallengeProcessor: PushChallengeProcessorProtocol {
           }
         }, failure: { error in
           failure(TwilioVerifyError.inputError(error: error))
-        })
+        }))
       } catch {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(TwilioVerifyError.inputError(error: error))
       }
-    }, failure: failure)
+    }, failure: failure))
+    return token
   }
 }
 
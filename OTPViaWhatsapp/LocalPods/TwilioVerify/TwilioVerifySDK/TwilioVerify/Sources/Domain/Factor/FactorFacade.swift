@@ -20,12 +20,16 @@
 import Foundation
 
 protocol FactorFacadeProtocol {
-  func createFactor(withPayload payload: FactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
-  func verifyFactor(withPayload payload: VerifyFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
-  func updateFactor(withPayload payload: UpdateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
+  @discardableResult
+  func createFactor(withPayload payload: FactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
+  @discardableResult
+  func verifyFactor(withPayload payload: VerifyFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
+  @discardableResult
+  func updateFactor(withPayload payload: UpdateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
   func get(withSid sid: String, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
   func getAll(success: @escaping FactorListSuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
-  func delete(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock)
+  @discardableResult
+  func delete(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
   func clearLocalStorage() throws
 }
 
@@ -41,51 +45,53 @@ class FactorFacade {
 }
 
 extension FactorFacade: FactorFacadeProtocol {
-  func createFactor(withPayload payload: FactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func createFactor(withPayload payload: FactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     guard let payload = payload as? PushFactorPayload else {
       let error: InputError = .invalidPayload
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(TwilioVerifyError.inputError(error: error))
-      return
-    }
-    factory.createFactor(withAccessToken: payload.accessToken,
-                         friendlyName: payload.friendlyName,
-                         serviceSid: payload.serviceSid,
-                         identity: payload.identity,
-                         pushToken: payload.pushToken,
-                         metadata: payload.metadata,
-                         success: success,
-                         failure: failure)
+      return .finished
+    }
+    return factory.createFactor(withAccessToken: payload.accessToken,
+                                friendlyName: payload.friendlyName,
+                                serviceSid: payload.serviceSid,
+                                identity: payload.identity,
+                                pushToken: payload.pushToken,
+                                metadata: payload.metadata,
+                                success: success,
+                                failure: failure)
   }
   
-  func verifyFactor(withPayload payload: VerifyFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func verifyFactor(withPayload payload: VerifyFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     guard let payload = payload as? VerifyPushFactorPayload else {
       let error: InputError = .invalidPayload
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(TwilioVerifyError.inputError(error: error))
-      return
+      return .finished
     }
     guard !payload.sid.isEmpty else {
       let error: InputError = .emptyFactorSid
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
-      return failure(TwilioVerifyError.inputError(error: error))
+      failure(TwilioVerifyError.inputError(error: error))
+      return .finished
     }
-    factory.verifyFactor(withSid: payload.sid, success: success, failure: failure)
+    return factory.verifyFactor(withSid: payload.sid, success: success, failure: failure)
   }
   
-  func updateFactor(withPayload payload: UpdateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func updateFactor(withPayload payload: UpdateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     guard let payload = payload as? UpdatePushFactorPayload else {
       let error: InputError = .invalidPayload
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(TwilioVerifyError.inputError(error: error))
-      return
+      return .finished
     }
     guard !payload.sid.isEmpty else {
       let error: InputError = .emptyFactorSid
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
-      return failure(TwilioVerifyError.inputError(error: error))
+      failure(TwilioVerifyError.inputError(error: error))
+      return .finished
     }
-    factory.updateFactor(withSid: payload.sid, withPushToken: payload.pushToken, success: success, failure: failure)
+    return factory.updateFactor(withSid: payload.sid, withPushToken: payload.pushToken, success: success, failure: failure)
   }
   
   func get(withSid sid: String, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
@@ -110,13 +116,14 @@ extension FactorFacade: FactorFacadeProtocol {
     }
   }
   
-  func delete(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func delete(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     guard !sid.isEmpty else {
       let error: InputError = .emptyFactorSid
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
-      return failure(TwilioVerifyError.inputError(error: error))
+      failure(TwilioVerifyError.inputError(error: error))
+      return .finished
     }
-    factory.deleteFactor(withSid: sid, success: success, failure: failure)
+    return factory.deleteFactor(withSid: sid, success: success, failure: failure)
   }
   
   func clearLocalStorage() throws {
@@ -139,6 +146,7 @@ extension FactorFacade {
     private var clearStorageOnReinstall = true
     private var accessGroup: String?
     private var userDefaults: UserDefaults!
+    private var compression: CompressionConfig = .default
     
     func setNetworkProvider(_ networkProvider: NetworkProvider) -> Self {
       self.networkProvider = networkProvider
@@ -179,9 +187,14 @@ extension FactorFacade {
       self.userDefaults = userDefaults
       return self
     }
+    
+    func setCompression(_ compression: CompressionConfig) -> Self {
+      self.compression = compression
+      return self
+    }
 
     func build() throws -> FactorFacadeProtocol {
-      let factorAPIClient = FactorAPIClient(networkProvider: networkProvider, authentication: authentication, baseURL: url)
+      let factorAPIClient = FactorAPIClient(networkProvider: networkProvider, authentication: authentication, baseURL: url, compression: compression)
       let keychainQuery = KeychainQuery(accessGroup: accessGroup)
       let secureStorage = SecureStorage(keychain: keychain, keychainQuery: keychainQuery)
       let migrations = FactorMigrations().migrations()
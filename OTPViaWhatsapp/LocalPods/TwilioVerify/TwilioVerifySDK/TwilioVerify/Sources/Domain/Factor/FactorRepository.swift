@@ -20,10 +20,14 @@
 import Foundation
 
 protocol FactorProvider {
-  func create(withPayload payload: CreateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock)
-  func verify(_ factor: Factor, payload: String, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock)
-  func update(withPayload payload: UpdateFactorDataPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock)
-  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock)
+  @discardableResult
+  func create(withPayload payload: CreateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func verify(_ factor: Factor, payload: String, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func update(withPayload payload: UpdateFactorDataPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
+  @discardableResult
+  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken
   func delete(_ factor: Factor) throws
   func getAll() throws -> [Factor]
   func get(withSid sid: String) throws -> Factor
@@ -45,9 +49,10 @@ class FactorRepository {
 }
 
 extension FactorRepository: FactorProvider {
-  func create(withPayload createFactorPayload: CreateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) {
-    apiClient.create(withPayload: createFactorPayload, success: { [weak self] response in
-      guard let strongSelf = self else { return }
+  func create(withPayload createFactorPayload: CreateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
+    token.add(apiClient.create(withPayload: createFactorPayload, success: { [weak self] response in
+      guard let strongSelf = self, !token.isCancelled else { return }
       do {
         let factor = try strongSelf.factorMapper.fromAPI(withData: response.data, factorPayload: createFactorPayload)
         success(try strongSelf.save(factor))
@@ -55,12 +60,14 @@ extension FactorRepository: FactorProvider {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
-    }, failure: failure)
+    }, failure: failure))
+    return token
   }
   
-  func verify(_ factor: Factor, payload: String, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) {
-    apiClient.verify(factor, authPayload: payload, success: { [weak self] response in
-      guard let strongSelf = self else { return }
+  func verify(_ factor: Factor, payload: String, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
+    token.add(apiClient.verify(factor, authPayload: payload, success: { [weak self] response in
+      guard let strongSelf = self, !token.isCancelled else { return }
       do {
         let status = try strongSelf.factorMapper.status(fromData: response.data)
         var updatedFactor = factor
@@ -70,30 +77,34 @@ extension FactorRepository: FactorProvider {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
-    }, failure: failure)
+    }, failure: failure))
+    return token
   }
   
-  func update(withPayload payload: UpdateFactorDataPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) {
+  func update(withPayload payload: UpdateFactorDataPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     do {
       let factor = try get(withSid: payload.factorSid)
-      apiClient.update(factor, updateFactorDataPayload: payload, success: { [weak self] response in
-        guard let strongSelf = self else { return }
+      token.add(apiClient.update(factor, updateFactorDataPayload: payload, success: { [weak self] response in
+        guard let strongSelf = self, !token.isCancelled else { return }
         do {
           success(try strongSelf.factorMapper.fromAPI(withData: response.data, factorPayload: payload))
         } catch {
           Logger.shared.log(withLevel: .error, message: error.localizedDescription)
           failure(error)
         }
-      }, failure: failure)
+      }, failure: failure))
     } catch {
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(error)
     }
+    return token
   }
   
-  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) {
-    apiClient.delete(factor, success: { [weak self] in
-      guard let strongSelf = self else { return }
+  func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
+    token.add(apiClient.delete(factor, success: { [weak self] in
+      guard let strongSelf = self, !token.isCancelled else { return }
       do {
         try strongSelf.delete(factor)
         success()
@@ -101,7 +112,8 @@ extension FactorRepository: FactorProvider {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(error)
       }
-    }, failure: failure)
+    }, failure: failure))
+    return token
   }
   
   func delete(_ factor: Factor) throws {
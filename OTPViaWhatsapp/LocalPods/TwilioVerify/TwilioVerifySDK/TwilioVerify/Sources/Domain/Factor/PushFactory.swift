@@ -20,6 +20,7 @@
 import Foundation
 
 protocol PushFactoryProtocol {
+  @discardableResult
   func createFactor(withAccessToken accessToken: String,
                     friendlyName: String,
                     serviceSid: String,
@@ -27,20 +28,23 @@ protocol PushFactoryProtocol {
                     pushToken: String?,
                     metadata: [String: String]?,
                     success: @escaping FactorSuccessBlock,
-                    failure: @escaping TwilioVerifyErrorBlock)
+                    failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
   
+  @discardableResult
   func verifyFactor(withSid sid: String,
                     success: @escaping FactorSuccessBlock,
-                    failure: @escaping TwilioVerifyErrorBlock)
+                    failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
   
+  @discardableResult
   func updateFactor(withSid sid: String,
                     withPushToken pushToken: String?,
                     success: @escaping FactorSuccessBlock,
-                    failure: @escaping TwilioVerifyErrorBlock)
+                    failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
   
+  @discardableResult
   func deleteFactor(withSid sid: String,
                     success: @escaping EmptySuccessBlock,
-                    failure: @escaping TwilioVerifyErrorBlock)
+                    failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken
   
   func deleteAllFactors() throws
 }
@@ -59,7 +63,8 @@ class PushFactory {
 extension PushFactory: PushFactoryProtocol {
   func createFactor(withAccessToken accessToken: String, friendlyName: String, serviceSid: String,
                     identity: String, pushToken: String?, metadata: [String: String]?,
-                    success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+                    success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    let token = VerifyCancellationToken()
     do {
       Logger.shared.log(withLevel: .info, message: "Creating push factor \(friendlyName)")
       let alias = generateKeyPairAlias()
@@ -73,8 +78,18 @@ extension PushFactory: PushFactoryProtocol {
         
       Logger.shared.log(withLevel: .debug, message: "Create push factor for \(payload)")
       
-      repository.create(withPayload: payload, success: { [weak self] factor in
+      // Whichever of the cancellation and a factor created regardless of it finishes or cancels this first
+      // owns the key pair, the factor needs it to sign its deletion from the API
+      let keyPair = VerifyCancellationToken { [weak self] in
+        Logger.shared.log(withLevel: .debug, message: "Delete key pair \(alias) of cancelled factor")
+        try? self?.keyStorage.deleteKey(withAlias: alias)
+      }
+      token.add(repository.create(withPayload: payload, success: { [weak self] factor in
         guard let strongSelf = self else { return }
+        guard token.finish() else {
+          strongSelf.discard(factor, alias: alias, keyPair: keyPair)
+          return
+        }
         guard var factor = factor as? PushFactor else {
           failure(TwilioVerifyError.networkError(error: NetworkError.invalidData))
           return
@@ -94,7 +109,7 @@ extension PushFactory: PushFactoryProtocol {
           }
         }
       }) { [weak self] error in
-        guard let strongSelf = self else { return }
+        guard let strongSelf = self, token.finish() else { return }
         do {
           try strongSelf.keyStorage.deleteKey(withAlias: alias)
           failure(TwilioVerifyError.networkError(error: error))
@@ -102,28 +117,31 @@ extension PushFactory: PushFactoryProtocol {
           Logger.shared.log(withLevel: .error, message: error.localizedDescription)
           failure(TwilioVerifyError.keyStorageError(error: error))
         }
-      }
+      })
+      token.add(keyPair)
     } catch {
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(TwilioVerifyError.keyStorageError(error: error))
+      return .finished
     }
+    return token
   }
   
-  func verifyFactor(withSid sid: String, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func verifyFactor(withSid sid: String, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     do {
       Logger.shared.log(withLevel: .info, message: "Verifying push factor \(sid)")
       let factor = try repository.get(withSid: sid)
       guard let pushFactor = factor as? PushFactor else {
         failure(TwilioVerifyError.storageError(error: StorageError.error("Factor not found") ))
-        return
+        return .finished
       }
       guard let alias = pushFactor.keyPairAlias else {
         failure(TwilioVerifyError.storageError(error: StorageError.error("Alias not found") ))
-        return
+        return .finished
       }
       let payload = try keyStorage.signAndEncode(withAlias: alias, message: sid)
       Logger.shared.log(withLevel: .debug, message: "Verify factor with payload \(payload)")
-      repository.verify(pushFactor, payload: payload, success: success) { error in
+      return repository.verify(pushFactor, payload: payload, success: success) { error in
         failure(TwilioVerifyError.networkError(error: error))
       }
     } catch {
@@ -133,19 +151,20 @@ extension PushFactory: PushFactoryProtocol {
         Logger.shared.log(withLevel: .error, message: error.localizedDescription)
         failure(TwilioVerifyError.storageError(error: error))
       }
+      return .finished
     }
   }
   
   func updateFactor(withSid sid: String,
                     withPushToken pushToken: String?,
                     success: @escaping FactorSuccessBlock,
-                    failure: @escaping TwilioVerifyErrorBlock) {
+                    failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     do {
       Logger.shared.log(withLevel: .info, message: "Updating push factor \(sid)")
       let factor = try repository.get(withSid: sid)
       guard let pushFactor = factor as? PushFactor else {
         failure(TwilioVerifyError.storageError(error: StorageError.error("Factor not found") ))
-        return
+        return .finished
       }
       let payload = UpdateFactorDataPayload(
         friendlyName: pushFactor.friendlyName,
@@ -155,28 +174,29 @@ extension PushFactory: PushFactoryProtocol {
         config: config(withToken: pushToken),
         factorSid: pushFactor.sid)
       Logger.shared.log(withLevel: .debug, message: "Update push factor with payload \(payload)")
-      repository.update(withPayload: payload, success: success) { error in
+      return repository.update(withPayload: payload, success: success) { error in
         failure(TwilioVerifyError.networkError(error: error))
       }
     } catch {
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(TwilioVerifyError.storageError(error: error))
+      return .finished
     }
   }
   
-  func deleteFactor(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  func deleteFactor(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     do {
       Logger.shared.log(withLevel: .info, message: "Deleting push factor \(sid)")
       let factor = try repository.get(withSid: sid)
       guard let pushFactor = factor as? PushFactor else {
         failure(TwilioVerifyError.storageError(error: StorageError.error("Factor not found") ))
-        return
+        return .finished
       }
       guard let alias = pushFactor.keyPairAlias else {
         failure(TwilioVerifyError.storageError(error: StorageError.error("Alias not found") ))
-        return
+        return .finished
       }
-      repository.delete(factor, success: { [weak self] in
+      return repository.delete(factor, success: { [weak self] in
         guard let strongSelf = self else { return }
         do {
           try strongSelf.keyStorage.deleteKey(withAlias: alias)
@@ -191,6 +211,7 @@ extension PushFactory: PushFactoryProtocol {
     } catch {
       Logger.shared.log(withLevel: .error, message: error.localizedDescription)
       failure(TwilioVerifyError.storageError(error: error))
+      return .finished
     }
   }
   
@@ -207,6 +228,25 @@ extension PushFactory: PushFactoryProtocol {
 }
 
 private extension PushFactory {
+  ///Removes a factor that the repository created before the cancellation reached it, from the API while its
+  ///key pair is still there to sign the request, and from local storage
+  func discard(_ factor: Factor, alias: String, keyPair: VerifyCancellationToken) {
+    guard keyPair.finish(), var pushFactor = factor as? PushFactor else {
+      Logger.shared.log(withLevel: .error, message: "Factor \(factor.sid) of cancelled creation was created in the API, its key pair is gone")
+      try? repository.delete(factor)
+      return
+    }
+    Logger.shared.log(withLevel: .debug, message: "Delete factor \(factor.sid) of cancelled creation")
+    pushFactor.keyPairAlias = alias
+    repository.delete(pushFactor, success: { [weak self] in
+      try? self?.keyStorage.deleteKey(withAlias: alias)
+    }, failure: { [weak self] error in
+      Logger.shared.log(withLevel: .error, message: error.localizedDescription)
+      try? self?.repository.delete(pushFactor)
+      try? self?.keyStorage.deleteKey(withAlias: alias)
+    })
+  }
+  
   struct Constants {
     static let publicKey = "PublicKey"
     static let pushType = "apn"
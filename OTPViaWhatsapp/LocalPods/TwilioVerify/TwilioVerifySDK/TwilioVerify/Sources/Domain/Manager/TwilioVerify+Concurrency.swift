@@ -0,0 +1,290 @@
+//
+//  TwilioVerify+Concurrency.swift
+//  TwilioVerify
+//
+//  Copyright © 2020 Twilio.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+#if compiler(>=5.7) && canImport(_Concurrency)
+import Foundation
+
+///Async variants of the **TwilioVerify** operations. Results are returned on the queue the
+///operation completes on, no extra dispatch is added. Cancelling the task cancels the operation
+///through its `VerifyCancellationToken` and throws `CancellationError`.
+@available(iOS 13.0, *)
+public extension TwilioVerify {
+  
+  /**
+   Creates a **Factor** from a **FactorPayload**
+   - Parameters:
+     - payload: Describes the information needed to create a factor
+   - Returns: The created Factor
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func createFactor(withPayload payload: FactorPayload) async throws -> Factor {
+    try await perform { createFactor(withPayload: payload, success: $0, failure: $1) }
+  }
+  
+  /**
+   Verifies a **Factor** from a **VerifyFactorPayload**
+   - Parameters:
+     - payload: Describes the information needed to verify a factor
+   - Returns: The verified Factor
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func verifyFactor(withPayload payload: VerifyFactorPayload) async throws -> Factor {
+    try await perform { verifyFactor(withPayload: payload, success: $0, failure: $1) }
+  }
+  
+  /**
+   Updates a **Factor** from a **UpdateFactorPayload**
+   - Parameters:
+     - payload: Describes the information needed to update a factor
+   - Returns: The updated Factor
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func updateFactor(withPayload payload: UpdateFactorPayload) async throws -> Factor {
+    try await perform { updateFactor(withPayload: payload, success: $0, failure: $1) }
+  }
+  
+  /**
+   Gets all **Factors** created by the app, this method will return the factors in local storage.
+   - Returns: An array of Factors
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func getAllFactors() async throws -> [Factor] {
+    try await perform { getAllFactors(success: $0, failure: $1) }
+  }
+  
+  /**
+   Deletes a **Factor** with the given **sid**
+   - Parameters:
+     - sid: Sid of the **Factor** to be deleted
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func deleteFactor(withSid sid: String) async throws {
+    try await perform { success, failure in deleteFactor(withSid: sid, success: { success(()) }, failure: failure) }
+  }
+  
+  /**
+   Gets a **Challenge** with the given Challenge sid and Factor sid
+   - Parameters:
+     - challengeSid: Sid of the Challenge requested
+     - factorSid: Sid of the Factor to which the Challenge corresponds
+   - Returns: The requested Challenge
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func getChallenge(challengeSid: String, factorSid: String) async throws -> Challenge {
+    try await perform { getChallenge(challengeSid: challengeSid, factorSid: factorSid, success: $0, failure: $1) }
+  }
+  
+  /**
+   Updates a **Challenge** from a **UpdateChallengePayload**
+   - Parameters:
+     - payload: Describes the information needed to update a challenge
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func updateChallenge(withPayload payload: UpdateChallengePayload) async throws {
+    try await perform { success, failure in updateChallenge(withPayload: payload, success: { success(()) }, failure: failure) }
+  }
+  
+  /**
+   Gets all Challenges associated to a **Factor** with the given **ChallengeListPayload**
+   - Parameters:
+     - payload: Describes the information needed to fetch all the **Challenges**
+   - Returns: A ChallengeList which contains the Challenges and the metadata associated to the request
+   - Throws: `TwilioVerifyError` with the cause of failure
+   */
+  func getAllChallenges(withPayload payload: ChallengeListPayload) async throws -> ChallengeList {
+    try await perform { getAllChallenges(withPayload: payload, success: $0, failure: $1) }
+  }
+}
+
+@available(iOS 13.0, *)
+private extension TwilioVerify {
+  func perform<T>(_ operation: (@escaping (T) -> (), @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken) async throws -> T {
+    let continuation = OperationContinuation<T>()
+    return try await withTaskCancellationHandler {
+      try await withCheckedThrowingContinuation { checkedContinuation in
+        continuation.start(checkedContinuation) {
+          operation({ continuation.resume(with: .success($0)) }, { continuation.resume(with: .failure($0)) })
+        }
+      }
+    } onCancel: {
+      continuation.cancel()
+    }
+  }
+}
+
+///Resumes the continuation of an operation once, either with its result or on cancellation
+@available(iOS 13.0, *)
+private final class OperationContinuation<T> {
+  private let lock = NSLock()
+  private var continuation: CheckedContinuation<T, Error>?
+  private var token: VerifyCancellationToken?
+  private var isCancelled = false
+  
+  func start(_ continuation: CheckedContinuation<T, Error>, operation: () -> VerifyCancellationToken) {
+    lock.lock()
+    guard !isCancelled else {
+      lock.unlock()
+      continuation.resume(throwing: CancellationError())
+      return
+    }
+    self.continuation = continuation
+    lock.unlock()
+    let token = operation()
+    lock.lock()
+    self.token = token
+    let cancelled = isCancelled
+    lock.unlock()
+    if cancelled {
+      token.cancel()
+    }
+  }
+  
+  func resume(with result: Result<T, Error>) {
+    lock.lock()
+    let continuation = self.continuation
+    self.continuation = nil
+    lock.unlock()
+    continuation?.resume(with: result)
+  }
+  
+  func cancel() {
+    lock.lock()
+    isCancelled = true
+    let token = self.token
+    let continuation = self.continuation
+    self.continuation = nil
+    lock.unlock()
+    token?.cancel()
+    continuation?.resume(throwing: CancellationError())
+  }
+}
+
+///Actor isolated cache of the **Factors** stored by a **TwilioVerify** instance. Factors are loaded
+///once and kept in sync with the factor operations performed through the store.
+@available(iOS 13.0, *)
+public actor FactorStore {
+  private let twilioVerify: TwilioVerify
+  private var factors: [Factor]?
+  private var loadTask: Task<[Factor], Error>?
+  ///Bumped by every change made while the factors are not cached, so a load that started before it is discarded
+  private var generation = 0
+  
+  /**
+   Creates a **FactorStore** backed by the given **TwilioVerify** instance
+   - Parameters:
+     - twilioVerify: Instance used to load and modify factors
+   */
+  public init(twilioVerify: TwilioVerify) {
+    self.twilioVerify = twilioVerify
+  }
+  
+  ///Gets all **Factors**, loading them from local storage only on the first call.
+  public func allFactors() async throws -> [Factor] {
+    while true {
+      if let factors = factors {
+        return factors
+      }
+      let generation = self.generation
+      let task = loadTask ?? startLoading()
+      defer {
+        if generation == self.generation {
+          loadTask = nil
+        }
+      }
+      let loaded = try await task.value
+      guard generation == self.generation else {
+        continue
+      }
+      if factors == nil {
+        factors = loaded
+      }
+      return factors ?? loaded
+    }
+  }
+  
+  ///Gets the **Factor** with the given sid, `nil` if it does not exist
+  public func factor(withSid sid: String) async throws -> Factor? {
+    try await allFactors().first { $0.sid == sid }
+  }
+  
+  ///Creates a **Factor** and adds it to the store
+  public func createFactor(withPayload payload: FactorPayload) async throws -> Factor {
+    let factor = try await twilioVerify.createFactor(withPayload: payload)
+    store(factor)
+    return factor
+  }
+  
+  ///Verifies a **Factor** and replaces the stored one
+  public func verifyFactor(withPayload payload: VerifyFactorPayload) async throws -> Factor {
+    let factor = try await twilioVerify.verifyFactor(withPayload: payload)
+    store(factor)
+    return factor
+  }
+  
+  ///Updates a **Factor** and replaces the stored one
+  public func updateFactor(withPayload payload: UpdateFactorPayload) async throws -> Factor {
+    let factor = try await twilioVerify.updateFactor(withPayload: payload)
+    store(factor)
+    return factor
+  }
+  
+  ///Deletes a **Factor** and removes it from the store
+  public func deleteFactor(withSid sid: String) async throws {
+    try await twilioVerify.deleteFactor(withSid: sid)
+    guard factors != nil else {
+      return discardLoad()
+    }
+    factors?.removeAll { $0.sid == sid }
+  }
+  
+  ///Drops the cached factors, the next read loads them again from local storage
+  public func invalidate() {
+    factors = nil
+    discardLoad()
+  }
+}
+
+@available(iOS 13.0, *)
+private extension FactorStore {
+  func startLoading() -> Task<[Factor], Error> {
+    let twilioVerify = self.twilioVerify
+    let task = Task { try await twilioVerify.getAllFactors() }
+    loadTask = task
+    return task
+  }
+  
+  ///Makes a load in flight start over once it completes, its result may predate the latest change
+  func discardLoad() {
+    generation += 1
+    loadTask = nil
+  }
+  
+  func store(_ factor: Factor) {
+    guard var factors = factors else {
+      return discardLoad()
+    }
+    if let index = factors.firstIndex(where: { $0.sid == factor.sid }) {
+      factors[index] = factor
+    } else {
+      factors.append(factor)
+    }
+    self.factors = factors
+  }
+}
+#endif
@@ -39,12 +39,16 @@ public protocol TwilioVerify {
      - payload: Describes the information needed to create a factor
      - success: Closure to be called when the operation succeeds, returns the created Factor
      - failure: Closure to be called when the operation fails with the cause of failure
+   - Returns: A `VerifyCancellationToken` to cancel the operation. A factor that the Verify API creates while the
+     operation is being cancelled is deleted again. If its key pair was already deleted by then, only the
+     local copy is removed and the factor has to be deleted from the Verify API by the caller's backend
    */
+  @discardableResult
   func createFactor(
     withPayload payload: FactorPayload,
     success: @escaping FactorSuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
   
   /**
   Verifies a **Factor** from a **VerifyFactorPayload**
@@ -52,12 +56,14 @@ public protocol TwilioVerify {
     - payload: Describes the information needed to verify a factor
     - success: Closure to be called when the operation succeeds, returns the verified Factor
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
+  @discardableResult
   func verifyFactor(
     withPayload payload: VerifyFactorPayload,
     success: @escaping FactorSuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
 
   /**
   Updates a **Factor** from a **UpdateFactorPayload**
@@ -65,23 +71,27 @@ public protocol TwilioVerify {
     - payload: Describes the information needed to update a factor
     - success: Closure to be called when the operation succeeds, returns the updated Factor
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
+  @discardableResult
   func updateFactor(
     withPayload payload: UpdateFactorPayload,
     success: @escaping FactorSuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
 
   /**
   Gets all **Factors** created by the app, this method will return the factors in local storage.
   - Parameters:
     - success: Closure to be called when the operation succeeds, returns an array of Factors
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
+  @discardableResult
   func getAllFactors(
     success: @escaping FactorListSuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
 
   /**
   Deletes a **Factor** with the given **sid**. This method calls **Verify Push API** to delete
@@ -90,12 +100,14 @@ public protocol TwilioVerify {
     - sid: Sid of the **Factor** to be deleted
     - success: Closure to be called when the operation succeeds
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
+  @discardableResult
   func deleteFactor(
     withSid sid: String,
     success: @escaping EmptySuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
   
   /**
   Gets a **Challenge** with the given Challenge sid and Factor sid
@@ -104,13 +116,15 @@ public protocol TwilioVerify {
     - factorSid: Sid of the Factor to which the Challenge corresponds
     - success: Closure to be called when the operation succeeds, returns the requested Challenge
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
+  @discardableResult
   func getChallenge(
     challengeSid: String,
     factorSid: String,
     success: @escaping ChallengeSuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
 
   /**
   Updates a **Challenge** from a **UpdateChallengePayload**
@@ -118,12 +132,14 @@ public protocol TwilioVerify {
      - payload: Describes the information needed to update a challenge
      - success: Closure to be called when the operation succeeds
      - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
+  @discardableResult
   func updateChallenge(
     withPayload payload: UpdateChallengePayload,
     success: @escaping EmptySuccessBlock,
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
   
   /**
   Gets all Challenges associated to a **Factor** with the given **ChallengeListPayload**
@@ -132,12 +148,14 @@ public protocol TwilioVerify {
      - success: Closure to be called when the operation succeeds, returns a ChallengeList
                 which contains the Challenges and the metadata associated to the request
      - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
+  @discardableResult
   func getAllChallenges(
     withPayload payload: ChallengeListPayload,
     success: @escaping (ChallengeList) -> (),
     failure: @escaping TwilioVerifyErrorBlock
-  )
+  ) -> VerifyCancellationToken
   
   /**
    Clears local storage, it will delete factors and key pairs in this device.
@@ -157,6 +175,7 @@ public class TwilioVerifyBuilder {
   private var clearStorageOnReinstall: Bool
   private var accessGroup: String?
   private var loggingServices: [LoggerService]
+  private var compression: CompressionConfig
   
   /// Creates a new instance of TwilioVerifyBuilder
   public init() {
@@ -164,6 +183,7 @@ public class TwilioVerifyBuilder {
     _baseURL = baseURL
     clearStorageOnReinstall = true
     loggingServices = []
+    compression = .default
   }
 
   /// Set the NetworkProvider that will be used by the `TwilioVerify` instance.
@@ -210,6 +230,17 @@ public class TwilioVerifyBuilder {
     return self
   }
 
+  /**
+   Enables gzip compression of request bodies
+    - Parameters:
+      - enabled: If true, request bodies of at least `threshold` bytes are sent gzip encoded. Default value is false
+      - threshold: Minimum body size in bytes to compress, smaller bodies are sent as is
+   */
+  public func setRequestCompression(enabled: Bool, threshold: Int = 1024) -> Self {
+    compression = CompressionConfig(compressRequestBody: enabled, threshold: threshold)
+    return self
+  }
+
   /// Set the UserDefaults group that will be used to store configurations
   private func userDefaults() -> UserDefaults {
     if let accessGroup = accessGroup, let userDefaults = UserDefaults(suiteName: accessGroup) {
@@ -241,6 +272,7 @@ public class TwilioVerifyBuilder {
         .setClearStorageOnReinstall(clearStorageOnReinstall)
         .setAccessGroup(accessGroup)
         .setUserDefaults(userDefaults())
+        .setCompression(compression)
         .build()
       let challengeFacade = ChallengeFacade.Builder()
         .setNetworkProvider(networkProvider)
@@ -248,6 +280,7 @@ public class TwilioVerifyBuilder {
         .setURL(_baseURL)
         .setAuthentication(authentication)
         .setFactorFacade(factorFacade)
+        .setCompression(compression)
         .build()
       return TwilioVerifyManager(factorFacade: factorFacade, challengeFacade: challengeFacade)
     } catch {
@@ -38,9 +38,11 @@ extension TwilioVerifyManager: TwilioVerify {
     - payload: Describes the information needed to create a factor
     - success: Closure to be called when the operation succeeds, returns the created Factor
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
-  public func createFactor(withPayload payload: FactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
-    factorFacade.createFactor(withPayload: payload, success: success, failure: failure)
+  @discardableResult
+  public func createFactor(withPayload payload: FactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    return factorFacade.createFactor(withPayload: payload, success: success, failure: failure)
   }
   
   /**
@@ -49,9 +51,11 @@ extension TwilioVerifyManager: TwilioVerify {
     - payload: Describes the information needed to verify a factor
     - success: Closure to be called when the operation succeeds, returns the verified Factor
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
-  public func verifyFactor(withPayload payload: VerifyFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
-    factorFacade.verifyFactor(withPayload: payload, success: success, failure: failure)
+  @discardableResult
+  public func verifyFactor(withPayload payload: VerifyFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    return factorFacade.verifyFactor(withPayload: payload, success: success, failure: failure)
   }
   
   /**
@@ -60,9 +64,11 @@ extension TwilioVerifyManager: TwilioVerify {
     - payload: Describes the information needed to update a factor
     - success: Closure to be called when the operation succeeds, returns the updated Factor
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
-  public func updateFactor(withPayload payload: UpdateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
-    factorFacade.updateFactor(withPayload: payload, success: success, failure: failure)
+  @discardableResult
+  public func updateFactor(withPayload payload: UpdateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    return factorFacade.updateFactor(withPayload: payload, success: success, failure: failure)
   }
   
   /**
@@ -70,9 +76,12 @@ extension TwilioVerifyManager: TwilioVerify {
   - Parameters:
     - success: Closure to be called when the operation succeeds, returns an array of Factors
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
-  public func getAllFactors(success: @escaping FactorListSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
+  @discardableResult
+  public func getAllFactors(success: @escaping FactorListSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
     factorFacade.getAll(success: success, failure: failure)
+    return .finished
   }
   
   /**
@@ -81,9 +90,11 @@ extension TwilioVerifyManager: TwilioVerify {
     - sid: Sid of the **Factor** to be deleted
     - success: Closure to be called when the operation succeeds
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
-  public func deleteFactor(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
-    factorFacade.delete(withSid: sid, success: success, failure: failure)
+  @discardableResult
+  public func deleteFactor(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    return factorFacade.delete(withSid: sid, success: success, failure: failure)
   }
   
   /**
@@ -93,9 +104,11 @@ extension TwilioVerifyManager: TwilioVerify {
     - factorSid: Sid of the Factor to which the Challenge corresponds
     - success: Closure to be called when the operation succeeds, returns the requested Challenge
     - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
-  public func getChallenge(challengeSid: String, factorSid: String, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
-    challengeFacade.get(withSid: challengeSid, withFactorSid: factorSid, success: success, failure: failure)
+  @discardableResult
+  public func getChallenge(challengeSid: String, factorSid: String, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    return challengeFacade.get(withSid: challengeSid, withFactorSid: factorSid, success: success, failure: failure)
   }
   
   /**
@@ -104,9 +117,11 @@ extension TwilioVerifyManager: TwilioVerify {
      - payload: Describes the information needed to update a challenge
      - success: Closure to be called when the operation succeeds
      - failure: Closure to be called when the operation fails with the cause of failure
+  - Returns: A `VerifyCancellationToken` to cancel the operation
   */
-  public func updateChallenge(withPayload payload: UpdateChallengePayload, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) {
-    challengeFacade.update(withPayload: payload, success: success, failure: failure)
+  @discardableResult
+  public func updateChallenge(withPayload payload: UpdateChallengePayload, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    return challengeFacade.update(withPayload: payload, success: success, failure: failure)
   }
   
   /**
@@ -115,9 +130,11 @@ extension TwilioVerifyManager: TwilioVerify {
       - payload: Describes the information needed to fetch all the **Challenges**
       - success: Closure to be called when the operation succeeds, returns a ChallengeList which contains the Challenges and the metadata associated to the request
       - failure: Closure to be called when the operation fails with the cause of failure
+   - Returns: A `VerifyCancellationToken` to cancel the operation
    */
-  public func getAllChallenges(withPayload payload: ChallengeListPayload, success: @escaping (ChallengeList) -> (), failure: @escaping TwilioVerifyErrorBlock) {
-    challengeFacade.getAll(withPayload: payload, success: success, failure: failure)
+  @discardableResult
+  public func getAllChallenges(withPayload payload: ChallengeListPayload, success: @escaping (ChallengeList) -> (), failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+    return challengeFacade.getAll(withPayload: payload, success: success, failure: failure)
   }
   
   /**
@@ -0,0 +1,61 @@
+//
+//  ContentEncoding.swift
+//  TwilioVerify
+//
+//  Copyright © 2020 Twilio.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Foundation
+
+enum ContentEncoding {
+  case gzip
+  case deflate
+  case brotli
+}
+
+extension ContentEncoding {
+  var value: String {
+    switch self {
+      case .gzip:
+        return "gzip"
+      case .deflate:
+        return "deflate"
+      case .brotli:
+        return "br"
+    }
+  }
+
+  init?(value: String) {
+    switch value.trimmingCharacters(in: .whitespaces).lowercased() {
+      case ContentEncoding.gzip.value:
+        self = .gzip
+      case ContentEncoding.deflate.value:
+        self = .deflate
+      case ContentEncoding.brotli.value:
+        self = .brotli
+      default:
+        return nil
+    }
+  }
+
+  /// Encodings advertised in `Accept-Encoding`. Brotli is only offered where `HTTPCompression` can decode
+  /// it as well, for a `NetworkProvider` that hands the body over still encoded.
+  static var accepted: [ContentEncoding] {
+    if #available(iOS 15.0, *) {
+      return [.gzip, .deflate, .brotli]
+    }
+    return [.gzip, .deflate]
+  }
+}
@@ -0,0 +1,117 @@
+//
+//  FormEncoder.swift
+//  TwilioVerify
+//
+//  Copyright © 2020 Twilio.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Foundation
+
+/// Writes `application/x-www-form-urlencoded` bodies straight into a byte buffer.
+/// The output is byte-identical to percent-encoding every `name=value` pair with `.customURLQueryAllowed`.
+struct FormEncoder {
+  private var buffer: [UInt8] = []
+
+  init(capacity: Int = Constants.defaultCapacity) {
+    buffer.reserveCapacity(capacity)
+  }
+
+  var data: Data {
+    Data(buffer)
+  }
+
+  var string: String {
+    String(decoding: buffer, as: UTF8.self)
+  }
+
+  mutating func append(_ parameter: Parameter) {
+    if let values = parameter.value as? [Any] {
+      values.forEach { appendPair(name: parameter.name, isArray: true, value: $0) }
+    } else {
+      appendPair(name: parameter.name, isArray: false, value: parameter.value)
+    }
+  }
+}
+
+private extension FormEncoder {
+  mutating func appendPair(name: String, isArray: Bool, value: Any) {
+    if !buffer.isEmpty {
+      buffer.append(Constants.separator)
+    }
+    appendEscaped(name.utf8)
+    if isArray {
+      buffer.append(contentsOf: Constants.escapedArraySuffix)
+    }
+    buffer.append(Constants.assignment)
+    appendValue(value)
+  }
+
+  // Exact type checks keep the output identical to `"\(value)"`, e.g. for NSNumber or Optional values.
+  mutating func appendValue(_ value: Any) {
+    switch value {
+      case let string as String where type(of: value) == String.self:
+        appendEscaped(string.utf8)
+      case let integer as Int where type(of: value) == Int.self:
+        appendInteger(integer)
+      case let bool as Bool where type(of: value) == Bool.self:
+        buffer.append(contentsOf: bool ? Constants.trueValue : Constants.falseValue)
+      default:
+        appendEscaped(String(describing: value).utf8)
+    }
+  }
+
+  mutating func appendEscaped(_ bytes: String.UTF8View) {
+    for byte in bytes {
+      if Constants.allowed[Int(byte)] {
+        buffer.append(byte)
+      } else {
+        buffer.append(Constants.percent)
+        buffer.append(Constants.hexDigits[Int(byte >> 4)])
+        buffer.append(Constants.hexDigits[Int(byte & 0x0F)])
+      }
+    }
+  }
+
+  mutating func appendInteger(_ value: Int) {
+    if value < 0 {
+      buffer.append(Constants.minus)
+    }
+    let start = buffer.endIndex
+    var magnitude = value.magnitude
+    repeat {
+      buffer.append(Constants.zero + UInt8(magnitude % 10))
+      magnitude /= 10
+    } while magnitude > 0
+    buffer[start...].reverse()
+  }
+}
+
+extension FormEncoder {
+  struct Constants {
+    static let defaultCapacity = 256
+    static let separator = UInt8(ascii: "&")
+    static let assignment = UInt8(ascii: "=")
+    static let percent = UInt8(ascii: "%")
+    static let minus = UInt8(ascii: "-")
+    static let zero = UInt8(ascii: "0")
+    static let escapedArraySuffix = Array("%5B%5D".utf8)
+    static let trueValue = Array("true".utf8)
+    static let falseValue = Array("false".utf8)
+    static let hexDigits = Array("0123456789ABCDEF".utf8)
+    static let allowed: [Bool] = (0...UInt8.max).map {
+      $0 < 0x80 && CharacterSet.customURLQueryAllowed.contains(Unicode.Scalar($0))
+    }
+  }
+}
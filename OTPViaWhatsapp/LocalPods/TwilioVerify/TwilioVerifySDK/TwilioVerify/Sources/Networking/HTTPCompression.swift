@@ -0,0 +1,276 @@
+//
+//  HTTPCompression.swift
+//  TwilioVerify
+//
+//  Copyright © 2020 Twilio.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Compression
+import Foundation
+
+struct CompressionConfig {
+  let compressRequestBody: Bool
+  let threshold: Int
+
+  init(compressRequestBody: Bool, threshold: Int = Constants.defaultThreshold) {
+    self.compressRequestBody = compressRequestBody
+    self.threshold = max(threshold, 1)
+  }
+
+  static let `default` = CompressionConfig(compressRequestBody: false)
+
+  func shouldCompress(_ body: Data) -> Bool {
+    compressRequestBody && body.count >= threshold
+  }
+}
+
+extension CompressionConfig {
+  struct Constants {
+    static let defaultThreshold = 1024
+  }
+}
+
+enum CompressionError: LocalizedError {
+  case initializationFailed
+  case invalidHeader
+  case corruptedData
+  case unsupportedEncoding
+
+  var errorDescription: String? {
+    switch self {
+      case .initializationFailed:
+        return "Unable to initialize compression stream"
+      case .invalidHeader:
+        return "Invalid compressed data header"
+      case .corruptedData:
+        return "Compressed data is corrupted"
+      case .unsupportedEncoding:
+        return "Compressed data uses an encoding this OS version cannot decode"
+    }
+  }
+}
+
+enum HTTPCompression {
+
+  static func gzip(_ data: Data) throws -> Data {
+    var output = Data(Constants.gzipHeader)
+    output.reserveCapacity(Constants.gzipHeader.count + data.count / 2 + Constants.gzipTrailerSize)
+    try process(data, operation: COMPRESSION_STREAM_ENCODE, algorithm: COMPRESSION_ZLIB, into: &output)
+    output.appendLittleEndian(CRC32.checksum(data))
+    output.appendLittleEndian(UInt32(truncatingIfNeeded: data.count))
+    return output
+  }
+
+  static func decompress(_ data: Data, encoding: ContentEncoding) throws -> Data {
+    let payload: Range<Data.Index>
+    var algorithm = COMPRESSION_ZLIB
+    switch encoding {
+      case .gzip:
+        payload = try gzipPayload(data)
+      case .deflate:
+        payload = try zlibPayload(data)
+      case .brotli:
+        guard #available(iOS 15.0, *) else {
+          throw CompressionError.unsupportedEncoding
+        }
+        payload = data.startIndex..<data.endIndex
+        algorithm = COMPRESSION_BROTLI
+    }
+    var output = Data()
+    output.reserveCapacity(payload.count * Constants.expectedRatio)
+    try process(data[payload], operation: COMPRESSION_STREAM_DECODE, algorithm: algorithm, into: &output)
+    if encoding == .deflate, Adler32.checksum(output) != data[payload.endIndex...].reduce(0, { $0 << 8 | UInt32($1) }) {
+      throw CompressionError.corruptedData
+    }
+    return output
+  }
+
+  /// URLSession already decodes gzip/deflate bodies, this only kicks in when a body still carries
+  /// a compressed stream header, e.g. when a custom `NetworkProvider` does not decode it.
+  static func decodeIfNeeded(_ data: Data, headers: [AnyHashable: Any]) throws -> Data {
+    guard let value = headers.first(where: {
+      ($0.key as? String)?.compare(HTTPHeader.Constant.contentEncoding, options: .caseInsensitive) == .orderedSame
+    })?.value as? String, let encoding = ContentEncoding(value: value) else {
+      return data
+    }
+    switch encoding {
+      case .gzip where isGzipStream(data),
+           .deflate where isZlibStream(data):
+        return try decompress(data, encoding: encoding)
+      case .brotli:
+        // Brotli has no magic number, a body that does not decode is taken as already decoded.
+        return (try? decompress(data, encoding: encoding)) ?? data
+      default:
+        return data
+    }
+  }
+}
+
+private extension HTTPCompression {
+  static func process(_ input: Data, operation: compression_stream_operation, algorithm: compression_algorithm,
+                      into output: inout Data) throws {
+    guard !input.isEmpty else {
+      throw CompressionError.corruptedData
+    }
+    let stream = UnsafeMutablePointer<compression_stream>.allocate(capacity: 1)
+    defer { stream.deallocate() }
+    guard compression_stream_init(stream, operation, algorithm) == COMPRESSION_STATUS_OK else {
+      throw CompressionError.initializationFailed
+    }
+    defer { compression_stream_destroy(stream) }
+    let buffer = UnsafeMutablePointer<UInt8>.allocate(capacity: Constants.chunkSize)
+    defer { buffer.deallocate() }
+    try input.withUnsafeBytes { (source: UnsafeRawBufferPointer) in
+      // swiftlint:disable:next force_unwrapping
+      stream.pointee.src_ptr = source.bindMemory(to: UInt8.self).baseAddress!
+      stream.pointee.src_size = source.count
+      let flags = Int32(COMPRESSION_STREAM_FINALIZE.rawValue)
+      var status: compression_status
+      repeat {
+        stream.pointee.dst_ptr = buffer
+        stream.pointee.dst_size = Constants.chunkSize
+        status = compression_stream_process(stream, flags)
+        guard status == COMPRESSION_STATUS_OK || status == COMPRESSION_STATUS_END else {
+          throw CompressionError.corruptedData
+        }
+        output.append(buffer, count: Constants.chunkSize - stream.pointee.dst_size)
+      } while status == COMPRESSION_STATUS_OK
+    }
+  }
+
+  static func isGzipStream(_ data: Data) -> Bool {
+    data.count > Constants.gzipHeader.count + Constants.gzipTrailerSize &&
+      data[data.startIndex] == Constants.gzipHeader[0] &&
+      data[data.startIndex + 1] == Constants.gzipHeader[1]
+  }
+
+  static func isZlibStream(_ data: Data) -> Bool {
+    guard data.count > Constants.zlibHeaderSize + Constants.zlibTrailerSize else {
+      return false
+    }
+    let cmf = UInt16(data[data.startIndex])
+    let flg = UInt16(data[data.startIndex + 1])
+    return cmf & 0x0F == Constants.deflateMethod && (cmf << 8 | flg) % 31 == 0
+  }
+
+  /// The raw deflate data between the zlib header and its Adler-32 trailer.
+  static func zlibPayload(_ data: Data) throws -> Range<Data.Index> {
+    guard isZlibStream(data), data[data.startIndex + 1] & ZlibFlag.presetDictionary == 0 else {
+      throw CompressionError.invalidHeader
+    }
+    return data.startIndex + Constants.zlibHeaderSize..<data.endIndex - Constants.zlibTrailerSize
+  }
+
+  static func gzipPayload(_ data: Data) throws -> Range<Data.Index> {
+    guard isGzipStream(data), UInt16(data[data.startIndex + 2]) == Constants.deflateMethod else {
+      throw CompressionError.invalidHeader
+    }
+    let flags = data[data.startIndex + 3]
+    var index = data.startIndex + Constants.gzipHeader.count
+    let end = data.endIndex - Constants.gzipTrailerSize
+    if flags & GzipFlag.extra != 0 {
+      guard index + 2 <= end else { throw CompressionError.invalidHeader }
+      index += 2 + (Int(data[index]) | Int(data[index + 1]) << 8)
+    }
+    for flag in [GzipFlag.name, GzipFlag.comment] where flags & flag != 0 {
+      guard index < end, let terminator = data[index..<end].firstIndex(of: 0) else { throw CompressionError.invalidHeader }
+      index = terminator + 1
+    }
+    if flags & GzipFlag.headerCRC != 0 {
+      index += 2
+    }
+    guard index < end else {
+      throw CompressionError.invalidHeader
+    }
+    return index..<end
+  }
+}
+
+extension HTTPCompression {
+  struct Constants {
+    static let gzipHeader: [UInt8] = [0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xFF]
+    static let gzipTrailerSize = 8
+    static let zlibHeaderSize = 2
+    static let zlibTrailerSize = 4
+    static let deflateMethod: UInt16 = 8
+    static let chunkSize = 16 * 1024
+    static let expectedRatio = 4
+  }
+
+  struct GzipFlag {
+    static let headerCRC: UInt8 = 0x02
+    static let extra: UInt8 = 0x04
+    static let name: UInt8 = 0x08
+    static let comment: UInt8 = 0x10
+  }
+
+  struct ZlibFlag {
+    static let presetDictionary: UInt8 = 0x20
+  }
+}
+
+enum CRC32 {
+  private static let table: [UInt32] = (0...255).map { index -> UInt32 in
+    (0..<8).reduce(UInt32(index)) { crc, _ in
+      crc & 1 == 1 ? Constants.polynomial ^ (crc >> 1) : crc >> 1
+    }
+  }
+
+  static func checksum(_ data: Data) -> UInt32 {
+    let crc = data.reduce(~UInt32(0)) { crc, byte in
+      table[Int((crc ^ UInt32(byte)) & 0xFF)] ^ (crc >> 8)
+    }
+    return ~crc
+  }
+}
+
+private extension CRC32 {
+  struct Constants {
+    static let polynomial: UInt32 = 0xEDB88320
+  }
+}
+
+enum Adler32 {
+  static func checksum(_ data: Data) -> UInt32 {
+    var low: UInt32 = 1
+    var high: UInt32 = 0
+    var block = data[...]
+    while !block.isEmpty {
+      for byte in block.prefix(Constants.maxBlockSize) {
+        low += UInt32(byte)
+        high += low
+      }
+      low %= Constants.modulus
+      high %= Constants.modulus
+      block = block.dropFirst(Constants.maxBlockSize)
+    }
+    return high << 16 | low
+  }
+}
+
+private extension Adler32 {
+  struct Constants {
+    static let modulus: UInt32 = 65521
+    /// Largest number of bytes summed before `high` could overflow a `UInt32`.
+    static let maxBlockSize = 5552
+  }
+}
+
+private extension Data {
+  mutating func appendLittleEndian(_ value: UInt32) {
+    var littleEndian = value.littleEndian
+    Swift.withUnsafeBytes(of: &littleEndian) { append(contentsOf: $0) }
+  }
+}
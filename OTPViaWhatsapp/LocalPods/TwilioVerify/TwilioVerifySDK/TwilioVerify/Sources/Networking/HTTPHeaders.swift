@@ -0,0 +1,159 @@
+//
+//  HTTPHeaders.swift
+//  TwilioVerify
+//
+//  Copyright © 2020 Twilio.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Foundation
+
+/// Flat, ordered header list for one request.
+///
+/// Headers and their lowercased names live side by side in one contiguous array. It is allocated once per
+/// request with room for a typical request, so adding headers does not regrow it, and iteration walks it
+/// in order. Names match case-insensitively; adding a header whose name is already present replaces that
+/// header, spelling of the name included, at the position of the first one. The lowercased names of the
+/// headers this SDK sends are computed once and shared by every request.
+struct HTTPHeaders {
+  private var fields: ContiguousArray<(name: String, header: HTTPHeader)> = []
+  
+  init() {
+    fields.reserveCapacity(Constants.reservedCapacity)
+  }
+  
+  mutating func addAll(_ headers: [HTTPHeader]) {
+    headers.forEach { add($0) }
+  }
+  
+  private mutating func add(_ header: HTTPHeader) {
+    update(header)
+  }
+  
+  private mutating func update(_ header: HTTPHeader) {
+    let name = HTTPHeaders.canonicalName(header.key)
+    guard let index = fields.firstIndex(where: { $0.name == name }) else {
+      fields.append((name, header))
+      return
+    }
+    
+    fields[index].header = header
+  }
+  
+  func value(for name: String) -> String? {
+    let name = HTTPHeaders.canonicalName(name)
+    return fields.first(where: { $0.name == name })?.header.value
+  }
+  
+  var dictionary: [String: String]? {
+    var dictionary = [String: String](minimumCapacity: fields.count)
+    fields.forEach { dictionary[$0.header.key] = $0.header.value }
+    
+    return dictionary
+  }
+}
+
+extension HTTPHeaders: RandomAccessCollection {
+  var startIndex: Int {
+    fields.startIndex
+  }
+  
+  var endIndex: Int {
+    fields.endIndex
+  }
+  
+  subscript(position: Int) -> HTTPHeader {
+    fields[position].header
+  }
+}
+
+private extension HTTPHeaders {
+  
+  struct Constants {
+    static let reservedCapacity = 16
+    static let knownNames: [String: String] = Dictionary(uniqueKeysWithValues: [
+      HTTPHeader.Constant.acceptType,
+      HTTPHeader.Constant.contentType,
+      HTTPHeader.Constant.acceptEncoding,
+      HTTPHeader.Constant.contentEncoding,
+      HTTPHeader.Constant.userAgent,
+      HTTPHeader.Constant.authorization
+    ].map { ($0, $0.lowercased()) })
+  }
+  
+  static func canonicalName(_ name: String) -> String {
+    Constants.knownNames[name] ?? name.lowercased()
+  }
+}
+
+struct HTTPHeader: Hashable {
+  
+  let key: String
+  let value: String
+  
+  init(key: String, value: String) {
+    self.key = key
+    self.value = value
+  }
+}
+
+extension HTTPHeader {
+  
+  static func accept(_ value: String) -> HTTPHeader {
+    HTTPHeader(key: Constant.acceptType, value: value)
+  }
+  
+  static func contentType(_ value: String) -> HTTPHeader {
+    HTTPHeader(key: Constant.contentType, value: value)
+  }
+  
+  static func acceptEncoding(_ encodings: [ContentEncoding]) -> HTTPHeader {
+    HTTPHeader(key: Constant.acceptEncoding, value: encodings.map { $0.value }.joined(separator: ", "))
+  }
+  
+  static func contentEncoding(_ encoding: ContentEncoding) -> HTTPHeader {
+    HTTPHeader(key: Constant.contentEncoding, value: encoding.value)
+  }
+  
+  static func userAgent(_ value: String) -> HTTPHeader {
+    HTTPHeader(key: Constant.userAgent, value: value)
+  }
+  
+  static func authorization(username: String, password: String) -> HTTPHeader {
+    let credential = Data("\(username):\(password)".utf8).base64EncodedString()
+    
+    return authorization("\(Constant.basic) \(credential)")
+  }
+  
+  static func authorization(bearerToken: String) -> HTTPHeader {
+    authorization("\(Constant.basic) \(bearerToken)")
+  }
+  
+  static func authorization(_ value: String) -> HTTPHeader {
+    HTTPHeader(key: Constant.authorization, value: value)
+  }
+}
+
+extension HTTPHeader {
+  struct Constant {
+    static let acceptType = "Accept"
+    static let contentType = "Content-Type"
+    static let acceptEncoding = "Accept-Encoding"
+    static let contentEncoding = "Content-Encoding"
+    static let userAgent = "User-Agent"
+    static let basic = "Basic"
+    static let bearer = "Bearer"
+    static let authorization = "Authorization"
+  }
+}
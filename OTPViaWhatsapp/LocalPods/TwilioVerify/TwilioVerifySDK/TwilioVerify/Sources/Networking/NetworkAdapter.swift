@@ -29,14 +29,23 @@ final class NetworkAdapter: NetworkProvider {
   }
   
   // MARK: - Internal Methods
+  @discardableResult
   func execute(
     _ urlRequest: URLRequest,
     success: @escaping SuccessResponseBlock,
     failure: @escaping FailureBlock
-  ) {
+  ) -> VerifyCancellationToken {
     log(urlRequest)
     
-    session.dataTask(with: urlRequest) { result in
+    let token = VerifyCancellationToken()
+    let task = session.dataTask(with: urlRequest) { result in
+      guard token.finish() else {
+        Logger.shared.log(
+          withLevel: .info,
+          message: "Cancelled \(urlRequest.httpMethod) to \(urlRequest.url)"
+        )
+        return
+      }
       switch result {
         case .success(let response):
           success(response)
@@ -48,7 +57,10 @@ final class NetworkAdapter: NetworkProvider {
           )
           failure(error)
       }
-    }.resume()
+    }
+    token.onCancel(task.cancel)
+    task.resume()
+    return token
   }
   
   // MARK: - Private Methods
@@ -117,8 +129,15 @@ private extension URLSession {
         result(.failure(NetworkError.failureStatusCode(failureResponse: failureResponse)))
         return
       }
-      URLSession.log(response, data: data)
-      result(.success(NetworkResponse(data: data, headers: response.allHeaderFields)))
+      let body: Data
+      do {
+        body = try HTTPCompression.decodeIfNeeded(data, headers: response.allHeaderFields)
+      } catch {
+        result(.failure(NetworkError.invalidResponse(errorResponse: data)))
+        return
+      }
+      URLSession.log(response, data: body)
+      result(.success(NetworkResponse(data: body, headers: response.allHeaderFields)))
     }
   }
   
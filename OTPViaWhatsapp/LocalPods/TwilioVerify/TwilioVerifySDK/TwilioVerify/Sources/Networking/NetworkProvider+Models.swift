@@ -27,11 +27,12 @@ public typealias FailureBlock = (Error) -> ()
 // MARK: - Protocols
 
 public protocol NetworkProvider {
+  @discardableResult
   func execute(
     _ urlRequest: URLRequest,
     success: @escaping SuccessResponseBlock,
     failure: @escaping FailureBlock
-  )
+  ) -> VerifyCancellationToken
 }
 
 // MARK: - Models
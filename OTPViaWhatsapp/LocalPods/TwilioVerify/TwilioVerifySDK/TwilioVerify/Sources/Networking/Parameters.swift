@@ -21,6 +21,7 @@ import Foundation
 
 struct Parameters {
   private var parameters: [Parameter] = []
+  private var indexes: [String: Int] = [:]
   
   mutating func addAll(_ parameters: [Parameter]) {
     parameters.forEach { add($0) }
@@ -31,12 +32,13 @@ struct Parameters {
   }
   
   private mutating func update(_ parameter: Parameter) {
-    guard let index = parameters.firstIndex(of: parameter) else {
+    guard let index = indexes[parameter.name] else {
+      indexes[parameter.name] = parameters.endIndex
       parameters.append(parameter)
       return
     }
     
-    parameters.replaceSubrange(index...index, with: [parameter])
+    parameters[index] = parameter
   }
   
   private var dictionary: [String: Any] {
@@ -46,22 +48,17 @@ struct Parameters {
   }
   
   func asString() -> String {
-    var data = [String]()
-    parameters.forEach { parameter in
-      if let values = parameter.value as? [Any] {
-        values.forEach {
-          data.append(parameter.name + "[]=\($0)")
-        }
-      } else {
-        data.append(parameter.name + "=\(parameter.value)")
-      }
-    }
-    return data.map { encode(String($0)) }.joined(separator: "&")
+    formEncoded().string
+  }
+  
+  func asFormData() -> Data {
+    formEncoded().data
   }
   
-  private func encode(_ parameter: Any) -> String {
-    guard let parameter = parameter as? String else { return String() }
-    return parameter.addingPercentEncoding(withAllowedCharacters: .customURLQueryAllowed) ?? ""
+  private func formEncoded() -> FormEncoder {
+    var encoder = FormEncoder()
+    parameters.forEach { encoder.append($0) }
+    return encoder
   }
   
   func asData() throws -> Data {
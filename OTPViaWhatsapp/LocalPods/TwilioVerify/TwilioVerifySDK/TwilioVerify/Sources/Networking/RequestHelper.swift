@@ -24,9 +24,11 @@ class RequestHelper {
   
   private let appInfo: [String: Any]?
   private let authorization: BasicAuthorization
+  let compression: CompressionConfig
   
-  required init(authorization: BasicAuthorization) {
+  required init(authorization: BasicAuthorization, compression: CompressionConfig = .default) {
     self.authorization = authorization
+    self.compression = compression
     self.appInfo = Bundle.main.infoDictionary
   }
   
@@ -45,7 +47,7 @@ class RequestHelper {
   }
   
   func commonHeaders(httpMethod: HTTPMethod) -> [HTTPHeader] {
-    var commonHeaders = [userAgentHeader(), authorization.header()]
+    var commonHeaders = [userAgentHeader(), authorization.header(), HTTPHeader.acceptEncoding(ContentEncoding.accepted)]
     switch httpMethod {
       case .post,
            .put,
@@ -25,6 +25,7 @@ class URLRequestBuilder {
   private var parameters: [Parameter]
   private var headers: [HTTPHeader]
   private var url: String
+  private var encodedURL: URL?
   private var requestHelper: RequestHelper
   
   init(withURL url: String, requestHelper: RequestHelper) throws {
@@ -35,6 +36,12 @@ class URLRequestBuilder {
     headers = []
   }
   
+  /// Uses an already percent-encoded URL as is, e.g. one rendered from a `URLTemplate`.
+  convenience init(withURL url: URL, requestHelper: RequestHelper) throws {
+    try self.init(withURL: url.absoluteString, requestHelper: requestHelper)
+    encodedURL = url
+  }
+  
   func setHTTPMethod(_ method: HTTPMethod) -> URLRequestBuilder {
     httpMethod = method
     return self
@@ -51,8 +58,7 @@ class URLRequestBuilder {
   }
   
   func build() throws -> URLRequest {
-    guard let encodedUrl = url.addingPercentEncoding(withAllowedCharacters: .urlQueryAllowed),
-      let url = URL(string: encodedUrl) else {
+    guard let url = encodedURL ?? url.addingPercentEncoding(withAllowedCharacters: .urlQueryAllowed).flatMap({ URL(string: $0) }) else {
       throw NetworkError.invalidURL
     }
     var urlRequest = URLRequest(url: url)
@@ -65,7 +71,8 @@ class URLRequestBuilder {
     switch httpMethod {
       case .post, .put, .delete:
         do {
-          urlRequest.httpBody = try transformParameters(httpHeaders: urlRequest.allHTTPHeaderFields, params: params)
+          urlRequest.httpBody = try transformParameters(httpHeaders: httpHeaders, params: params)
+          try compressBodyIfNeeded(&urlRequest)
         } catch {
           Logger.shared.log(withLevel: .error, message: error.localizedDescription)
           throw(error)
@@ -86,10 +93,10 @@ private extension URLRequestBuilder {
     static let queryPrefix = "?"
   }
   
-  func transformParameters(httpHeaders: [String: String]?, params: Parameters) throws -> Data? {
+  func transformParameters(httpHeaders: HTTPHeaders, params: Parameters) throws -> Data? {
     do {
-      if let headers = httpHeaders, headers.contains(where: { $0.key == HTTPHeader.Constant.contentType && $0.value == MediaType.urlEncoded.value }) {
-        return params.asString().data(using: .utf8)
+      if httpHeaders.value(for: HTTPHeader.Constant.contentType) == MediaType.urlEncoded.value {
+        return params.asFormData()
       } else {
         return try params.asData()
       }
@@ -99,6 +106,17 @@ private extension URLRequestBuilder {
     }
   }
   
+  func compressBodyIfNeeded(_ urlRequest: inout URLRequest) throws {
+    guard let body = urlRequest.httpBody, requestHelper.compression.shouldCompress(body) else {
+      return
+    }
+    let header = HTTPHeader.contentEncoding(.gzip)
+    let compressed = try HTTPCompression.gzip(body)
+    urlRequest.httpBody = compressed
+    urlRequest.setValue(header.value, forHTTPHeaderField: header.key)
+    Logger.shared.log(withLevel: .networking, message: "Request body compressed from \(body.count) to \(compressed.count) bytes")
+  }
+  
   func addQueryParameters(params: Parameters) -> String {
     let parameters = params.asString()
     guard !parameters.isEmpty else {
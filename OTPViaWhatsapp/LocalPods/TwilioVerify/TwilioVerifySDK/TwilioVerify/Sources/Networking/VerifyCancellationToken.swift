@@ -0,0 +1,107 @@
+//
+//  VerifyCancellationToken.swift
+//  TwilioVerify
+//
+//  Copyright © 2020 Twilio.
+//
+//  Licensed under the Apache License, Version 2.0 (the "License");
+//  you may not use this file except in compliance with the License.
+//  You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+//
+
+import Foundation
+
+///Handle returned by operations that can be cancelled. Cancelling an operation aborts its in-flight
+///requests and skips any remaining stages, its success and failure closures are not called afterwards.
+public final class VerifyCancellationToken {
+  private let lock = NSLock()
+  private var state: State = .active
+  private var handlers: [() -> ()] = []
+  
+  /**
+   Creates a **VerifyCancellationToken**
+   - Parameters:
+     - onCancel: Closure to be called when the token is cancelled
+   */
+  public init(onCancel: @escaping () -> () = {}) {
+    handlers.append(onCancel)
+  }
+  
+  ///Indicates whether the operation was cancelled
+  public var isCancelled: Bool {
+    lock.lock()
+    defer { lock.unlock() }
+    return state == .cancelled
+  }
+  
+  ///Cancels the operation, it has no effect if the operation already finished or was cancelled
+  public func cancel() {
+    lock.lock()
+    guard state == .active else {
+      lock.unlock()
+      return
+    }
+    state = .cancelled
+    let handlers = self.handlers
+    self.handlers = []
+    lock.unlock()
+    handlers.forEach { $0() }
+  }
+}
+
+extension VerifyCancellationToken {
+  ///Registers a closure to be called on cancellation, it is called right away if the token is already cancelled
+  func onCancel(_ handler: @escaping () -> ()) {
+    lock.lock()
+    guard state == .active else {
+      let isCancelled = state == .cancelled
+      lock.unlock()
+      if isCancelled {
+        handler()
+      }
+      return
+    }
+    handlers.append(handler)
+    lock.unlock()
+  }
+  
+  ///Cancels the given token of a nested stage together with this one
+  func add(_ token: VerifyCancellationToken) {
+    onCancel(token.cancel)
+  }
+  
+  ///Marks the operation as finished, later cancellations have no effect.
+  ///Returns false if the operation was cancelled before, so the caller skips its last stage.
+  func finish() -> Bool {
+    lock.lock()
+    defer { lock.unlock() }
+    guard state == .active else {
+      return false
+    }
+    state = .finished
+    handlers = []
+    return true
+  }
+  
+  static var finished: VerifyCancellationToken {
+    let token = VerifyCancellationToken()
+    _ = token.finish()
+    return token
+  }
+}
+
+private extension VerifyCancellationToken {
+  enum State {
+    case active
+    case cancelled
+    case finished
+  }
+}
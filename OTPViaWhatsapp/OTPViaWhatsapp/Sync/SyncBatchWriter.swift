@@ -0,0 +1,167 @@
+//
+//  SyncBatchWriter.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// Bounds for one batch. Defaults follow the Sync service limits: 16 KB per item and a modest
+/// number of outstanding requests per connection.
+struct SyncBatchLimits {
+    var maxItemBytes = 16 * 1024
+    var maxChunkItems = 100
+    var maxChunkBytes = 256 * 1024
+    var maxInFlight = 32
+
+    static let `default` = SyncBatchLimits()
+}
+
+enum SyncBatchError: LocalizedError {
+    case invalidData(position: Int)
+    case itemTooLarge(position: Int, bytes: Int)
+
+    var errorDescription: String? {
+        switch self {
+        case .invalidData(let position):
+            return "Item \(position) is not JSON serializable"
+        case .itemTooLarge(let position, let bytes):
+            return "Item \(position) is \(bytes) bytes, above the Sync item size limit"
+        }
+    }
+}
+
+/// Writes many items into a Sync map or list with one call.
+///
+/// The public Sync SDK has no multi-item request, so the writer pipelines single-item writes over the
+/// client's one Twilsock connection instead of awaiting each round-trip. Items are split into chunks
+/// bounded by count and serialized size; inside a chunk up to `maxInFlight` writes are outstanding, and
+/// the next chunk starts once the previous one settled. Items above the size limit fail locally without
+/// a request. Results come back in input order, one per item.
+final class SyncBatchWriter {
+
+    private let limits: SyncBatchLimits
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.batch-writer")
+
+    init(limits: SyncBatchLimits = .default, callbackQueue: DispatchQueue = .main) {
+        self.limits = limits
+        self.callbackQueue = callbackQueue
+    }
+
+    func setItems(_ items: [(key: String, data: SyncData)], in map: SyncMapStore, ttl: TWSDuration? = nil,
+                  completion: @escaping ([Result<Void, Error>]) -> Void) {
+        let operations: [BatchOperation<Void>] = items.enumerated().map { position, item in
+            operation(position: position, data: item.data) { done in
+                map.setItem(withKey: item.key, data: item.data, ttl: ttl) { error in
+                    done(error.map { .failure($0) } ?? .success(()))
+                }
+            }
+        }
+        run(operations, completion: completion)
+    }
+
+    func removeItems(withKeys keys: [String], from map: SyncMapStore, completion: @escaping ([Result<Void, Error>]) -> Void) {
+        let operations = keys.map { key in
+            BatchOperation<Void>(bytes: key.utf8.count, failure: nil) { done in
+                map.removeItem(withKey: key) { error in
+                    done(error.map { .failure($0) } ?? .success(()))
+                }
+            }
+        }
+        run(operations, completion: completion)
+    }
+
+    func addItems(_ items: [SyncData], to list: SyncListStore, ttl: TWSDuration? = nil,
+                  completion: @escaping ([Result<TWSItemIndex, Error>]) -> Void) {
+        let operations: [BatchOperation<TWSItemIndex>] = items.enumerated().map { position, data in
+            operation(position: position, data: data) { done in
+                list.addItem(withData: data, ttl: ttl, completion: done)
+            }
+        }
+        run(operations, completion: completion)
+    }
+}
+
+private struct BatchOperation<Value> {
+    let bytes: Int
+    let failure: Error?
+    let start: (@escaping (Result<Value, Error>) -> Void) -> Void
+}
+
+private extension SyncBatchWriter {
+
+    func operation<Value>(position: Int, data: SyncData,
+                          start: @escaping (@escaping (Result<Value, Error>) -> Void) -> Void) -> BatchOperation<Value> {
+        guard JSONSerialization.isValidJSONObject(data),
+              let bytes = try? JSONSerialization.data(withJSONObject: data).count else {
+            return BatchOperation(bytes: 0, failure: SyncBatchError.invalidData(position: position), start: start)
+        }
+        guard bytes <= limits.maxItemBytes else {
+            return BatchOperation(bytes: bytes, failure: SyncBatchError.itemTooLarge(position: position, bytes: bytes), start: start)
+        }
+        return BatchOperation(bytes: bytes, failure: nil, start: start)
+    }
+
+    func chunks<Value>(of operations: [BatchOperation<Value>]) -> [Range<Int>] {
+        var chunks: [Range<Int>] = []
+        var lower = 0
+        var bytes = 0
+        for (position, operation) in operations.enumerated() {
+            let count = position - lower
+            if count > 0, count == limits.maxChunkItems || bytes + operation.bytes > limits.maxChunkBytes {
+                chunks.append(lower..<position)
+                lower = position
+                bytes = 0
+            }
+            bytes += operation.bytes
+        }
+        if lower < operations.count {
+            chunks.append(lower..<operations.count)
+        }
+        return chunks
+    }
+
+    func run<Value>(_ operations: [BatchOperation<Value>], completion: @escaping ([Result<Value, Error>]) -> Void) {
+        let ranges = chunks(of: operations)
+        let maxInFlight = max(limits.maxInFlight, 1)
+        var results = [Result<Value, Error>?](repeating: nil, count: operations.count)
+        var chunk = 0
+        var next = 0
+        var pending = 0
+
+        func finish() {
+            let ordered = results.map { $0 ?? .failure(SyncStoreError.unknown) }
+            callbackQueue.async { completion(ordered) }
+        }
+
+        func pump() {
+            while chunk < ranges.count {
+                let range = ranges[chunk]
+                while next < range.upperBound, pending < maxInFlight {
+                    let position = next
+                    next += 1
+                    if let failure = operations[position].failure {
+                        results[position] = .failure(failure)
+                        continue
+                    }
+                    pending += 1
+                    operations[position].start { [queue] result in
+                        queue.async {
+                            results[position] = result
+                            pending -= 1
+                            pump()
+                        }
+                    }
+                }
+                guard pending == 0, next == range.upperBound else {
+                    return
+                }
+                chunk += 1
+            }
+            finish()
+        }
+
+        queue.async { pump() }
+    }
+}
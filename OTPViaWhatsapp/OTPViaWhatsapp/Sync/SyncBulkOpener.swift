@@ -0,0 +1,148 @@
+//
+//  SyncBulkOpener.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// One entity to open with `SyncBulkOpener`, with the delegate it is opened with.
+enum SyncOpenRequest {
+    case document(TWSOpenOptions, delegate: TWSDocumentDelegate)
+    case list(TWSOpenOptions, delegate: TWSListDelegate)
+    case map(TWSOpenOptions, delegate: TWSMapDelegate)
+    case stream(TWSOpenOptions, delegate: TWSStreamDelegate)
+}
+
+enum SyncOpenedEntity {
+    case document(TWSDocument)
+    case list(TWSList)
+    case map(TWSMap)
+    case stream(TWSStream)
+}
+
+/// Opens many Sync entities with one call.
+///
+/// The client has one open call per entity and no public way to register several subscriptions in one
+/// request, so launch code that opens entities one after another pays a full handshake round-trip each.
+/// The bulk opener issues the opens concurrently instead, at most `maxConcurrentOpens` at a time, and
+/// reports every entity through `onOpen` as soon as it is ready. The completion gets all results in
+/// request order.
+final class SyncBulkOpener<Request, Entity> {
+
+    typealias Open = (Request, @escaping (Result<Entity, Error>) -> Void) -> Void
+
+    struct Options {
+        var maxConcurrentOpens = 32
+
+        static var `default`: Options {
+            Options()
+        }
+    }
+
+    private let options: Options
+    private let callbackQueue: DispatchQueue
+    private let openEntity: Open
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.bulk-opener")
+
+    init(options: Options = .default, callbackQueue: DispatchQueue = .main, open: @escaping Open) {
+        self.options = options
+        self.callbackQueue = callbackQueue
+        openEntity = open
+    }
+
+    /// Opens every request, calling `onOpen` with its position as each one settles.
+    func open(_ requests: [Request], onOpen: ((Int, Result<Entity, Error>) -> Void)? = nil,
+              completion: @escaping ([Result<Entity, Error>]) -> Void) {
+        queue.async {
+            let batch = Batch(requests: requests, onOpen: onOpen, completion: completion)
+            guard !requests.isEmpty else {
+                return self.callbackQueue.async { completion([]) }
+            }
+            for _ in 0..<min(self.options.maxConcurrentOpens, requests.count) {
+                self.openNext(in: batch)
+            }
+        }
+    }
+}
+
+extension SyncBulkOpener where Request == SyncOpenRequest, Entity == SyncOpenedEntity {
+    convenience init(client: TwilioSyncClient, options: Options = .default, callbackQueue: DispatchQueue = .main) {
+        self.init(options: options, callbackQueue: callbackQueue) { [weak client] request, completion in
+            guard let client = client else {
+                return completion(.failure(SyncStoreError.unknown))
+            }
+            client.open(request, completion: completion)
+        }
+    }
+}
+
+private extension SyncBulkOpener {
+
+    final class Batch {
+        let requests: [Request]
+        let onOpen: ((Int, Result<Entity, Error>) -> Void)?
+        let completion: ([Result<Entity, Error>]) -> Void
+        var results: [Result<Entity, Error>?]
+        var next = 0
+        var settled = 0
+
+        init(requests: [Request], onOpen: ((Int, Result<Entity, Error>) -> Void)?, completion: @escaping ([Result<Entity, Error>]) -> Void) {
+            self.requests = requests
+            self.onOpen = onOpen
+            self.completion = completion
+            results = Array(repeating: nil, count: requests.count)
+        }
+    }
+
+    /// Starts the next unopened request of `batch`. Called on `queue`.
+    func openNext(in batch: Batch) {
+        guard batch.next < batch.requests.count else {
+            return
+        }
+        let position = batch.next
+        batch.next += 1
+        openEntity(batch.requests[position]) { result in
+            self.queue.async {
+                batch.results[position] = result
+                batch.settled += 1
+                let onOpen = batch.onOpen
+                self.callbackQueue.async {
+                    onOpen?(position, result)
+                }
+                if batch.settled == batch.requests.count {
+                    let results = batch.results.compactMap { $0 }
+                    self.callbackQueue.async {
+                        batch.completion(results)
+                    }
+                } else {
+                    self.openNext(in: batch)
+                }
+            }
+        }
+    }
+}
+
+extension TwilioSyncClient {
+    func open(_ request: SyncOpenRequest, completion: @escaping (Result<SyncOpenedEntity, Error>) -> Void) {
+        func finish<T>(_ result: TWSResult, _ entity: T?, _ wrap: (T) -> SyncOpenedEntity) {
+            if let error = result.failure {
+                completion(.failure(error))
+            } else if let entity = entity {
+                completion(.success(wrap(entity)))
+            } else {
+                completion(.failure(SyncStoreError.missingItem))
+            }
+        }
+        switch request {
+        case let .document(options, delegate):
+            openDocument(with: options, delegate: delegate) { finish($0, $1, SyncOpenedEntity.document) }
+        case let .list(options, delegate):
+            openList(with: options, delegate: delegate) { finish($0, $1, SyncOpenedEntity.list) }
+        case let .map(options, delegate):
+            openMap(with: options, delegate: delegate) { finish($0, $1, SyncOpenedEntity.map) }
+        case let .stream(options, delegate):
+            openStream(with: options, delegate: delegate) { finish($0, $1, SyncOpenedEntity.stream) }
+        }
+    }
+}
@@ -0,0 +1,381 @@
+//
+//  SyncCache.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+
+/// On-disk cache of Sync map and list contents, so a cold start can show items before the client reconnects.
+///
+/// Each entity is one file of length-prefixed records: key, `dateUpdated` and the JSON payload. Files are
+/// memory-mapped on load and item payloads are decoded only when read, so time-to-first-item does not grow
+/// with the size of the map. `dateUpdated` stands in for the item revision, which the public SDK does not
+/// expose; `reconcile` compares it against a fresh query, or compares payloads for items without one, and
+/// rewrites the file in the background. List items are cached under their index. Documents are not
+/// reconciled, since `SyncDocumentStore` has no plain read; store one as a single item to cache it.
+final class SyncCache {
+
+    private let directory: URL
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.cache", qos: .utility)
+
+    init(directory: URL, callbackQueue: DispatchQueue = .main) {
+        self.directory = directory
+        self.callbackQueue = callbackQueue
+    }
+
+    static func makeDefault() throws -> SyncCache {
+        let caches = try FileManager.default.url(for: .cachesDirectory, in: .userDomainMask, appropriateFor: nil, create: true)
+        return SyncCache(directory: caches.appendingPathComponent(Constants.directoryName, isDirectory: true))
+    }
+
+    /// Maps the cached file of `entity`, or returns nil when there is none or it is corrupt, in which case it is
+    /// removed. A file that exists but cannot be read right now, e.g. one protected before first unlock, is
+    /// left alone and the read error is thrown.
+    func snapshot(forEntity entity: String) throws -> SyncCacheSnapshot? {
+        let url = fileURL(forEntity: entity)
+        guard let data = try Data(contentsOfIfPresent: url) else {
+            return nil
+        }
+        guard let snapshot = SyncCacheSnapshot(entity: entity, storage: data) else {
+            try? FileManager.default.removeItem(at: url)
+            return nil
+        }
+        return snapshot
+    }
+
+    func store(_ items: [SyncItem], forEntity entity: String) throws {
+        try FileManager.default.createDirectory(at: directory, withIntermediateDirectories: true)
+        try SyncCacheSnapshot.encode(items).write(to: fileURL(forEntity: entity), options: .atomic)
+    }
+
+    func removeSnapshot(forEntity entity: String) {
+        try? FileManager.default.removeItem(at: fileURL(forEntity: entity))
+    }
+
+    /// Queries every item of `map` in the background, rewrites the cached file of `entity` and reports what
+    /// changed relative to the previous snapshot. Completes on `callbackQueue`.
+    func reconcile(_ map: SyncMapStore, entity: String, pageSize: Int = Constants.pageSize,
+                   completion: @escaping (Result<SyncCacheChanges, Error>) -> Void) {
+        var items: [SyncItem] = []
+
+        func collect(_ result: Result<SyncMapPage, Error>) {
+            switch result {
+            case .failure(let error):
+                finish(.failure(error), completion: completion)
+            case .success(let page):
+                items.append(contentsOf: page.items)
+                guard !page.hasNextPage else {
+                    return page.nextPage(completion: collect)
+                }
+                rewrite(entity: entity, with: items, completion: completion)
+            }
+        }
+
+        map.queryItems(startingAt: nil, pageSize: pageSize, completion: collect)
+    }
+
+    /// Same as for a map, with each list item keyed by its index.
+    func reconcile(_ list: SyncListStore, entity: String, pageSize: Int = Constants.pageSize,
+                   completion: @escaping (Result<SyncCacheChanges, Error>) -> Void) {
+        var items: [SyncItem] = []
+
+        func collect(_ result: Result<SyncListPage, Error>) {
+            switch result {
+            case .failure(let error):
+                finish(.failure(error), completion: completion)
+            case .success(let page):
+                items += page.items.map { SyncItem(key: String($0.index), data: $0.data, dateUpdated: $0.dateUpdated) }
+                guard !page.hasNextPage else {
+                    return page.nextPage(completion: collect)
+                }
+                rewrite(entity: entity, with: items, completion: completion)
+            }
+        }
+
+        list.queryItems(startingAt: nil, pageSize: pageSize, completion: collect)
+    }
+}
+
+/// Difference between a cached snapshot and the server state, keyed by item key.
+struct SyncCacheChanges {
+    var added: [SyncItem] = []
+    var updated: [SyncItem] = []
+    var removed: [String] = []
+
+    var isEmpty: Bool {
+        added.isEmpty && updated.isEmpty && removed.isEmpty
+    }
+
+    /// Items count as updated when `dateUpdated` moved, or, when either side has none, when the payload differs.
+    init(from snapshot: SyncCacheSnapshot?, to items: [SyncItem]) {
+        var cached = snapshot?.revisions() ?? [:]
+        for item in items {
+            guard let revision = cached.removeValue(forKey: item.key) else {
+                added.append(item)
+                continue
+            }
+            if let revision = revision, let dateUpdated = item.dateUpdated {
+                if revision != dateUpdated {
+                    updated.append(item)
+                }
+            } else if snapshot?.payload(forKey: item.key) != (try? SyncCacheSnapshot.payload(of: item)) {
+                updated.append(item)
+            }
+        }
+        removed = Array(cached.keys)
+    }
+}
+
+/// Read-only view over one mapped cache file.
+final class SyncCacheSnapshot {
+
+    let entity: String
+    let count: Int
+    private let storage: Data
+    private let lock = NSLock()
+    private var index: [String: Int]?
+
+    /// Fails for a foreign file and for one whose length differs from the length written in its header, so
+    /// a truncated or extended file is discarded before any record is read.
+    init?(entity: String, storage: Data) {
+        var reader = RecordReader(storage)
+        guard reader.readBytes(Constants.magic.count).map({ [UInt8]($0) }) == Constants.magic,
+              let count = reader.readUInt32(),
+              let length = reader.readUInt64(), length == storage.count else {
+            return nil
+        }
+        self.entity = entity
+        self.count = Int(count)
+        self.storage = storage
+    }
+
+    var first: SyncItem? {
+        var reader = records()
+        return count > 0 ? reader.readItem() : nil
+    }
+
+    func item(forKey key: String) -> SyncItem? {
+        guard let offset = offsets[key] else {
+            return nil
+        }
+        var reader = RecordReader(storage, offset: offset)
+        return reader.readItem()
+    }
+
+    /// JSON payload of `key` as a slice of the mapped file, without copying or decoding it.
+    func payload(forKey key: String) -> Data? {
+        guard let offset = offsets[key] else {
+            return nil
+        }
+        var reader = RecordReader(storage, offset: offset)
+        return reader.readRecord()?.payload
+    }
+
+    /// Walks raw payloads in file order, stopping early when `body` returns false.
+    func forEachPayload(_ body: (String, Data) -> Bool) {
+        var reader = records()
+        for _ in 0..<count {
+            guard let (key, _, payload) = reader.readRecord(), body(key, payload) else {
+                return
+            }
+        }
+    }
+
+    /// Decodes items one at a time, stopping early when `body` returns false.
+    func forEach(_ body: (SyncItem) -> Bool) {
+        var reader = records()
+        for _ in 0..<count {
+            guard let item = reader.readItem(), body(item) else {
+                return
+            }
+        }
+    }
+
+    /// Keys and `dateUpdated` of every record, read without decoding payloads.
+    func revisions() -> [String: Date?] {
+        var revisions = [String: Date?](minimumCapacity: count)
+        var reader = records()
+        for _ in 0..<count {
+            guard let (key, dateUpdated, _) = reader.readRecord() else {
+                break
+            }
+            revisions[key] = .some(dateUpdated)
+        }
+        return revisions
+    }
+
+    static func encode(_ items: [SyncItem]) throws -> Data {
+        var data = Data(Constants.magic)
+        data.append(uint32: UInt32(items.count))
+        data.append(uint64: 0)
+        for item in items {
+            let key = Data(item.key.utf8)
+            let payload = try self.payload(of: item)
+            data.append(uint32: UInt32(key.count))
+            data.append(key)
+            data.append(uint64: (item.dateUpdated?.timeIntervalSince1970 ?? .nan).bitPattern)
+            data.append(uint32: UInt32(payload.count))
+            data.append(payload)
+        }
+        var length = Data()
+        length.append(uint64: UInt64(data.count))
+        data.replaceSubrange(Constants.magic.count + 4..<Constants.headerSize, with: length)
+        return data
+    }
+
+    /// JSON payload as stored, with sorted keys so equal data always encodes to equal bytes.
+    static func payload(of item: SyncItem) throws -> Data {
+        try JSONSerialization.data(withJSONObject: item.data, options: .sortedKeys)
+    }
+}
+
+private extension SyncCacheSnapshot {
+
+    func records() -> RecordReader {
+        RecordReader(storage, offset: Constants.headerSize)
+    }
+
+    /// Offset of every record by key. Built on the first keyed read rather than in `init`, so serving the first
+    /// item stays independent of the file size; the lock makes that safe for readers on any thread.
+    var offsets: [String: Int] {
+        lock.lock()
+        defer { lock.unlock() }
+        if let index = index {
+            return index
+        }
+        let offsets = indexRecords()
+        index = offsets
+        return offsets
+    }
+
+    func indexRecords() -> [String: Int] {
+        var offsets = [String: Int](minimumCapacity: count)
+        var reader = records()
+        for _ in 0..<count {
+            let offset = reader.offset
+            guard let (key, _, _) = reader.readRecord() else {
+                break
+            }
+            offsets[key] = offset
+        }
+        return offsets
+    }
+}
+
+/// Sequential little-endian reader over the mapped file. Every read is bounds checked, so a truncated
+/// file yields nil instead of trapping.
+private struct RecordReader {
+
+    let storage: Data
+    private(set) var offset: Int
+
+    init(_ storage: Data, offset: Int = 0) {
+        self.storage = storage
+        self.offset = offset
+    }
+
+    mutating func readBytes(_ count: Int) -> Data? {
+        let start = storage.startIndex + offset
+        guard count >= 0, storage.endIndex - start >= count else {
+            return nil
+        }
+        offset += count
+        return storage[start..<start + count]
+    }
+
+    mutating func readUInt32() -> UInt32? {
+        readBytes(4).map { bytes in bytes.reversed().reduce(0) { $0 << 8 | UInt32($1) } }
+    }
+
+    mutating func readUInt64() -> UInt64? {
+        readBytes(8).map { bytes in bytes.reversed().reduce(0) { $0 << 8 | UInt64($1) } }
+    }
+
+    mutating func readRecord() -> (key: String, dateUpdated: Date?, payload: Data)? {
+        guard let keyLength = readUInt32(),
+              let key = readBytes(Int(keyLength)).flatMap({ String(data: $0, encoding: .utf8) }),
+              let bits = readUInt64(),
+              let payloadLength = readUInt32(),
+              let payload = readBytes(Int(payloadLength)) else {
+            return nil
+        }
+        let interval = Double(bitPattern: bits)
+        return (key, interval.isNaN ? nil : Date(timeIntervalSince1970: interval), payload)
+    }
+
+    mutating func readItem() -> SyncItem? {
+        guard let (key, dateUpdated, payload) = readRecord(),
+              let data = (try? JSONSerialization.jsonObject(with: payload)) as? SyncData else {
+            return nil
+        }
+        return SyncItem(key: key, data: data, dateUpdated: dateUpdated)
+    }
+}
+
+/// Readers and little-endian writers for the on-disk Sync formats.
+extension Data {
+    /// Maps the file at `url`, or is nil when there is none. Any other failure is thrown, so a file that cannot
+    /// be read right now, e.g. one protected before first unlock, is never mistaken for a missing one.
+    init?(contentsOfIfPresent url: URL) throws {
+        do {
+            self = try Data(contentsOf: url, options: .alwaysMapped)
+        } catch CocoaError.fileReadNoSuchFile {
+            return nil
+        } catch let error as NSError where error.domain == NSPOSIXErrorDomain && error.code == Int(ENOENT) {
+            return nil
+        }
+    }
+
+    mutating func append(uint32 value: UInt32) {
+        Swift.withUnsafeBytes(of: value.littleEndian) { append(contentsOf: $0) }
+    }
+
+    mutating func append(uint64 value: UInt64) {
+        Swift.withUnsafeBytes(of: value.littleEndian) { append(contentsOf: $0) }
+    }
+}
+
+extension SyncCache {
+    struct Constants {
+        static let directoryName = "SyncCache"
+        static let pageSize = 100
+    }
+}
+
+private extension SyncCacheSnapshot {
+    struct Constants {
+        static let magic: [UInt8] = Array("SYC2".utf8)
+        /// Magic, record count and file length.
+        static let headerSize = 16
+    }
+}
+
+private extension SyncCache {
+    /// Diffs `items` against the snapshot of `entity` and rewrites it when they differ, off the caller's queue.
+    func rewrite(entity: String, with items: [SyncItem], completion: @escaping (Result<SyncCacheChanges, Error>) -> Void) {
+        queue.async { [weak self] in
+            guard let strongSelf = self else {
+                return
+            }
+            strongSelf.finish(Result {
+                let changes = try SyncCacheChanges(from: strongSelf.snapshot(forEntity: entity), to: items)
+                if !changes.isEmpty {
+                    try strongSelf.store(items, forEntity: entity)
+                }
+                return changes
+            }, completion: completion)
+        }
+    }
+
+    func finish(_ result: Result<SyncCacheChanges, Error>, completion: @escaping (Result<SyncCacheChanges, Error>) -> Void) {
+        callbackQueue.async {
+            completion(result)
+        }
+    }
+
+    func fileURL(forEntity entity: String) -> URL {
+        let name = entity.addingPercentEncoding(withAllowedCharacters: .alphanumerics) ?? entity
+        return directory.appendingPathComponent(name).appendingPathExtension("sync")
+    }
+}
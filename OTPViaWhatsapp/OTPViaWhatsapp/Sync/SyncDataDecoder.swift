@@ -0,0 +1,301 @@
+//
+//  SyncDataDecoder.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+
+/// Decodes `Decodable` values straight from the Foundation objects Sync hands out as `TWSData`.
+///
+/// The usual route, `JSONSerialization.data(withJSONObject:)` followed by `JSONDecoder`, serializes every
+/// item back to JSON text only to parse it again. This decoder walks the `NSDictionary`/`NSArray`/`NSNumber`
+/// graph in place instead. It follows `JSONDecoder`'s rules, so a payload decodes the same whether it is
+/// read here or from bytes: numbers must fit the requested type exactly, booleans are only `true`/`false`,
+/// `Data` is base64 and `Decimal` a number. Dates are read from numbers as seconds since 1970 or from
+/// ISO 8601 strings; `dateDecodingStrategy` gives a `JSONDecoder` the same rule.
+struct SyncDataDecoder {
+
+    static let dateDecodingStrategy = JSONDecoder.DateDecodingStrategy.custom { decoder in
+        let container = try decoder.singleValueContainer()
+        if let string = try? container.decode(String.self) {
+            return try SyncDataDecoder.date(fromISO8601: string, codingPath: decoder.codingPath)
+        }
+        return Date(timeIntervalSince1970: try container.decode(Double.self))
+    }
+
+    static func date(fromISO8601 string: String, codingPath: [CodingKey]) throws -> Date {
+        guard let date = dateFormatter.date(from: string) else {
+            throw DecodingError.dataCorrupted(.init(codingPath: codingPath, debugDescription: "Invalid ISO 8601 date"))
+        }
+        return date
+    }
+
+    private static let dateFormatter = ISO8601DateFormatter()
+
+    func decode<T: Decodable>(_ type: T.Type, from data: SyncData) throws -> T {
+        try decode(type, fromObject: data as NSDictionary)
+    }
+
+    func decode<T: Decodable>(_ type: T.Type, fromObject object: Any) throws -> T {
+        try ObjectDecoder(object: object, codingPath: []).decode(type)
+    }
+}
+
+private struct ObjectDecoder: Decoder {
+    let object: Any
+    let codingPath: [CodingKey]
+
+    var userInfo: [CodingUserInfoKey: Any] {
+        [:]
+    }
+
+    func container<Key: CodingKey>(keyedBy type: Key.Type) throws -> KeyedDecodingContainer<Key> {
+        guard let dictionary = object as? NSDictionary else {
+            throw mismatch(NSDictionary.self)
+        }
+        return KeyedDecodingContainer(KeyedContainer<Key>(dictionary: dictionary, codingPath: codingPath))
+    }
+
+    func unkeyedContainer() throws -> UnkeyedDecodingContainer {
+        guard let array = object as? NSArray else {
+            throw mismatch(NSArray.self)
+        }
+        return UnkeyedContainer(array: array, codingPath: codingPath)
+    }
+
+    func singleValueContainer() throws -> SingleValueDecodingContainer {
+        self
+    }
+
+    func mismatch(_ type: Any.Type) -> DecodingError {
+        DecodingError.typeMismatch(type, .init(codingPath: codingPath, debugDescription: "Found \(Swift.type(of: object)) instead"))
+    }
+
+    func corrupted(_ description: String) -> DecodingError {
+        DecodingError.dataCorrupted(.init(codingPath: codingPath, debugDescription: description))
+    }
+
+    /// The value as a number for `type`; booleans are not numbers, as in `JSONDecoder`.
+    func number(_ type: Any.Type) throws -> NSNumber {
+        guard let number = object as? NSNumber, !number.isBoolean else {
+            throw mismatch(type)
+        }
+        return number
+    }
+
+    func integer<T: FixedWidthInteger>(_ type: T.Type) throws -> T {
+        let number = try self.number(type)
+        let value: T?
+        switch UInt8(bitPattern: number.objCType.pointee) {
+        case UInt8(ascii: "d"), UInt8(ascii: "f"):
+            value = T(exactly: number.doubleValue)
+        case UInt8(ascii: "Q"):
+            value = T(exactly: number.uint64Value)
+        default:
+            value = T(exactly: number.int64Value)
+        }
+        guard let exact = value else {
+            throw corrupted("Number \(number) does not fit in \(type)")
+        }
+        return exact
+    }
+}
+
+extension ObjectDecoder: SingleValueDecodingContainer {
+    func decodeNil() -> Bool {
+        object is NSNull
+    }
+
+    func decode(_ type: Bool.Type) throws -> Bool {
+        guard let number = object as? NSNumber, number.isBoolean else {
+            throw mismatch(type)
+        }
+        return number.boolValue
+    }
+
+    func decode(_ type: String.Type) throws -> String {
+        guard let string = object as? String else {
+            throw mismatch(type)
+        }
+        return string
+    }
+
+    func decode(_ type: Double.Type) throws -> Double { try number(type).doubleValue }
+    func decode(_ type: Int.Type) throws -> Int { try integer(type) }
+    func decode(_ type: Int8.Type) throws -> Int8 { try integer(type) }
+    func decode(_ type: Int16.Type) throws -> Int16 { try integer(type) }
+    func decode(_ type: Int32.Type) throws -> Int32 { try integer(type) }
+    func decode(_ type: Int64.Type) throws -> Int64 { try integer(type) }
+    func decode(_ type: UInt.Type) throws -> UInt { try integer(type) }
+    func decode(_ type: UInt8.Type) throws -> UInt8 { try integer(type) }
+    func decode(_ type: UInt16.Type) throws -> UInt16 { try integer(type) }
+    func decode(_ type: UInt32.Type) throws -> UInt32 { try integer(type) }
+    func decode(_ type: UInt64.Type) throws -> UInt64 { try integer(type) }
+
+    func decode(_ type: Float.Type) throws -> Float {
+        let value = try number(type).doubleValue
+        guard !value.isFinite || abs(value) <= Double(Float.greatestFiniteMagnitude) else {
+            throw corrupted("Number \(value) does not fit in Float")
+        }
+        return Float(value)
+    }
+
+    func decode<T: Decodable>(_ type: T.Type) throws -> T {
+        if type == Date.self {
+            return try decodeDate() as! T // swiftlint:disable:this force_cast
+        }
+        if type == Data.self {
+            guard let data = Data(base64Encoded: try decode(String.self)) else {
+                throw corrupted("Invalid base64 data")
+            }
+            return data as! T // swiftlint:disable:this force_cast
+        }
+        if type == Decimal.self {
+            return try number(type).decimalValue as! T // swiftlint:disable:this force_cast
+        }
+        if type == URL.self {
+            guard let url = URL(string: try decode(String.self)) else {
+                throw corrupted("Invalid URL")
+            }
+            return url as! T // swiftlint:disable:this force_cast
+        }
+        return try T(from: self)
+    }
+
+    private func decodeDate() throws -> Date {
+        if let string = object as? String {
+            return try SyncDataDecoder.date(fromISO8601: string, codingPath: codingPath)
+        }
+        return Date(timeIntervalSince1970: try number(Date.self).doubleValue)
+    }
+}
+
+private extension NSNumber {
+    /// True for the `true`/`false` singletons JSON booleans are parsed into, false for `0` and `1`.
+    var isBoolean: Bool {
+        CFGetTypeID(self) == CFBooleanGetTypeID()
+    }
+}
+
+private struct KeyedContainer<Key: CodingKey>: KeyedDecodingContainerProtocol {
+    let dictionary: NSDictionary
+    let codingPath: [CodingKey]
+
+    var allKeys: [Key] {
+        dictionary.allKeys.compactMap { ($0 as? String).flatMap(Key.init(stringValue:)) }
+    }
+
+    func contains(_ key: Key) -> Bool {
+        dictionary.object(forKey: key.stringValue) != nil
+    }
+
+    func decodeNil(forKey key: Key) throws -> Bool {
+        try object(forKey: key) is NSNull
+    }
+
+    func decode<T: Decodable>(_ type: T.Type, forKey key: Key) throws -> T {
+        try decoder(forKey: key).decode(type)
+    }
+
+    func decodeIfPresent<T: Decodable>(_ type: T.Type, forKey key: Key) throws -> T? {
+        guard let object = dictionary.object(forKey: key.stringValue), !(object is NSNull) else {
+            return nil
+        }
+        return try ObjectDecoder(object: object, codingPath: codingPath + [key]).decode(type)
+    }
+
+    func nestedContainer<NestedKey: CodingKey>(keyedBy type: NestedKey.Type, forKey key: Key) throws -> KeyedDecodingContainer<NestedKey> {
+        try decoder(forKey: key).container(keyedBy: type)
+    }
+
+    func nestedUnkeyedContainer(forKey key: Key) throws -> UnkeyedDecodingContainer {
+        try decoder(forKey: key).unkeyedContainer()
+    }
+
+    func superDecoder() throws -> Decoder {
+        ObjectDecoder(object: dictionary, codingPath: codingPath)
+    }
+
+    func superDecoder(forKey key: Key) throws -> Decoder {
+        try decoder(forKey: key)
+    }
+
+    private func object(forKey key: Key) throws -> Any {
+        guard let object = dictionary.object(forKey: key.stringValue) else {
+            throw DecodingError.keyNotFound(key, .init(codingPath: codingPath, debugDescription: "No value for \(key.stringValue)"))
+        }
+        return object
+    }
+
+    private func decoder(forKey key: Key) throws -> ObjectDecoder {
+        ObjectDecoder(object: try object(forKey: key), codingPath: codingPath + [key])
+    }
+}
+
+private struct UnkeyedContainer: UnkeyedDecodingContainer {
+    let array: NSArray
+    let codingPath: [CodingKey]
+    private(set) var currentIndex = 0
+
+    init(array: NSArray, codingPath: [CodingKey]) {
+        self.array = array
+        self.codingPath = codingPath
+    }
+
+    var count: Int? {
+        array.count
+    }
+
+    var isAtEnd: Bool {
+        currentIndex >= array.count
+    }
+
+    mutating func decodeNil() throws -> Bool {
+        guard try next(peek: true).object is NSNull else {
+            return false
+        }
+        currentIndex += 1
+        return true
+    }
+
+    mutating func decode<T: Decodable>(_ type: T.Type) throws -> T {
+        try next().decode(type)
+    }
+
+    mutating func nestedContainer<NestedKey: CodingKey>(keyedBy type: NestedKey.Type) throws -> KeyedDecodingContainer<NestedKey> {
+        try next().container(keyedBy: type)
+    }
+
+    mutating func nestedUnkeyedContainer() throws -> UnkeyedDecodingContainer {
+        try next().unkeyedContainer()
+    }
+
+    mutating func superDecoder() throws -> Decoder {
+        try next()
+    }
+
+    private mutating func next(peek: Bool = false) throws -> ObjectDecoder {
+        guard !isAtEnd else {
+            throw DecodingError.valueNotFound(Any.self, .init(codingPath: codingPath, debugDescription: "Unkeyed container is at end"))
+        }
+        let decoder = ObjectDecoder(object: array[currentIndex], codingPath: codingPath + [IndexKey(intValue: currentIndex)])
+        if !peek {
+            currentIndex += 1
+        }
+        return decoder
+    }
+}
+
+private struct IndexKey: CodingKey {
+    let intValue: Int?
+    let stringValue: String
+
+    init(intValue: Int) {
+        self.intValue = intValue
+        stringValue = String(intValue)
+    }
+
+    init?(stringValue: String) {
+        return nil
+    }
+}
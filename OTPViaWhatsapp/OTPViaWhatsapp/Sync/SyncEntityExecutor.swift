@@ -0,0 +1,223 @@
+//
+//  SyncEntityExecutor.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// Per-entity serial queues on one shared pool for Sync event handling.
+///
+/// `TwilioSyncClient.dispatchQueue` is a single queue for every entity, so one slow map handler holds up
+/// the events of all other entities behind it. Point the client at a background serial queue and open
+/// entities with the delegate wrappers below: each entity then gets its own serial queue targeting a
+/// shared concurrent pool. Events of one entity keep their order, a slow handler occupies one pool thread
+/// only, and idle threads pick up whichever entity has work. An entity can also be pinned to a queue of
+/// its own, such as main for one driving the UI.
+///
+/// Only delegate events move. Completion blocks of entity operations, e.g. `setItem` or `publishMessage`,
+/// still run on the client's `dispatchQueue`; hop to `queue(forEntity:)` from them when they touch state
+/// the entity's handlers own.
+final class SyncEntityExecutor {
+
+    private let pool: DispatchQueue
+    private let lock = NSLock()
+    private var queues: [String: DispatchQueue] = [:]
+
+    init(qos: DispatchQoS = .userInitiated) {
+        pool = DispatchQueue(label: "com.otpviawhatsapp.sync.entity-executor", qos: qos, attributes: .concurrent)
+    }
+
+    /// The serial queue events of `entity` run on, created on first use.
+    func queue(forEntity entity: String) -> DispatchQueue {
+        lock.lock()
+        defer { lock.unlock() }
+        if let queue = queues[entity] {
+            return queue
+        }
+        let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.entity-executor.\(entity)", target: pool)
+        queues[entity] = queue
+        return queue
+    }
+
+    /// Runs the events of `entity` on `queue`, which must be serial to keep them in order.
+    func setQueue(_ queue: DispatchQueue, forEntity entity: String) {
+        lock.lock()
+        queues[entity] = queue
+        lock.unlock()
+    }
+
+    func removeQueue(forEntity entity: String) {
+        lock.lock()
+        queues[entity] = nil
+        lock.unlock()
+    }
+
+    func async(entity: String, execute work: @escaping () -> Void) {
+        queue(forEntity: entity).async(execute: work)
+    }
+}
+
+/// Forwards map events to `delegate` on the map's executor queue. Keep it alive while the map is open.
+final class SyncExecutingMapDelegate: NSObject, TWSMapDelegate {
+    private weak var delegate: TWSMapDelegate?
+    private let executor: SyncEntityExecutor
+
+    init(delegate: TWSMapDelegate, executor: SyncEntityExecutor) {
+        self.delegate = delegate
+        self.executor = executor
+    }
+
+    func onMapOpened(_ map: TWSMap) {
+        executor.async(entity: map.sid) { [weak delegate] in
+            delegate?.onMapOpened?(map)
+        }
+    }
+
+    func onMap(_ map: TWSMap, itemAdded item: TWSMapItem, eventContext: TWSEventContext) {
+        executor.async(entity: map.sid) { [weak delegate] in
+            delegate?.onMap?(map, itemAdded: item, eventContext: eventContext)
+        }
+    }
+
+    func onMap(_ map: TWSMap, itemUpdated item: TWSMapItem, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        executor.async(entity: map.sid) { [weak delegate] in
+            delegate?.onMap?(map, itemUpdated: item, previousItemData: previousItemData, eventContext: eventContext)
+        }
+    }
+
+    func onMap(_ map: TWSMap, itemRemovedWithKey itemKey: String, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        executor.async(entity: map.sid) { [weak delegate] in
+            delegate?.onMap?(map, itemRemovedWithKey: itemKey, previousItemData: previousItemData, eventContext: eventContext)
+        }
+    }
+
+    func onMapCollectionRemoved(_ map: TWSMap, eventContext: TWSEventContext) {
+        executor.async(entity: map.sid) { [weak delegate] in
+            delegate?.onMapCollectionRemoved?(map, eventContext: eventContext)
+        }
+    }
+
+    func onMap(_ map: TWSMap, errorOccurred error: TWSError) {
+        executor.async(entity: map.sid) { [weak delegate] in
+            delegate?.onMap?(map, errorOccurred: error)
+        }
+    }
+}
+
+/// Forwards list events to `delegate` on the list's executor queue. Keep it alive while the list is open.
+final class SyncExecutingListDelegate: NSObject, TWSListDelegate {
+    private weak var delegate: TWSListDelegate?
+    private let executor: SyncEntityExecutor
+
+    init(delegate: TWSListDelegate, executor: SyncEntityExecutor) {
+        self.delegate = delegate
+        self.executor = executor
+    }
+
+    func onListOpened(_ list: TWSList) {
+        executor.async(entity: list.sid) { [weak delegate] in
+            delegate?.onListOpened?(list)
+        }
+    }
+
+    func onList(_ list: TWSList, itemAdded item: TWSListItem, eventContext: TWSEventContext) {
+        executor.async(entity: list.sid) { [weak delegate] in
+            delegate?.onList?(list, itemAdded: item, eventContext: eventContext)
+        }
+    }
+
+    func onList(_ list: TWSList, itemUpdated item: TWSListItem, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        executor.async(entity: list.sid) { [weak delegate] in
+            delegate?.onList?(list, itemUpdated: item, previousItemData: previousItemData, eventContext: eventContext)
+        }
+    }
+
+    func onList(_ list: TWSList, itemRemovedWithIndex itemIndex: TWSItemIndex, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        executor.async(entity: list.sid) { [weak delegate] in
+            delegate?.onList?(list, itemRemovedWithIndex: itemIndex, previousItemData: previousItemData, eventContext: eventContext)
+        }
+    }
+
+    func onList(_ list: TWSList, collectionRemovedWith eventContext: TWSEventContext) {
+        executor.async(entity: list.sid) { [weak delegate] in
+            delegate?.onList?(list, collectionRemovedWith: eventContext)
+        }
+    }
+
+    func onList(_ list: TWSList, errorOccurred error: TWSError) {
+        executor.async(entity: list.sid) { [weak delegate] in
+            delegate?.onList?(list, errorOccurred: error)
+        }
+    }
+}
+
+/// Forwards document events to `delegate` on the document's executor queue. Keep it alive while the document is open.
+final class SyncExecutingDocumentDelegate: NSObject, TWSDocumentDelegate {
+    private weak var delegate: TWSDocumentDelegate?
+    private let executor: SyncEntityExecutor
+
+    init(delegate: TWSDocumentDelegate, executor: SyncEntityExecutor) {
+        self.delegate = delegate
+        self.executor = executor
+    }
+
+    func onDocumentOpened(_ document: TWSDocument) {
+        executor.async(entity: document.sid) { [weak delegate] in
+            delegate?.onDocumentOpened?(document)
+        }
+    }
+
+    func onDocumentRemoved(_ document: TWSDocument, previousData: [String: Any], eventContext: TWSEventContext) {
+        executor.async(entity: document.sid) { [weak delegate] in
+            delegate?.onDocumentRemoved?(document, previousData: previousData, eventContext: eventContext)
+        }
+    }
+
+    func onDocument(_ document: TWSDocument, updated data: [String: Any], previousData: [String: Any], eventContext: TWSEventContext) {
+        executor.async(entity: document.sid) { [weak delegate] in
+            delegate?.onDocument?(document, updated: data, previousData: previousData, eventContext: eventContext)
+        }
+    }
+
+    func onDocument(_ document: TWSDocument, errorOccurred error: TWSError) {
+        executor.async(entity: document.sid) { [weak delegate] in
+            delegate?.onDocument?(document, errorOccurred: error)
+        }
+    }
+}
+
+/// Forwards stream events to `delegate` on the stream's executor queue. Keep it alive while the stream is open.
+final class SyncExecutingStreamDelegate: NSObject, TWSStreamDelegate {
+    private weak var delegate: TWSStreamDelegate?
+    private let executor: SyncEntityExecutor
+
+    init(delegate: TWSStreamDelegate, executor: SyncEntityExecutor) {
+        self.delegate = delegate
+        self.executor = executor
+    }
+
+    func onStreamOpened(_ stream: TWSStream) {
+        executor.async(entity: stream.sid) { [weak delegate] in
+            delegate?.onStreamOpened?(stream)
+        }
+    }
+
+    func onStream(_ stream: TWSStream, removedWith eventContext: TWSEventContext) {
+        executor.async(entity: stream.sid) { [weak delegate] in
+            delegate?.onStream?(stream, removedWith: eventContext)
+        }
+    }
+
+    func onStream(_ stream: TWSStream, messagePublished message: TWSStreamMessage, eventContext: TWSEventContext) {
+        executor.async(entity: stream.sid) { [weak delegate] in
+            delegate?.onStream?(stream, messagePublished: message, eventContext: eventContext)
+        }
+    }
+
+    func onStream(_ stream: TWSStream, errorOccurred error: TWSError) {
+        executor.async(entity: stream.sid) { [weak delegate] in
+            delegate?.onStream?(stream, errorOccurred: error)
+        }
+    }
+}
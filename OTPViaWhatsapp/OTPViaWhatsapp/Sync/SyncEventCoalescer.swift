@@ -0,0 +1,227 @@
+//
+//  SyncEventCoalescer.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// Latest state of one map or list item, as delivered in a batch.
+struct SyncItemChange {
+    enum Kind {
+        case upserted(SyncData)
+        case removed
+        /// The map or list itself was removed; `key` is empty.
+        case collectionRemoved
+    }
+
+    let entitySid: String
+    let key: String
+    let kind: Kind
+    let isLocal: Bool
+}
+
+protocol SyncEventBatchDelegate: AnyObject {
+    func eventCoalescer(_ coalescer: SyncEventCoalescer, didReceive changes: [SyncItemChange])
+}
+
+/// Map and list delegate that collapses item events per key and hands them over in batches.
+///
+/// Sync calls `TWSMapDelegate`/`TWSListDelegate` once per item event on the client's `dispatchQueue`.
+/// Point that queue at a background queue and pass this object as the entity delegate: events received
+/// within `window` are folded so only the latest version of each key survives, and the batch delegate is
+/// called once per window on `deliveryQueue` (main by default). Removing the map or list itself drops its
+/// pending item changes and is delivered as a `.collectionRemoved` change.
+///
+/// At most one batch is queued on the delivery queue at a time. When the delivery side falls behind and
+/// more than `maxPendingKeys` distinct keys are waiting, incoming events block the Sync queue until the
+/// batch in progress has been handled, so memory and delivery latency stay bounded. That batch is handled
+/// on `deliveryQueue`, so events that arrive on it, e.g. from a client left on the main queue, never wait:
+/// they are merged past the limit and counted in `overflows`.
+///
+/// With `metrics`, the size of every batch is recorded as the event backlog and the time from its oldest
+/// change to its delivery as the delivery lag.
+final class SyncEventCoalescer: NSObject {
+
+    struct Options {
+        var window: DispatchTimeInterval = .milliseconds(50)
+        var maxPendingKeys = 10_000
+
+        static let `default` = Options()
+    }
+
+    struct Statistics {
+        var events = 0
+        var delivered = 0
+        var batches = 0
+        var producerWaits = 0
+        /// Events taken past `maxPendingKeys` because they arrived on the delivery queue.
+        var overflows = 0
+    }
+
+    weak var delegate: SyncEventBatchDelegate?
+
+    private let options: Options
+    private let deliveryQueue: DispatchQueue
+    private let backlog: SyncHistogram?
+    private let deliveryLag: SyncHistogram?
+    private let timerQueue = DispatchQueue(label: "com.otpviawhatsapp.sync.event-coalescer")
+    private let condition = NSCondition()
+    private let deliveryQueueKey = DispatchSpecificKey<Bool>()
+    private var pending: [String: Int] = [:]
+    private var changes: [SyncItemChange] = []
+    private var oldestChange = DispatchTime.now()
+    private var isFlushScheduled = false
+    private var isDelivering = false
+    private var counters = Statistics()
+
+    init(options: Options = .default, deliveryQueue: DispatchQueue = .main, metrics: SyncMetrics? = nil) {
+        self.options = options
+        self.deliveryQueue = deliveryQueue
+        backlog = metrics?.histogram(SyncMetrics.Name.eventBacklog)
+        deliveryLag = metrics?.histogram(SyncMetrics.Name.eventDeliveryLag)
+        super.init()
+        deliveryQueue.setSpecific(key: deliveryQueueKey, value: true)
+    }
+
+    deinit {
+        deliveryQueue.setSpecific(key: deliveryQueueKey, value: nil)
+    }
+
+    var statistics: Statistics {
+        condition.lock()
+        defer { condition.unlock() }
+        return counters
+    }
+
+    func ingest(_ change: SyncItemChange) {
+        let isOnDeliveryQueue = DispatchQueue.getSpecific(key: deliveryQueueKey) == true
+        condition.lock()
+        defer { condition.unlock() }
+        while isDelivering, pending.count >= options.maxPendingKeys {
+            guard !isOnDeliveryQueue else {
+                // The batch in progress is queued behind this call, waiting for it would never return
+                counters.overflows += 1
+                break
+            }
+            counters.producerWaits += 1
+            condition.wait()
+        }
+        counters.events += 1
+        if case .collectionRemoved = change.kind {
+            discardPending(ofEntity: change.entitySid)
+        }
+        if changes.isEmpty {
+            oldestChange = DispatchTime.now()
+        }
+        let id = "\(change.entitySid)/\(change.key)"
+        if let position = pending[id] {
+            changes[position] = change
+        } else {
+            pending[id] = changes.count
+            changes.append(change)
+        }
+        if pending.count >= options.maxPendingKeys {
+            startDelivery()
+        } else if !isFlushScheduled {
+            isFlushScheduled = true
+            timerQueue.asyncAfter(deadline: .now() + options.window) { [weak self] in
+                self?.flush()
+            }
+        }
+    }
+}
+
+extension SyncEventCoalescer: TWSMapDelegate {
+    func onMap(_ map: TWSMap, itemAdded item: TWSMapItem, eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: map.sid, key: item.key, kind: .upserted(item.data), isLocal: eventContext.isLocal))
+    }
+
+    func onMap(_ map: TWSMap, itemUpdated item: TWSMapItem, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: map.sid, key: item.key, kind: .upserted(item.data), isLocal: eventContext.isLocal))
+    }
+
+    func onMap(_ map: TWSMap, itemRemovedWithKey itemKey: String, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: map.sid, key: itemKey, kind: .removed, isLocal: eventContext.isLocal))
+    }
+
+    func onMapCollectionRemoved(_ map: TWSMap, eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: map.sid, key: "", kind: .collectionRemoved, isLocal: eventContext.isLocal))
+    }
+}
+
+extension SyncEventCoalescer: TWSListDelegate {
+    func onList(_ list: TWSList, itemAdded item: TWSListItem, eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: list.sid, key: String(item.index), kind: .upserted(item.data), isLocal: eventContext.isLocal))
+    }
+
+    func onList(_ list: TWSList, itemUpdated item: TWSListItem, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: list.sid, key: String(item.index), kind: .upserted(item.data), isLocal: eventContext.isLocal))
+    }
+
+    func onList(_ list: TWSList, itemRemovedWithIndex itemIndex: TWSItemIndex, previousItemData: [String: Any], eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: list.sid, key: String(itemIndex), kind: .removed, isLocal: eventContext.isLocal))
+    }
+
+    func onList(_ list: TWSList, collectionRemovedWith eventContext: TWSEventContext) {
+        ingest(SyncItemChange(entitySid: list.sid, key: "", kind: .collectionRemoved, isLocal: eventContext.isLocal))
+    }
+}
+
+private extension SyncEventCoalescer {
+
+    /// Drops the pending item changes of a removed entity. Called with the lock held.
+    func discardPending(ofEntity entity: String) {
+        let kept = changes.filter { $0.entitySid != entity }
+        guard kept.count != changes.count else {
+            return
+        }
+        changes = kept
+        pending = Dictionary(uniqueKeysWithValues: kept.enumerated().map { ("\($1.entitySid)/\($1.key)", $0) })
+    }
+
+    func flush() {
+        condition.lock()
+        defer { condition.unlock() }
+        isFlushScheduled = false
+        startDelivery()
+    }
+
+    /// Hands the pending changes to the delivery queue unless a batch is already there. Called with the lock held.
+    func startDelivery() {
+        guard !isDelivering, !changes.isEmpty else {
+            return
+        }
+        let batch = changes
+        let oldest = oldestChange
+        changes = []
+        pending = [:]
+        isDelivering = true
+        counters.batches += 1
+        counters.delivered += batch.count
+        backlog?.record(batch.count)
+        deliveryQueue.async { [weak self] in
+            guard let strongSelf = self else {
+                return
+            }
+            strongSelf.deliveryLag?.recordElapsed(since: oldest)
+            strongSelf.delegate?.eventCoalescer(strongSelf, didReceive: batch)
+            strongSelf.finishDelivery()
+        }
+    }
+
+    func finishDelivery() {
+        condition.lock()
+        defer { condition.unlock() }
+        isDelivering = false
+        condition.broadcast()
+        if pending.count >= options.maxPendingKeys {
+            startDelivery()
+        } else if !changes.isEmpty, !isFlushScheduled {
+            isFlushScheduled = true
+            timerQueue.asyncAfter(deadline: .now() + options.window) { [weak self] in
+                self?.flush()
+            }
+        }
+    }
+}
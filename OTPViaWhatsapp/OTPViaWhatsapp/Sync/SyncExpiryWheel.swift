@@ -0,0 +1,250 @@
+//
+//  SyncExpiryWheel.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+protocol SyncExpiryDelegate: AnyObject {
+    func expiryWheel(_ wheel: SyncExpiryWheel, didExpire changes: [SyncItemChange])
+}
+
+/// Expires cached map and list items locally when their TTL runs out, instead of when Sync reports it.
+///
+/// The server removes an item with a TTL on its own schedule, and the removal event can arrive seconds or
+/// minutes late, which is too late for an OTP. Track each item with the expiry the app gave it (`ttl` of the
+/// write, or a date carried in the payload, since the SDK does not expose `dateExpires`) and the wheel emits
+/// a local `.removed` change for it once per tick. `isExpired` hides the item as soon as the deadline
+/// passes, even between ticks. Pass server events through `reconcile(_:)`: it swallows the removal of an
+/// item that already expired locally and lets an update bring it back.
+///
+/// Deadlines live in a hierarchical timing wheel of four levels of 64 slots. Tracking, re-tracking and
+/// untracking are O(1); a tick drains one slot and moves the entries of a higher slot down when a lower level
+/// wraps. Replaced entries are left in their slot and skipped when it is reached.
+final class SyncExpiryWheel {
+
+    struct Options {
+        var resolution: TimeInterval = 0.1
+
+        static let `default` = Options()
+    }
+
+    struct Statistics {
+        var tracked = 0
+        var expired = 0
+        /// Server removals of items that had already expired locally.
+        var confirmed = 0
+        /// Server updates of items that had expired locally.
+        var revived = 0
+    }
+
+    weak var delegate: SyncExpiryDelegate?
+
+    private let options: Options
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.expiry-wheel")
+    private let lock = NSLock()
+    private let origin: Date
+    private var currentTick = 0
+    private var levels = [[[Entry]]](repeating: [[Entry]](repeating: [], count: Constants.slots), count: Constants.levels)
+    private var deadlines: [ItemID: Deadline] = [:]
+    private var expired: Set<ItemID> = []
+    private var generation = 0
+    private var counters = Statistics()
+    private var timer: DispatchSourceTimer?
+
+    init(options: Options = .default, callbackQueue: DispatchQueue = .main, now: Date = Date()) {
+        self.options = options
+        self.callbackQueue = callbackQueue
+        origin = now
+    }
+
+    deinit {
+        timer?.cancel()
+    }
+
+    var statistics: Statistics {
+        lock.lock()
+        defer { lock.unlock() }
+        var statistics = counters
+        statistics.tracked = deadlines.count
+        return statistics
+    }
+
+    /// Tracks `key` of `entity` until `expiresAt`, replacing an earlier deadline.
+    func track(entity: String, key: String, expiresAt: Date) {
+        let id = ItemID(entity: entity, key: key)
+        lock.lock()
+        defer { lock.unlock() }
+        generation += 1
+        let deadline = Deadline(date: expiresAt, tick: tick(for: expiresAt), generation: generation)
+        deadlines[id] = deadline
+        expired.remove(id)
+        insert(Entry(id: id, deadline: deadline), earliest: currentTick + 1)
+    }
+
+    /// Tracks an item written with `ttl`; `TWSDurationInfinity` untracks it.
+    func track(entity: String, key: String, ttl: TWSDuration) {
+        guard ttl != TWSDurationInfinity else {
+            return untrack(entity: entity, key: key)
+        }
+        track(entity: entity, key: key, expiresAt: Date(timeIntervalSinceNow: TimeInterval(ttl)))
+    }
+
+    func untrack(entity: String, key: String) {
+        let id = ItemID(entity: entity, key: key)
+        lock.lock()
+        deadlines[id] = nil
+        expired.remove(id)
+        lock.unlock()
+    }
+
+    /// True once the item's deadline has passed, whether or not its removal has been emitted yet.
+    func isExpired(entity: String, key: String, now: Date = Date()) -> Bool {
+        let id = ItemID(entity: entity, key: key)
+        lock.lock()
+        defer { lock.unlock() }
+        if expired.contains(id) {
+            return true
+        }
+        return deadlines[id].map { $0.date <= now } ?? false
+    }
+
+    /// Returns the change to deliver for a server event, or nil when it only confirms a local expiry.
+    func reconcile(_ change: SyncItemChange) -> SyncItemChange? {
+        let id = ItemID(entity: change.entitySid, key: change.key)
+        lock.lock()
+        defer { lock.unlock() }
+        let wasExpired = expired.remove(id) != nil
+        switch change.kind {
+        case .removed:
+            deadlines[id] = nil
+            guard !wasExpired else {
+                counters.confirmed += 1
+                return nil
+            }
+        case .upserted:
+            if wasExpired {
+                counters.revived += 1
+            }
+        case .collectionRemoved:
+            deadlines = deadlines.filter { $0.key.entity != change.entitySid }
+            expired = expired.filter { $0.entity != change.entitySid }
+        }
+        return change
+    }
+
+    /// Runs every tick up to `now` and returns the local removals of the items that expired. An item expires
+    /// on the first tick at or after its deadline, so at most one `resolution` late.
+    func advance(to now: Date = Date()) -> [SyncItemChange] {
+        lock.lock()
+        defer { lock.unlock() }
+        var changes: [SyncItemChange] = []
+        let target = Int((now.timeIntervalSince(origin) / options.resolution).rounded(.down))
+        while currentTick < target {
+            currentTick += 1
+            runTick(into: &changes)
+        }
+        counters.expired += changes.count
+        return changes
+    }
+
+    /// Advances every `resolution` and hands expired items to the delegate until `stop()`.
+    func start() {
+        let timer = DispatchSource.makeTimerSource(queue: queue)
+        let nanoseconds = Int(options.resolution * 1_000_000_000)
+        timer.schedule(deadline: .now() + .nanoseconds(nanoseconds), repeating: .nanoseconds(nanoseconds),
+                       leeway: .nanoseconds(nanoseconds / 10))
+        timer.setEventHandler { [weak self] in
+            guard let strongSelf = self else {
+                return
+            }
+            let changes = strongSelf.advance()
+            guard !changes.isEmpty else {
+                return
+            }
+            strongSelf.callbackQueue.async {
+                strongSelf.delegate?.expiryWheel(strongSelf, didExpire: changes)
+            }
+        }
+        lock.lock()
+        self.timer?.cancel()
+        self.timer = timer
+        lock.unlock()
+        timer.resume()
+    }
+
+    func stop() {
+        lock.lock()
+        timer?.cancel()
+        timer = nil
+        lock.unlock()
+    }
+}
+
+private extension SyncExpiryWheel {
+
+    struct ItemID: Hashable {
+        let entity: String
+        let key: String
+    }
+
+    struct Deadline: Equatable {
+        let date: Date
+        let tick: Int
+        let generation: Int
+    }
+
+    struct Entry {
+        let id: ItemID
+        let deadline: Deadline
+    }
+
+    struct Constants {
+        static let levels = 4
+        static let slotBits = 6
+        static let slots = 1 << slotBits
+        static let span = 1 << (slotBits * levels)
+    }
+
+    /// First tick at or after `date`. Called with the lock held.
+    func tick(for date: Date) -> Int {
+        Int((date.timeIntervalSince(origin) / options.resolution).rounded(.up))
+    }
+
+    /// Files `entry` in the lowest level whose range covers its deadline, but no earlier than `earliest`.
+    /// Entries beyond the top level are parked in its farthest slot and filed again when it is reached.
+    /// Called with the lock held.
+    func insert(_ entry: Entry, earliest: Int) {
+        let due = max(entry.deadline.tick, earliest)
+        let tick = due - currentTick < Constants.span ? due : currentTick + Constants.span - 1
+        var level = 0
+        while tick - currentTick >= 1 << (Constants.slotBits * (level + 1)) {
+            level += 1
+        }
+        levels[level][(tick >> (Constants.slotBits * level)) & (Constants.slots - 1)].append(entry)
+    }
+
+    /// Cascades the higher slots that come due at `currentTick`, then expires its level 0 slot.
+    func runTick(into changes: inout [SyncItemChange]) {
+        var level = 1
+        while level < Constants.levels, currentTick & ((1 << (Constants.slotBits * level)) - 1) == 0 {
+            let slot = (currentTick >> (Constants.slotBits * level)) & (Constants.slots - 1)
+            let entries = levels[level][slot]
+            levels[level][slot] = []
+            for entry in entries where deadlines[entry.id] == entry.deadline {
+                insert(entry, earliest: currentTick)
+            }
+            level += 1
+        }
+        let slot = currentTick & (Constants.slots - 1)
+        let entries = levels[0][slot]
+        levels[0][slot].removeAll(keepingCapacity: true)
+        for entry in entries where deadlines[entry.id] == entry.deadline {
+            deadlines[entry.id] = nil
+            expired.insert(entry.id)
+            changes.append(SyncItemChange(entitySid: entry.id.entity, key: entry.id.key, kind: .removed, isLocal: true))
+        }
+    }
+}
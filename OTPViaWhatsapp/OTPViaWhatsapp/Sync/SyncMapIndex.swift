@@ -0,0 +1,235 @@
+//
+//  SyncMapIndex.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+
+/// A value field as ordered by `SyncMapIndex`: numbers sort before strings.
+enum SyncIndexValue: Hashable, Comparable {
+    case number(Double)
+    case string(String)
+
+    /// Reads an indexable value out of a `TWSData` field. Other types are not indexed.
+    init?(_ object: Any) {
+        if let string = object as? String {
+            self = .string(string)
+        } else if let number = object as? NSNumber {
+            self = .number(number.doubleValue)
+        } else {
+            return nil
+        }
+    }
+
+    static func < (lhs: SyncIndexValue, rhs: SyncIndexValue) -> Bool {
+        switch (lhs, rhs) {
+        case let (.number(lhs), .number(rhs)):
+            return lhs < rhs
+        case let (.string(lhs), .string(rhs)):
+            return lhs < rhs
+        case (.number, .string):
+            return true
+        case (.string, .number):
+            return false
+        }
+    }
+}
+
+extension SyncIndexValue: ExpressibleByStringLiteral, ExpressibleByIntegerLiteral, ExpressibleByFloatLiteral {
+    init(stringLiteral value: String) {
+        self = .string(value)
+    }
+
+    init(integerLiteral value: Int) {
+        self = .number(Double(value))
+    }
+
+    init(floatLiteral value: Double) {
+        self = .number(value)
+    }
+}
+
+/// Local secondary indexes over top-level value fields of one map's items.
+///
+/// `TWSMapQueryOptions` can only seek by item key, so finding items by a value field means downloading
+/// the whole map. Declare the fields to index, load the index from a `SyncCacheSnapshot` or a prefetch,
+/// and keep it current by applying the map's item changes. Each field is a sorted array of
+/// `(value, key)` pairs, so equality, range and prefix lookups are binary searches that return item keys
+/// without any network traffic. Items whose field is missing or not a string or number are left out of
+/// that field's index.
+final class SyncMapIndex {
+
+    let entitySid: String
+    let fields: [String]
+
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.map-index")
+    private var entries: [String: [Entry]]
+    private var indexed: [String: [String: SyncIndexValue]] = [:]
+
+    init(entitySid: String, fields: [String]) {
+        self.entitySid = entitySid
+        self.fields = fields
+        entries = Dictionary(uniqueKeysWithValues: fields.map { ($0, []) })
+    }
+
+    var count: Int {
+        queue.sync { indexed.count }
+    }
+
+    /// Replaces the index contents with `items`, sorting each field once rather than inserting one by one.
+    func load(_ items: [SyncItem]) {
+        queue.sync {
+            indexed = [:]
+            indexed.reserveCapacity(items.count)
+            for field in fields {
+                entries[field] = []
+            }
+            for item in items {
+                let values = indexableValues(of: item.data)
+                indexed[item.key] = values
+                for (field, value) in values {
+                    entries[field]?.append(Entry(value: value, key: item.key))
+                }
+            }
+            for field in fields {
+                entries[field]?.sort()
+            }
+        }
+    }
+
+    func load(_ snapshot: SyncCacheSnapshot) {
+        var items: [SyncItem] = []
+        items.reserveCapacity(snapshot.count)
+        snapshot.forEach {
+            items.append($0)
+            return true
+        }
+        load(items)
+    }
+
+    /// Applies changes of this index's map; changes of other entities are ignored.
+    func apply(_ changes: [SyncItemChange]) {
+        queue.sync {
+            for change in changes where change.entitySid == entitySid {
+                switch change.kind {
+                case .upserted(let data):
+                    update(key: change.key, data: data)
+                case .removed:
+                    update(key: change.key, data: nil)
+                case .collectionRemoved:
+                    indexed = [:]
+                    fields.forEach { entries[$0] = [] }
+                }
+            }
+        }
+    }
+
+    func upsert(key: String, data: SyncData) {
+        queue.sync { update(key: key, data: data) }
+    }
+
+    func remove(key: String) {
+        queue.sync { update(key: key, data: nil) }
+    }
+
+    /// Keys of the items whose `field` equals `value`, in key order.
+    func keys(where field: String, equals value: SyncIndexValue) -> [String] {
+        keys(where: field) { $0 == value ? .orderedSame : ($0 < value ? .orderedAscending : .orderedDescending) }
+    }
+
+    /// Keys of the items whose `field` lies in `range`, ordered by value and then key.
+    func keys(where field: String, in range: Range<SyncIndexValue>) -> [String] {
+        keys(where: field) { $0 < range.lowerBound ? .orderedAscending : ($0 < range.upperBound ? .orderedSame : .orderedDescending) }
+    }
+
+    func keys(where field: String, in range: ClosedRange<SyncIndexValue>) -> [String] {
+        keys(where: field) { $0 < range.lowerBound ? .orderedAscending : ($0 <= range.upperBound ? .orderedSame : .orderedDescending) }
+    }
+
+    /// Keys of the items whose string `field` starts with `prefix`, ordered by value and then key.
+    func keys(where field: String, hasPrefix prefix: String) -> [String] {
+        keys(where: field) { value in
+            guard case .string(let string) = value else {
+                return .orderedAscending
+            }
+            if string.hasPrefix(prefix) {
+                return .orderedSame
+            }
+            return string < prefix ? .orderedAscending : .orderedDescending
+        }
+    }
+}
+
+private struct Entry: Comparable {
+    let value: SyncIndexValue
+    let key: String
+
+    static func < (lhs: Entry, rhs: Entry) -> Bool {
+        lhs.value == rhs.value ? lhs.key < rhs.key : lhs.value < rhs.value
+    }
+}
+
+private extension SyncMapIndex {
+
+    func indexableValues(of data: SyncData) -> [String: SyncIndexValue] {
+        var values: [String: SyncIndexValue] = [:]
+        for field in fields {
+            if let value = data[field].flatMap(SyncIndexValue.init) {
+                values[field] = value
+            }
+        }
+        return values
+    }
+
+    /// Moves `key` to its new position in every field. Called on `queue`.
+    func update(key: String, data: SyncData?) {
+        let old = indexed[key] ?? [:]
+        let new = data.map(indexableValues) ?? [:]
+        for field in fields where old[field] != new[field] {
+            if let value = old[field] {
+                let entry = Entry(value: value, key: key)
+                let position = lowerBound(of: entry, in: field)
+                if position < entries[field]?.count ?? 0, entries[field]?[position] == entry {
+                    entries[field]?.remove(at: position)
+                }
+            }
+            if let value = new[field] {
+                let entry = Entry(value: value, key: key)
+                let position = lowerBound(of: entry, in: field)
+                entries[field]?.insert(entry, at: position)
+            }
+        }
+        indexed[key] = data == nil ? nil : new
+    }
+
+    func lowerBound(of entry: Entry, in field: String) -> Int {
+        partitionPoint(in: entries[field] ?? []) { $0 < entry }
+    }
+
+    /// First position in `entries` for which `isBefore` is false; `entries` must be partitioned by it.
+    func partitionPoint(in entries: [Entry], where isBefore: (Entry) -> Bool) -> Int {
+        var low = 0
+        var high = entries.count
+        while low < high {
+            let middle = (low + high) / 2
+            if isBefore(entries[middle]) {
+                low = middle + 1
+            } else {
+                high = middle
+            }
+        }
+        return low
+    }
+
+    /// Keys of the contiguous run of entries that `compare` places `.orderedSame`.
+    func keys(where field: String, compare: (SyncIndexValue) -> ComparisonResult) -> [String] {
+        queue.sync {
+            guard let entries = entries[field] else {
+                return []
+            }
+            let start = partitionPoint(in: entries) { compare($0.value) == .orderedAscending }
+            let end = partitionPoint(in: entries) { compare($0.value) != .orderedDescending }
+            return entries[start..<end].map(\.key)
+        }
+    }
+}
@@ -0,0 +1,434 @@
+//
+//  SyncMetrics.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// Monotonic count, such as bytes written or reconnects.
+final class SyncCounter {
+    private let lock = NSLock()
+    private var count = 0
+
+    func increment(by amount: Int = 1) {
+        lock.lock()
+        count += amount
+        lock.unlock()
+    }
+
+    var value: Int {
+        lock.lock()
+        defer { lock.unlock() }
+        return count
+    }
+}
+
+/// Distribution of non-negative values, such as latencies in microseconds, in log-linear buckets.
+///
+/// Like an HDR histogram, values below 64 are counted exactly and larger values fall into buckets 1/32
+/// of their power of two wide, so every reported percentile is within about 3% of the recorded value.
+/// Recording is one bucket computation and one increment under a lock; values above `maxValue` are
+/// clamped to it.
+final class SyncHistogram {
+
+    struct Snapshot {
+        let count: Int
+        let min: Int
+        let max: Int
+        let sum: Int
+        fileprivate let buckets: [Int]
+
+        var mean: Double {
+            count == 0 ? 0 : Double(sum) / Double(count)
+        }
+
+        /// Smallest bucketed value that at least `percentile` (0...1) of the recorded values do not exceed.
+        func value(atPercentile percentile: Double) -> Int {
+            guard count > 0 else {
+                return 0
+            }
+            let rank = Swift.max(Int((Double(count) * percentile).rounded(.up)), 1)
+            var seen = 0
+            for (bucket, bucketCount) in buckets.enumerated() where bucketCount > 0 {
+                seen += bucketCount
+                if seen >= rank {
+                    return Swift.min(Swift.max(SyncHistogram.upperBound(ofBucket: bucket), min), max)
+                }
+            }
+            return max
+        }
+    }
+
+    static let maxValue = 1 << 36
+
+    private let lock = NSLock()
+    private var buckets = [Int](repeating: 0, count: SyncHistogram.bucket(of: SyncHistogram.maxValue) + 1)
+    private var count = 0
+    private var sum = 0
+    private var minimum = Int.max
+    private var maximum = 0
+
+    func record(_ value: Int) {
+        let value = Swift.min(Swift.max(value, 0), SyncHistogram.maxValue)
+        let bucket = SyncHistogram.bucket(of: value)
+        lock.lock()
+        buckets[bucket] += 1
+        count += 1
+        sum += value
+        minimum = Swift.min(minimum, value)
+        maximum = Swift.max(maximum, value)
+        lock.unlock()
+    }
+
+    /// Records the time since `start` in microseconds.
+    func recordElapsed(since start: DispatchTime) {
+        record(Int((DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds) / 1_000))
+    }
+
+    var snapshot: Snapshot {
+        lock.lock()
+        defer { lock.unlock() }
+        return Snapshot(count: count, min: count == 0 ? 0 : minimum, max: maximum, sum: sum, buckets: buckets)
+    }
+}
+
+private extension SyncHistogram {
+
+    static let subBucketBits = 5
+
+    static func bucket(of value: Int) -> Int {
+        guard value >= 2 << subBucketBits else {
+            return value
+        }
+        let shift = (Int.bitWidth - 1 - value.leadingZeroBitCount) - subBucketBits
+        return (2 << subBucketBits) + (shift - 1) << subBucketBits + (value >> shift) - (1 << subBucketBits)
+    }
+
+    static func upperBound(ofBucket bucket: Int) -> Int {
+        guard bucket >= 2 << subBucketBits else {
+            return bucket
+        }
+        let shift = (bucket - (2 << subBucketBits)) >> subBucketBits + 1
+        let mantissa = (bucket - (2 << subBucketBits)) & ((1 << subBucketBits) - 1) + (1 << subBucketBits)
+        return (mantissa + 1) << shift - 1
+    }
+}
+
+protocol SyncMetricsDelegate: AnyObject {
+    func syncMetrics(_ metrics: SyncMetrics, didReport snapshot: SyncMetrics.Snapshot)
+}
+
+/// Named counters and histograms for the Sync layer, read with `snapshot()` or pushed periodically.
+///
+/// The SDK does not report transport internals such as RTT or frame sizes, so the metrics are taken
+/// where the app sees the traffic: `SyncMeasuredMap`, `SyncMeasuredList`, `SyncMeasuredDocument` and
+/// `SyncMeasuredStream` time each operation and count payload bytes, `recordConnectionState(_:)` counts
+/// reconnects from the client delegate, and `SyncEventCoalescer` reports its backlog and delivery lag. Look up a metric once and keep it; recording on it does not
+/// touch the registry.
+final class SyncMetrics {
+
+    enum Name {
+        static let bytesIn = "bytes.in"
+        static let bytesOut = "bytes.out"
+        static let errors = "errors"
+        static let reconnects = "connection.reconnects"
+        static let eventBacklog = "events.backlog"
+        static let eventDeliveryLag = "events.deliveryLag"
+
+        /// Latency histogram of one operation type, in microseconds.
+        static func latency(of operation: String) -> String {
+            "latency.\(operation)"
+        }
+    }
+
+    struct Snapshot {
+        let date: Date
+        let counters: [String: Int]
+        let histograms: [String: SyncHistogram.Snapshot]
+    }
+
+    weak var delegate: SyncMetricsDelegate?
+
+    private let lock = NSLock()
+    private let callbackQueue: DispatchQueue
+    private var counters: [String: SyncCounter] = [:]
+    private var histograms: [String: SyncHistogram] = [:]
+    private var hasConnected = false
+    private var connectionState = TWSClientConnectionState.unknown
+    private var timer: DispatchSourceTimer?
+
+    init(callbackQueue: DispatchQueue = .main) {
+        self.callbackQueue = callbackQueue
+    }
+
+    deinit {
+        timer?.cancel()
+    }
+
+    func counter(_ name: String) -> SyncCounter {
+        lock.lock()
+        defer { lock.unlock() }
+        if let counter = counters[name] {
+            return counter
+        }
+        let counter = SyncCounter()
+        counters[name] = counter
+        return counter
+    }
+
+    func histogram(_ name: String) -> SyncHistogram {
+        lock.lock()
+        defer { lock.unlock() }
+        if let histogram = histograms[name] {
+            return histogram
+        }
+        let histogram = SyncHistogram()
+        histograms[name] = histogram
+        return histogram
+    }
+
+    func snapshot() -> Snapshot {
+        lock.lock()
+        let counters = self.counters
+        let histograms = self.histograms
+        lock.unlock()
+        return Snapshot(date: Date(), counters: counters.mapValues(\.value), histograms: histograms.mapValues(\.snapshot))
+    }
+
+    /// Call from `syncClient(_:connectionStateChanged:)`; every connect after the first counts as a reconnect.
+    func recordConnectionState(_ state: TWSClientConnectionState) {
+        lock.lock()
+        let isConnect = state == .connected && connectionState != .connected
+        let isReconnect = isConnect && hasConnected
+        hasConnected = hasConnected || isConnect
+        connectionState = state
+        lock.unlock()
+        if isReconnect {
+            counter(Name.reconnects).increment()
+        }
+    }
+
+    /// Pushes a snapshot to the delegate every `interval` until `stopReporting()`.
+    func startReporting(every interval: DispatchTimeInterval) {
+        let timer = DispatchSource.makeTimerSource(queue: callbackQueue)
+        timer.schedule(deadline: .now() + interval, repeating: interval)
+        timer.setEventHandler { [weak self] in
+            guard let strongSelf = self else {
+                return
+            }
+            strongSelf.delegate?.syncMetrics(strongSelf, didReport: strongSelf.snapshot())
+        }
+        lock.lock()
+        self.timer?.cancel()
+        self.timer = timer
+        lock.unlock()
+        timer.resume()
+    }
+
+    func stopReporting() {
+        lock.lock()
+        timer?.cancel()
+        timer = nil
+        lock.unlock()
+    }
+}
+
+/// `SyncMapStore` decorator that records per-operation latency, payload bytes and errors.
+final class SyncMeasuredMap: SyncMapStore {
+
+    private let map: SyncMapStore
+    private let setLatency: SyncHistogram
+    private let removeLatency: SyncHistogram
+    private let mutateLatency: SyncHistogram
+    private let queryLatency: SyncHistogram
+    private let bytesIn: SyncCounter?
+    private let bytesOut: SyncCounter?
+    private let errors: SyncCounter
+
+    /// Counting bytes serializes every payload once more, so it is opt-in.
+    init(_ map: SyncMapStore, metrics: SyncMetrics, countsBytes: Bool = false) {
+        self.map = map
+        setLatency = metrics.histogram(SyncMetrics.Name.latency(of: "map.set"))
+        removeLatency = metrics.histogram(SyncMetrics.Name.latency(of: "map.remove"))
+        mutateLatency = metrics.histogram(SyncMetrics.Name.latency(of: "map.mutate"))
+        queryLatency = metrics.histogram(SyncMetrics.Name.latency(of: "map.query"))
+        bytesIn = countsBytes ? metrics.counter(SyncMetrics.Name.bytesIn) : nil
+        bytesOut = countsBytes ? metrics.counter(SyncMetrics.Name.bytesOut) : nil
+        errors = metrics.counter(SyncMetrics.Name.errors)
+    }
+
+    var sid: String {
+        map.sid
+    }
+
+    func setItem(withKey key: String, data: SyncData, ttl: TWSDuration?, completion: @escaping (Error?) -> Void) {
+        let start = DispatchTime.now()
+        bytesOut?.increment(by: estimatedBytes(of: data))
+        map.setItem(withKey: key, data: data, ttl: ttl) { [setLatency, errors] error in
+            setLatency.recordElapsed(since: start)
+            if error != nil {
+                errors.increment()
+            }
+            completion(error)
+        }
+    }
+
+    func removeItem(withKey key: String, completion: @escaping (Error?) -> Void) {
+        let start = DispatchTime.now()
+        map.removeItem(withKey: key) { [removeLatency, errors] error in
+            removeLatency.recordElapsed(since: start)
+            if error != nil {
+                errors.increment()
+            }
+            completion(error)
+        }
+    }
+
+    func mutateItem(withKey key: String, mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        let start = DispatchTime.now()
+        map.mutateItem(withKey: key, mutator: mutator) { [mutateLatency, errors, bytesOut] result in
+            mutateLatency.recordElapsed(since: start)
+            switch result {
+            case .success(let data):
+                bytesOut?.increment(by: data.map(estimatedBytes) ?? 0)
+            case .failure:
+                errors.increment()
+            }
+            completion(result)
+        }
+    }
+
+    func queryItems(startingAt startKey: String?, pageSize: Int, completion: @escaping (Result<SyncMapPage, Error>) -> Void) {
+        let start = DispatchTime.now()
+        map.queryItems(startingAt: startKey, pageSize: pageSize) { [queryLatency, errors, bytesIn] result in
+            queryLatency.recordElapsed(since: start)
+            switch result {
+            case .success(let page):
+                bytesIn?.increment(by: page.items.reduce(0) { $0 + estimatedBytes(of: $1.data) })
+            case .failure:
+                errors.increment()
+            }
+            completion(result)
+        }
+    }
+}
+
+/// `SyncListStore` decorator that records per-operation latency, payload bytes and errors.
+final class SyncMeasuredList: SyncListStore {
+
+    private let list: SyncListStore
+    private let addLatency: SyncHistogram
+    private let queryLatency: SyncHistogram
+    private let bytesIn: SyncCounter?
+    private let bytesOut: SyncCounter?
+    private let errors: SyncCounter
+
+    /// Counting bytes serializes every payload once more, so it is opt-in.
+    init(_ list: SyncListStore, metrics: SyncMetrics, countsBytes: Bool = false) {
+        self.list = list
+        addLatency = metrics.histogram(SyncMetrics.Name.latency(of: "list.add"))
+        queryLatency = metrics.histogram(SyncMetrics.Name.latency(of: "list.query"))
+        bytesIn = countsBytes ? metrics.counter(SyncMetrics.Name.bytesIn) : nil
+        bytesOut = countsBytes ? metrics.counter(SyncMetrics.Name.bytesOut) : nil
+        errors = metrics.counter(SyncMetrics.Name.errors)
+    }
+
+    var sid: String {
+        list.sid
+    }
+
+    func addItem(withData data: SyncData, ttl: TWSDuration?, completion: @escaping (Result<TWSItemIndex, Error>) -> Void) {
+        let start = DispatchTime.now()
+        bytesOut?.increment(by: estimatedBytes(of: data))
+        list.addItem(withData: data, ttl: ttl) { [addLatency, errors] result in
+            addLatency.recordElapsed(since: start)
+            if case .failure = result {
+                errors.increment()
+            }
+            completion(result)
+        }
+    }
+
+    func queryItems(startingAt startIndex: TWSItemIndex?, pageSize: Int, completion: @escaping (Result<SyncListPage, Error>) -> Void) {
+        let start = DispatchTime.now()
+        list.queryItems(startingAt: startIndex, pageSize: pageSize) { [queryLatency, errors, bytesIn] result in
+            queryLatency.recordElapsed(since: start)
+            switch result {
+            case .success(let page):
+                bytesIn?.increment(by: page.items.reduce(0) { $0 + estimatedBytes(of: $1.data) })
+            case .failure:
+                errors.increment()
+            }
+            completion(result)
+        }
+    }
+}
+
+/// `SyncDocumentStore` decorator that records mutation latency, payload bytes and errors.
+final class SyncMeasuredDocument: SyncDocumentStore {
+
+    private let document: SyncDocumentStore
+    private let mutateLatency: SyncHistogram
+    private let bytesOut: SyncCounter?
+    private let errors: SyncCounter
+
+    /// Counting bytes serializes every payload once more, so it is opt-in.
+    init(_ document: SyncDocumentStore, metrics: SyncMetrics, countsBytes: Bool = false) {
+        self.document = document
+        mutateLatency = metrics.histogram(SyncMetrics.Name.latency(of: "document.mutate"))
+        bytesOut = countsBytes ? metrics.counter(SyncMetrics.Name.bytesOut) : nil
+        errors = metrics.counter(SyncMetrics.Name.errors)
+    }
+
+    var sid: String {
+        document.sid
+    }
+
+    func mutateData(with mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        let start = DispatchTime.now()
+        document.mutateData(with: mutator) { [mutateLatency, errors, bytesOut] result in
+            mutateLatency.recordElapsed(since: start)
+            switch result {
+            case .success(let data):
+                bytesOut?.increment(by: data.map(estimatedBytes) ?? 0)
+            case .failure:
+                errors.increment()
+            }
+            completion(result)
+        }
+    }
+}
+
+/// `SyncStreamStore` decorator that records publish latency, payload bytes and errors.
+final class SyncMeasuredStream: SyncStreamStore {
+
+    private let stream: SyncStreamStore
+    private let publishLatency: SyncHistogram
+    private let bytesOut: SyncCounter?
+    private let errors: SyncCounter
+
+    /// Counting bytes serializes every payload once more, so it is opt-in.
+    init(_ stream: SyncStreamStore, metrics: SyncMetrics, countsBytes: Bool = false) {
+        self.stream = stream
+        publishLatency = metrics.histogram(SyncMetrics.Name.latency(of: "stream.publish"))
+        bytesOut = countsBytes ? metrics.counter(SyncMetrics.Name.bytesOut) : nil
+        errors = metrics.counter(SyncMetrics.Name.errors)
+    }
+
+    var sid: String {
+        stream.sid
+    }
+
+    func publishMessage(withData data: SyncData, completion: @escaping (Result<String, Error>) -> Void) {
+        let start = DispatchTime.now()
+        bytesOut?.increment(by: estimatedBytes(of: data))
+        stream.publishMessage(withData: data) { [publishLatency, errors] result in
+            publishLatency.recordElapsed(since: start)
+            if case .failure = result {
+                errors.increment()
+            }
+            completion(result)
+        }
+    }
+}
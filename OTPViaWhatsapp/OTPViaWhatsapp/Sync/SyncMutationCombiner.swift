@@ -0,0 +1,143 @@
+//
+//  SyncMutationCombiner.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+
+/// Folds concurrent local mutations of the same Sync entity into one server write.
+///
+/// `mutateItemWithKey:mutator:` and `mutateDataWith:` re-run their mutator on every revision conflict, so
+/// many writers bumping one counter each pay a conflict round-trip per competing write. The combiner keeps
+/// at most one mutation per entity in flight. Mutators submitted meanwhile are queued, and the next write
+/// applies the whole queue in submission order inside a single mutator. When Sync reports a conflict it
+/// calls that mutator again with the fresh value, which replays the queue once on top of it.
+///
+/// Every caller receives the value its write produced, or `nil` when its own mutator aborted by returning
+/// `nil`. Aborted mutators do not stop the rest of the queue. When every mutator of a write aborts, the
+/// combined mutator aborts too and nothing is written; the callers then receive `nil` whatever Sync
+/// reports for the aborted mutation.
+final class SyncMutationCombiner {
+
+    struct Statistics {
+        var submitted = 0
+        var writes = 0
+        var conflicts = 0
+        var failures = 0
+    }
+
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.mutation-combiner")
+    private var entities: [String: EntityState] = [:]
+    private var counters = Statistics()
+
+    init(callbackQueue: DispatchQueue = .main) {
+        self.callbackQueue = callbackQueue
+    }
+
+    var statistics: Statistics {
+        queue.sync { counters }
+    }
+
+    func mutateItem(withKey key: String, in map: SyncMapStore, mutator: @escaping SyncMutator,
+                    completion: ((Result<SyncData?, Error>) -> Void)? = nil) {
+        enqueue(Entry(mutator: mutator, completion: completion), for: "\(map.sid)/\(key)") { mutator, done in
+            map.mutateItem(withKey: key, mutator: mutator, completion: done)
+        }
+    }
+
+    func mutateData(of document: SyncDocumentStore, mutator: @escaping SyncMutator,
+                    completion: ((Result<SyncData?, Error>) -> Void)? = nil) {
+        enqueue(Entry(mutator: mutator, completion: completion), for: document.sid) { mutator, done in
+            document.mutateData(with: mutator, completion: done)
+        }
+    }
+}
+
+private extension SyncMutationCombiner {
+
+    typealias Write = (@escaping SyncMutator, @escaping (Result<SyncData?, Error>) -> Void) -> Void
+
+    struct Entry {
+        let mutator: SyncMutator
+        let completion: ((Result<SyncData?, Error>) -> Void)?
+    }
+
+    final class EntityState {
+        var pending: [Entry] = []
+        var isWriting = false
+    }
+
+    /// Per-write replay state. Sync calls the mutator sequentially, never concurrently, for one write.
+    final class Replay {
+        var attempts = 0
+        var applied: [Bool]
+
+        init(count: Int) {
+            applied = Array(repeating: false, count: count)
+        }
+
+        /// The last run of the mutator aborted for every entry, so Sync wrote nothing.
+        var isAborted: Bool {
+            attempts > 0 && !applied.contains(true)
+        }
+    }
+
+    func enqueue(_ entry: Entry, for entity: String, write: @escaping Write) {
+        queue.async {
+            let state = self.entities[entity] ?? EntityState()
+            self.entities[entity] = state
+            state.pending.append(entry)
+            self.counters.submitted += 1
+            self.flush(state, entity: entity, write: write)
+        }
+    }
+
+    func flush(_ state: EntityState, entity: String, write: @escaping Write) {
+        guard !state.isWriting else {
+            return
+        }
+        guard !state.pending.isEmpty else {
+            entities[entity] = nil
+            return
+        }
+        let batch = state.pending
+        let replay = Replay(count: batch.count)
+        state.pending = []
+        state.isWriting = true
+        counters.writes += 1
+
+        write({ current in
+            replay.attempts += 1
+            var data = current
+            for (index, entry) in batch.enumerated() {
+                let next = entry.mutator(data)
+                replay.applied[index] = next != nil
+                data = next ?? data
+            }
+            return replay.applied.contains(true) ? data : nil
+        }, { result in
+            self.queue.async {
+                self.counters.conflicts += max(replay.attempts - 1, 0)
+                let outcome: Result<SyncData?, Error> = replay.isAborted ? .success(nil) : result
+                if case .failure = outcome {
+                    self.counters.failures += 1
+                }
+                state.isWriting = false
+                self.complete(batch, replay: replay, with: outcome)
+                self.flush(state, entity: entity, write: write)
+            }
+        })
+    }
+
+    func complete(_ batch: [Entry], replay: Replay, with result: Result<SyncData?, Error>) {
+        let outcomes = batch.indices.map { index in
+            result.map { replay.applied[index] ? $0 : nil }
+        }
+        callbackQueue.async {
+            zip(batch, outcomes).forEach { entry, outcome in
+                entry.completion?(outcome)
+            }
+        }
+    }
+}
@@ -0,0 +1,620 @@
+//
+//  SyncOfflineJournal.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// One Sync write, recorded in the offline journal until it has been replayed.
+enum SyncJournalMutation {
+    case setItem(key: String, data: SyncData, ttl: TWSDuration?)
+    case removeItem(key: String)
+    /// Sets the given top-level fields of a map item, creating it when missing.
+    case mergeItem(key: String, fields: SyncData)
+    case addListItem(data: SyncData, ttl: TWSDuration?)
+    case setData(SyncData)
+    /// Sets the given top-level fields of a document.
+    case mergeData(SyncData)
+}
+
+enum SyncJournalError: LocalizedError {
+    case invalidData
+    case unsupportedMutation(entity: String)
+
+    var errorDescription: String? {
+        switch self {
+        case .invalidData:
+            return "Journaled data is not JSON serializable"
+        case .unsupportedMutation(let entity):
+            return "Mutation does not apply to the type of entity \(entity)"
+        }
+    }
+}
+
+/// Durable queue of Sync writes made while the client is offline, replayed in order once it reconnects.
+///
+/// Sync holds or fails `setItem` and friends while the connection is down and keeps nothing across a
+/// restart. Route writes through `append(_:toEntity:)` instead. Every mutation is appended to a
+/// checksummed journal file before it is queued, so a crash loses at most a write torn in half, which
+/// the next open detects and cuts off. The file is mapped and replayed into memory on open.
+///
+/// Pending mutations are kept per entity in append order. A write to the same key as the last pending
+/// one replaces it or, for merges, is folded into it. Once `connectionStateChanged(_:)` reports
+/// `.connected`, each registered entity replays in batches of up to `maxBatchSize` mutations with
+/// distinct keys. A batch is sent at once and acknowledged in the journal with one record. Merges go
+/// through the entity's mutator, so a conflict re-applies the fields on the fresh server value, and
+/// `resolveConflict` can do the same for plain sets. Replay is at least once: a mutation whose
+/// acknowledgement never reached the file is sent again after the next open, which leaves sets, removes and
+/// merges converged but adds a list append twice. A failed mutation stays at the head of its entity and
+/// is retried after `retryDelay`, doubling per attempt up to `maxRetryDelay`; appends made meanwhile wait
+/// for the retry, and a reconnect runs it right away. Only failures while the client stayed connected count
+/// against `maxAttempts`. The file is reset once nothing is pending.
+final class SyncOfflineJournal {
+
+    struct Options {
+        var maxBatchSize = 64
+        /// Attempts per mutation before it is dropped and reported through `onFailure`.
+        var maxAttempts = 3
+        /// Delay before the first retry of a failed batch; it doubles with every further attempt.
+        var retryDelay: TimeInterval = 1
+        var maxRetryDelay: TimeInterval = 60
+        /// Flushes the file and the drive's cache with `F_FULLFSYNC` after every append, so a write survives
+        /// power loss once `append` returns. Falls back to `fsync` where the file system does not support it.
+        var synchronizesAppends = true
+
+        static let `default` = Options()
+    }
+
+    struct Statistics {
+        var appended = 0
+        var compacted = 0
+        var replayed = 0
+        var dropped = 0
+        var batches = 0
+        var pending = 0
+    }
+
+    /// Called on the callback queue for every mutation dropped after `maxAttempts`.
+    var onFailure: ((String, SyncJournalMutation, Error) -> Void)?
+
+    /// Merges a journaled `setItem` without ttl, or `setData`, into the server value on replay. Returning nil
+    /// keeps the server value. Without it the journaled value wins.
+    var resolveConflict: ((SyncData?, SyncData) -> SyncData?)?
+
+    private let options: Options
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.offline-journal")
+    private let handle: FileHandle
+    private var entities: [String: EntityLog] = [:]
+    private var targets: [String: Target] = [:]
+    private var nextSequence: UInt64 = 0
+    private var journaledRecords = 0
+    private var isConnected = false
+    /// Bumped whenever `isConnected` changes, so a batch can tell whether the connection held while it ran.
+    private var connectionEpoch = 0
+    private var counters = Statistics()
+
+    init(fileURL: URL, options: Options = .default, callbackQueue: DispatchQueue = .main) throws {
+        self.options = options
+        self.callbackQueue = callbackQueue
+        try FileManager.default.createDirectory(at: fileURL.deletingLastPathComponent(), withIntermediateDirectories: true)
+        let recovered = Recovery(try Data(contentsOfIfPresent: fileURL) ?? Data())
+        if recovered.needsRewrite {
+            try recovered.rewrittenFile().write(to: fileURL, options: .atomic)
+        }
+        handle = try FileHandle(forWritingTo: fileURL)
+        try handle.seekToEnd()
+        nextSequence = recovered.nextSequence
+        journaledRecords = recovered.pending.count
+        recovered.pending.forEach { enqueue($0.mutation, sequence: $0.sequence, toEntity: $0.entity) }
+    }
+
+    deinit {
+        try? handle.close()
+    }
+
+    static func makeDefault(options: Options = .default) throws -> SyncOfflineJournal {
+        let support = try FileManager.default.url(for: .applicationSupportDirectory, in: .userDomainMask, appropriateFor: nil, create: true)
+        return try SyncOfflineJournal(fileURL: support.appendingPathComponent(Constants.fileName), options: options)
+    }
+
+    var statistics: Statistics {
+        queue.sync {
+            var statistics = counters
+            statistics.pending = entities.values.reduce(0) { $0 + $1.pendingCount + $1.inFlight }
+            return statistics
+        }
+    }
+
+    func register(_ map: SyncMapStore) {
+        register(.map(map), entity: map.sid)
+    }
+
+    func register(_ list: SyncListStore) {
+        register(.list(list), entity: list.sid)
+    }
+
+    func register(_ document: SyncDocumentStore) {
+        register(.document(document), entity: document.sid)
+    }
+
+    /// Journals `mutation` and replays it right away when the entity is registered and the client is connected.
+    func append(_ mutation: SyncJournalMutation, toEntity entity: String) throws {
+        try queue.sync {
+            let sequence = nextSequence
+            let payload = try Record.mutation(sequence: sequence, entity: entity, mutation: mutation)
+            try write(payload)
+            nextSequence += 1
+            journaledRecords += 1
+            counters.appended += 1
+            enqueue(mutation, sequence: sequence, toEntity: entity)
+            replayIfPossible(entity)
+        }
+    }
+
+    /// Call from `syncClient(_:connectionStateChanged:)`.
+    func connectionStateChanged(_ state: TWSClientConnectionState) {
+        queue.async {
+            let isConnected = state == .connected
+            guard isConnected != self.isConnected else {
+                return
+            }
+            self.isConnected = isConnected
+            self.connectionEpoch += 1
+            for entity in self.entities.keys {
+                self.entities[entity]?.retryAt = nil
+                self.replayIfPossible(entity)
+            }
+        }
+    }
+}
+
+private extension SyncOfflineJournal {
+
+    enum Target {
+        case map(SyncMapStore)
+        case list(SyncListStore)
+        case document(SyncDocumentStore)
+    }
+
+    struct PendingMutation {
+        var sequences: [UInt64]
+        var mutation: SyncJournalMutation
+        var attempts = 0
+    }
+
+    /// Pending mutations of one entity from `head` on; `pending[..<head]` has been handed to a batch.
+    struct EntityLog {
+        var pending: [PendingMutation] = []
+        var head = 0
+        var inFlight = 0
+        /// When a failed batch may be retried; nothing is sent for the entity before then.
+        var retryAt: DispatchTime?
+
+        var pendingCount: Int {
+            pending.count - head
+        }
+    }
+
+    struct Constants {
+        static let fileName = "SyncOfflineJournal.log"
+    }
+
+    func register(_ target: Target, entity: String) {
+        queue.async {
+            self.targets[entity] = target
+            self.replayIfPossible(entity)
+        }
+    }
+
+    /// Queues `mutation`, folding it into the last pending mutation of the same key. Called on the queue.
+    func enqueue(_ mutation: SyncJournalMutation, sequence: UInt64, toEntity entity: String) {
+        var log = entities[entity] ?? EntityLog()
+        if log.pendingCount > 0, let folded = log.pending[log.pending.count - 1].mutation.folding(mutation) {
+            log.pending[log.pending.count - 1].mutation = folded
+            log.pending[log.pending.count - 1].sequences.append(sequence)
+            counters.compacted += 1
+        } else {
+            log.pending.append(PendingMutation(sequences: [sequence], mutation: mutation))
+        }
+        entities[entity] = log
+    }
+
+    /// Appends a frame, cutting the file back to where it was when the write fails, so a torn frame does
+    /// not hide the records appended after it from the next open.
+    func write(_ payload: Data) throws {
+        let offset = try handle.offset()
+        do {
+            try handle.write(contentsOf: Record.frame(payload))
+            if options.synchronizesAppends, fcntl(handle.fileDescriptor, F_FULLFSYNC) == -1 {
+                try handle.synchronize()
+            }
+        } catch {
+            try? handle.truncate(atOffset: offset)
+            throw error
+        }
+    }
+
+    /// Sends the next batch of `entity` unless one is in flight. Called on the queue.
+    func replayIfPossible(_ entity: String) {
+        guard isConnected, let target = targets[entity], var log = entities[entity], log.inFlight == 0, log.pendingCount > 0,
+              log.retryAt.map({ $0 <= .now() }) ?? true else {
+            return
+        }
+        var batch: [PendingMutation] = []
+        var keys = Set<String>()
+        while log.head < log.pending.count, batch.count < options.maxBatchSize {
+            let next = log.pending[log.head]
+            guard let key = next.mutation.foldingKey else {
+                if batch.isEmpty {
+                    batch.append(next)
+                    log.head += 1
+                }
+                break
+            }
+            guard keys.insert(key).inserted else {
+                break
+            }
+            batch.append(next)
+            log.head += 1
+        }
+        log.inFlight = batch.count
+        entities[entity] = log
+        counters.batches += 1
+
+        let group = DispatchGroup()
+        var errors = [Error?](repeating: nil, count: batch.count)
+        for (position, pending) in batch.enumerated() {
+            group.enter()
+            replay(pending.mutation, on: target, entity: entity) { error in
+                self.queue.async {
+                    errors[position] = error
+                    group.leave()
+                }
+            }
+        }
+        let epoch = connectionEpoch
+        group.notify(queue: queue) { [weak self] in
+            self?.finishBatch(batch, errors: errors, entity: entity, epoch: epoch)
+        }
+    }
+
+    /// Settles a batch sent during connection `epoch`. Failures only count as attempts when the client
+    /// stayed connected, since a dropped connection fails every write in flight.
+    func finishBatch(_ batch: [PendingMutation], errors: [Error?], entity: String, epoch: Int) {
+        guard var log = entities[entity] else {
+            return
+        }
+        let stayedConnected = isConnected && epoch == connectionEpoch
+        var acknowledged: [UInt64] = []
+        var retries: [PendingMutation] = []
+        var dropped: [(SyncJournalMutation, Error)] = []
+        for (pending, error) in zip(batch, errors) {
+            guard let error = error else {
+                acknowledged += pending.sequences
+                counters.replayed += 1
+                continue
+            }
+            var retry = pending
+            if stayedConnected {
+                retry.attempts += 1
+            }
+            if retry.attempts < options.maxAttempts {
+                retries.append(retry)
+            } else {
+                acknowledged += pending.sequences
+                dropped.append((pending.mutation, error))
+                counters.dropped += 1
+            }
+        }
+        log.head -= retries.count
+        log.pending.replaceSubrange(log.head..<log.head + retries.count, with: retries)
+        if log.head > log.pending.count / 2 {
+            log.pending.removeFirst(log.head)
+            log.head = 0
+        }
+        log.inFlight = 0
+        log.retryAt = nil
+        if stayedConnected, let attempts = retries.map(\.attempts).max() {
+            log.retryAt = .now() + min(options.retryDelay * pow(2, Double(attempts - 1)), options.maxRetryDelay)
+        }
+        entities[entity] = log.pending.isEmpty ? nil : log
+        acknowledge(acknowledged)
+
+        if !dropped.isEmpty, let onFailure = onFailure {
+            callbackQueue.async {
+                dropped.forEach { onFailure(entity, $0.0, $0.1) }
+            }
+        }
+        guard let retryAt = log.retryAt else {
+            return replayIfPossible(entity)
+        }
+        queue.asyncAfter(deadline: retryAt) { [weak self] in
+            self?.replayIfPossible(entity)
+        }
+    }
+
+    /// Records replayed sequences, or resets the file once every journaled mutation has been replayed.
+    func acknowledge(_ sequences: [UInt64]) {
+        guard !sequences.isEmpty else {
+            return
+        }
+        journaledRecords -= sequences.count
+        do {
+            if journaledRecords == 0 {
+                try handle.truncate(atOffset: UInt64(Record.magic.count))
+                try handle.seekToEnd()
+            } else {
+                try write(Record.acknowledgement(sequences))
+            }
+        } catch {
+            // The sequences are replayed again after the next open. Sets, removes and merges converge, but
+            // a list append is added twice.
+        }
+    }
+
+    func replay(_ mutation: SyncJournalMutation, on target: Target, entity: String, completion: @escaping (Error?) -> Void) {
+        let resolve = resolveConflict
+        switch (mutation, target) {
+        case (.setItem(let key, let data, .none), .map(let map)) where resolve != nil:
+            map.mutateItem(withKey: key, mutator: { resolve?($0, data) }) { completion($0.error) }
+        case (.setItem(let key, let data, let ttl), .map(let map)):
+            map.setItem(withKey: key, data: data, ttl: ttl, completion: completion)
+        case (.removeItem(let key), .map(let map)):
+            map.removeItem(withKey: key, completion: completion)
+        case (.mergeItem(let key, let fields), .map(let map)):
+            map.mutateItem(withKey: key, mutator: { ($0 ?? [:]).merging(fields) { $1 } }) { completion($0.error) }
+        case (.addListItem(let data, let ttl), .list(let list)):
+            list.addItem(withData: data, ttl: ttl) { completion($0.error) }
+        case (.setData(let data), .document(let document)):
+            document.mutateData(with: { current in resolve.map { $0(current, data) } ?? data }) { completion($0.error) }
+        case (.mergeData(let fields), .document(let document)):
+            document.mutateData(with: { ($0 ?? [:]).merging(fields) { $1 } }) { completion($0.error) }
+        default:
+            completion(SyncJournalError.unsupportedMutation(entity: entity))
+        }
+    }
+}
+
+private extension SyncJournalMutation {
+
+    /// Key that a later mutation must share to be folded into this one; nil for list appends, which never fold.
+    var foldingKey: String? {
+        switch self {
+        case .setItem(let key, _, _), .removeItem(let key), .mergeItem(let key, _):
+            return key
+        case .setData, .mergeData:
+            return ""
+        case .addListItem:
+            return nil
+        }
+    }
+
+    /// The single mutation equivalent to this one followed by `next`, or nil when they cannot be combined.
+    func folding(_ next: SyncJournalMutation) -> SyncJournalMutation? {
+        guard let key = foldingKey, key == next.foldingKey else {
+            return nil
+        }
+        switch (self, next) {
+        case (.setItem, .setItem), (.setItem, .removeItem), (.removeItem, .setItem), (.removeItem, .removeItem),
+             (.mergeItem, .setItem), (.mergeItem, .removeItem), (.setData, .setData), (.mergeData, .setData):
+            return next
+        case (.setItem(_, let data, let ttl), .mergeItem(_, let fields)):
+            return .setItem(key: key, data: data.merging(fields) { $1 }, ttl: ttl)
+        case (.removeItem, .mergeItem(_, let fields)):
+            return .setItem(key: key, data: fields, ttl: nil)
+        case (.mergeItem(_, let earlier), .mergeItem(_, let fields)):
+            return .mergeItem(key: key, fields: earlier.merging(fields) { $1 })
+        case (.setData(let data), .mergeData(let fields)):
+            return .setData(data.merging(fields) { $1 })
+        case (.mergeData(let earlier), .mergeData(let fields)):
+            return .mergeData(earlier.merging(fields) { $1 })
+        default:
+            return nil
+        }
+    }
+}
+
+private extension Result {
+    var error: Error? {
+        if case .failure(let error) = self {
+            return error
+        }
+        return nil
+    }
+}
+
+/// Journal file layout: a magic header, then frames of payload length, FNV-1a checksum and payload. A
+/// payload is either a mutation (type, sequence, entity, key, ttl, JSON data) or an acknowledgement of
+/// replayed sequences. All integers are little-endian.
+private enum Record {
+
+    static let magic: [UInt8] = Array("SYJ1".utf8)
+    static let acknowledgementType: UInt8 = 0xFF
+
+    static func frame(_ payload: Data) -> Data {
+        var frame = Data(capacity: payload.count + 8)
+        frame.append(uint32: UInt32(payload.count))
+        frame.append(uint32: checksum(payload))
+        frame.append(payload)
+        return frame
+    }
+
+    static func mutation(sequence: UInt64, entity: String, mutation: SyncJournalMutation) throws -> Data {
+        let (type, key, data, ttl) = fields(of: mutation)
+        guard data.map({ JSONSerialization.isValidJSONObject($0) }) ?? true else {
+            throw SyncJournalError.invalidData
+        }
+        var payload = Data([type])
+        payload.append(uint64: sequence)
+        payload.append(string: entity)
+        payload.append(string: key)
+        payload.append(contentsOf: [ttl == nil ? 0 : 1])
+        payload.append(uint32: ttl ?? 0)
+        let json = try data.map { try JSONSerialization.data(withJSONObject: $0) } ?? Data()
+        payload.append(uint32: UInt32(json.count))
+        payload.append(json)
+        return payload
+    }
+
+    static func fields(of mutation: SyncJournalMutation) -> (type: UInt8, key: String, data: SyncData?, ttl: TWSDuration?) {
+        switch mutation {
+        case .setItem(let key, let data, let ttl):
+            return (0, key, data, ttl)
+        case .removeItem(let key):
+            return (1, key, nil, nil)
+        case .mergeItem(let key, let fields):
+            return (2, key, fields, nil)
+        case .addListItem(let data, let ttl):
+            return (3, "", data, ttl)
+        case .setData(let data):
+            return (4, "", data, nil)
+        case .mergeData(let fields):
+            return (5, "", fields, nil)
+        }
+    }
+
+    static func acknowledgement(_ sequences: [UInt64]) -> Data {
+        var payload = Data([acknowledgementType])
+        payload.append(uint32: UInt32(sequences.count))
+        sequences.forEach { payload.append(uint64: $0) }
+        return payload
+    }
+
+    static func checksum(_ payload: Data) -> UInt32 {
+        payload.reduce(2_166_136_261) { ($0 ^ UInt32($1)) &* 16_777_619 }
+    }
+}
+
+/// Reads a journal file back: every intact frame up to the first torn or corrupt one, minus acknowledged
+/// mutations.
+private struct Recovery {
+
+    struct Pending {
+        let sequence: UInt64
+        let entity: String
+        let mutation: SyncJournalMutation
+        let payload: Data
+    }
+
+    private(set) var pending: [Pending] = []
+    private(set) var nextSequence: UInt64 = 0
+    private(set) var needsRewrite = false
+
+    init(_ file: Data) {
+        guard file.count >= Record.magic.count, [UInt8](file.prefix(Record.magic.count)) == Record.magic else {
+            needsRewrite = true
+            return
+        }
+        var reader = JournalReader(file, offset: Record.magic.count)
+        var acknowledged = Set<UInt64>()
+        var mutations: [Pending] = []
+        while reader.offset < file.count {
+            guard let length = reader.readUInt32(), let checksum = reader.readUInt32(),
+                  let payload = reader.readBytes(Int(length)), Record.checksum(payload) == checksum,
+                  let record = Recovery.parse(payload) else {
+                needsRewrite = true
+                break
+            }
+            switch record {
+            case .mutation(let mutation):
+                mutations.append(mutation)
+                nextSequence = max(nextSequence, mutation.sequence + 1)
+            case .acknowledgement(let sequences):
+                acknowledged.formUnion(sequences)
+                needsRewrite = true
+            }
+        }
+        pending = mutations.filter { !acknowledged.contains($0.sequence) }
+    }
+
+    func rewrittenFile() -> Data {
+        pending.reduce(into: Data(Record.magic)) { $0.append(Record.frame($1.payload)) }
+    }
+
+    private enum Parsed {
+        case mutation(Pending)
+        case acknowledgement([UInt64])
+    }
+
+    private static func parse(_ payload: Data) -> Parsed? {
+        var reader = JournalReader(payload)
+        guard let type = reader.readBytes(1)?.first else {
+            return nil
+        }
+        if type == Record.acknowledgementType {
+            guard let count = reader.readUInt32() else {
+                return nil
+            }
+            let sequences = (0..<count).compactMap { _ in reader.readUInt64() }
+            return sequences.count == Int(count) ? .acknowledgement(sequences) : nil
+        }
+        guard let sequence = reader.readUInt64(), let entity = reader.readString(), let key = reader.readString(),
+              let hasTTL = reader.readBytes(1)?.first, let ttlValue = reader.readUInt32(),
+              let jsonLength = reader.readUInt32(), let json = reader.readBytes(Int(jsonLength)) else {
+            return nil
+        }
+        let ttl = hasTTL == 1 ? ttlValue : nil
+        let data = json.isEmpty ? nil : (try? JSONSerialization.jsonObject(with: json)) as? SyncData
+        let mutation: SyncJournalMutation
+        switch (type, data) {
+        case (0, let data?):
+            mutation = .setItem(key: key, data: data, ttl: ttl)
+        case (1, _):
+            mutation = .removeItem(key: key)
+        case (2, let data?):
+            mutation = .mergeItem(key: key, fields: data)
+        case (3, let data?):
+            mutation = .addListItem(data: data, ttl: ttl)
+        case (4, let data?):
+            mutation = .setData(data)
+        case (5, let data?):
+            mutation = .mergeData(data)
+        default:
+            return nil
+        }
+        return .mutation(Pending(sequence: sequence, entity: entity, mutation: mutation, payload: payload))
+    }
+}
+
+/// Bounds-checked little-endian reader over a mapped journal file.
+private struct JournalReader {
+
+    let storage: Data
+    private(set) var offset: Int
+
+    init(_ storage: Data, offset: Int = 0) {
+        self.storage = storage
+        self.offset = offset
+    }
+
+    mutating func readBytes(_ count: Int) -> Data? {
+        let start = storage.startIndex + offset
+        guard count >= 0, storage.endIndex - start >= count else {
+            return nil
+        }
+        offset += count
+        return storage[start..<start + count]
+    }
+
+    mutating func readUInt32() -> UInt32? {
+        readBytes(4).map { bytes in bytes.reversed().reduce(0) { $0 << 8 | UInt32($1) } }
+    }
+
+    mutating func readUInt64() -> UInt64? {
+        readBytes(8).map { bytes in bytes.reversed().reduce(0) { $0 << 8 | UInt64($1) } }
+    }
+
+    mutating func readString() -> String? {
+        readUInt32().flatMap { readBytes(Int($0)) }.flatMap { String(data: $0, encoding: .utf8) }
+    }
+}
+
+private extension Data {
+    mutating func append(string: String) {
+        let bytes = Data(string.utf8)
+        append(uint32: UInt32(bytes.count))
+        append(bytes)
+    }
+}
@@ -0,0 +1,239 @@
+//
+//  SyncPrefetchScheduler.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// Bounded replacement for opening entities with `TWSSynchronizationStrategyAggressive`.
+///
+/// Aggressive sync pulls whole collections on open, all at once, competing with the requests the UI is
+/// waiting for. Open entities with the default strategy instead and hand them to this scheduler. It prefetches
+/// one page at a time, taking the highest-priority entity next, with at most `maxConcurrentPages` page
+/// queries outstanding and an optional byte-rate cap. No prefetch page is started while an interactive
+/// operation is running, so interactive queries never queue behind prefetch traffic for more than the pages
+/// already in flight.
+final class SyncPrefetchScheduler {
+
+    enum Priority: Int, Comparable {
+        case low
+        case normal
+        case high
+
+        static func < (lhs: Priority, rhs: Priority) -> Bool {
+            lhs.rawValue < rhs.rawValue
+        }
+    }
+
+    struct Options {
+        var maxConcurrentPages = 2
+        var pageSize = 100
+        /// Prefetched bytes per second, estimated from item payloads; nil for no cap.
+        var maxBytesPerSecond: Int? = 256 * 1024
+
+        static let `default` = Options()
+    }
+
+    struct Progress {
+        let entity: String
+        var pages = 0
+        var items = 0
+        var bytes = 0
+        var isComplete = false
+        var error: Error?
+    }
+
+    /// Called on the callback queue after every prefetched page and when an entity completes or fails.
+    var onProgress: ((Progress) -> Void)?
+
+    private let options: Options
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.prefetch-scheduler")
+    private var jobs: [Job] = []
+    private var sequence = 0
+    private var activePages = 0
+    private var interactiveOperations = 0
+    private var availableBytes: Double
+    private var lastRefill = DispatchTime.now()
+    private var isRefillScheduled = false
+
+    init(options: Options = .default, callbackQueue: DispatchQueue = .main) {
+        self.options = options
+        self.callbackQueue = callbackQueue
+        availableBytes = Double(options.maxBytesPerSecond ?? 0)
+    }
+
+    /// Prefetches every item of `map`, passing each page to `onItems` as it arrives.
+    func prefetch(_ map: SyncMapStore, entity: String? = nil, priority: Priority = .normal, onItems: (([SyncItem]) -> Void)? = nil) {
+        var last: String?
+        let pageSize = options.pageSize
+        enqueue(entity: entity ?? map.sid, priority: priority) { completion in
+            map.queryItems(startingAt: last, pageSize: last == nil ? pageSize : pageSize + 1) { result in
+                completion(result.map { page in
+                    let items = page.items.filter { $0.key != last }
+                    last = items.last?.key ?? last
+                    onItems?(items)
+                    return PageOutcome(items: items.count, bytes: items.reduce(0) { $0 + estimatedBytes(of: $1.data) },
+                                       isLast: items.count < pageSize)
+                })
+            }
+        }
+    }
+
+    /// Prefetches every item of `list`, passing each page to `onItems` as it arrives.
+    func prefetch(_ list: SyncListStore, entity: String? = nil, priority: Priority = .normal, onItems: (([SyncListItem]) -> Void)? = nil) {
+        var next: TWSItemIndex?
+        let pageSize = options.pageSize
+        enqueue(entity: entity ?? list.sid, priority: priority) { completion in
+            list.queryItems(startingAt: next, pageSize: pageSize) { result in
+                completion(result.map { page in
+                    let items = page.items
+                    next = items.last.map { $0.index + 1 } ?? next
+                    onItems?(items)
+                    return PageOutcome(items: items.count, bytes: items.reduce(0) { $0 + estimatedBytes(of: $1.data) },
+                                       isLast: !page.hasNextPage)
+                })
+            }
+        }
+    }
+
+    func cancelPrefetch(ofEntity entity: String) {
+        queue.async {
+            self.jobs.removeAll { $0.progress.entity == entity }
+        }
+    }
+
+    /// Pauses prefetching until `endInteractive()` has been called as often as this.
+    func beginInteractive() {
+        queue.async {
+            self.interactiveOperations += 1
+        }
+    }
+
+    func endInteractive() {
+        queue.async {
+            self.interactiveOperations = max(self.interactiveOperations - 1, 0)
+            self.pump()
+        }
+    }
+
+    /// Runs `operation` with prefetching paused until it calls its completion.
+    func performInteractive(_ operation: (@escaping () -> Void) -> Void) {
+        beginInteractive()
+        operation { [weak self] in
+            self?.endInteractive()
+        }
+    }
+}
+
+private struct PageOutcome {
+    let items: Int
+    let bytes: Int
+    let isLast: Bool
+}
+
+private extension SyncPrefetchScheduler {
+
+    typealias FetchPage = (@escaping (Result<PageOutcome, Error>) -> Void) -> Void
+
+    final class Job {
+        let priority: Priority
+        let order: Int
+        let fetchPage: FetchPage
+        var progress: Progress
+        var isFetching = false
+
+        init(entity: String, priority: Priority, order: Int, fetchPage: @escaping FetchPage) {
+            self.priority = priority
+            self.order = order
+            self.fetchPage = fetchPage
+            progress = Progress(entity: entity)
+        }
+    }
+
+    func enqueue(entity: String, priority: Priority, fetchPage: @escaping FetchPage) {
+        queue.async {
+            self.sequence += 1
+            self.jobs.append(Job(entity: entity, priority: priority, order: self.sequence, fetchPage: fetchPage))
+            self.pump()
+        }
+    }
+
+    func pump() {
+        while activePages < options.maxConcurrentPages, interactiveOperations == 0 {
+            let ready = jobs.filter { !$0.isFetching }
+            guard let job = ready.min(by: { ($1.priority, $0.order) < ($0.priority, $1.order) }) else {
+                return
+            }
+            guard reserveBandwidth() else {
+                return
+            }
+            start(job)
+        }
+    }
+
+    func start(_ job: Job) {
+        job.isFetching = true
+        activePages += 1
+        job.fetchPage { result in
+            self.queue.async {
+                self.activePages -= 1
+                job.isFetching = false
+                switch result {
+                case .failure(let error):
+                    job.progress.error = error
+                    self.finish(job)
+                case .success(let outcome):
+                    job.progress.pages += 1
+                    job.progress.items += outcome.items
+                    job.progress.bytes += outcome.bytes
+                    self.availableBytes -= Double(outcome.bytes)
+                    if outcome.isLast {
+                        job.progress.isComplete = true
+                        self.finish(job)
+                    } else {
+                        self.report(job.progress)
+                    }
+                }
+                self.pump()
+            }
+        }
+    }
+
+    func finish(_ job: Job) {
+        jobs.removeAll { $0 === job }
+        report(job.progress)
+    }
+
+    func report(_ progress: Progress) {
+        guard let onProgress = onProgress else {
+            return
+        }
+        callbackQueue.async {
+            onProgress(progress)
+        }
+    }
+
+    /// Token bucket holding at most one second of budget. Returns false and schedules a retry when empty.
+    func reserveBandwidth() -> Bool {
+        guard let rate = options.maxBytesPerSecond.map(Double.init), rate > 0 else {
+            return true
+        }
+        let now = DispatchTime.now()
+        let elapsed = Double(now.uptimeNanoseconds - lastRefill.uptimeNanoseconds) / 1_000_000_000
+        lastRefill = now
+        availableBytes = min(availableBytes + elapsed * rate, rate)
+        guard availableBytes <= 0 else {
+            return true
+        }
+        if !isRefillScheduled {
+            isRefillScheduled = true
+            queue.asyncAfter(deadline: now + -availableBytes / rate) {
+                self.isRefillScheduled = false
+                self.pump()
+            }
+        }
+        return false
+    }
+}
@@ -0,0 +1,201 @@
+//
+//  SyncReadAheadPaginator.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+struct SyncReadAheadOptions {
+    var initialPageSize = 50
+    var maxPageSize = 1000
+    /// Upper bound for the estimated serialized size of one page.
+    var maxPageBytes = 512 * 1024
+
+    static let `default` = SyncReadAheadOptions()
+}
+
+/// Scans a whole Sync map or list, fetching page N+1 while the consumer works through page N.
+///
+/// `TWSMapPaginator`/`TWSListPaginator` keep the page size of the original query, so instead of
+/// `requestNextPage` every page is a fresh query starting at the last item seen. That lets the page size
+/// change between pages: it doubles whenever the consumer finished a page before the next one arrived,
+/// capped by `maxPageSize` and by `maxPageBytes` divided by the average item size seen so far.
+final class SyncReadAheadPaginator<Item> {
+
+    /// Fetches up to `pageSize` items strictly after `last`, or from the start when `last` is nil.
+    typealias Fetch = (_ last: Item?, _ pageSize: Int, _ completion: @escaping (Result<[Item], Error>) -> Void) -> Void
+
+    struct Statistics {
+        var pages = 0
+        var items = 0
+        var stalls = 0
+        var pageSize = 0
+    }
+
+    private let fetch: Fetch
+    private let itemBytes: (Item) -> Int
+    private let options: SyncReadAheadOptions
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.read-ahead")
+    private var counters = Statistics()
+    private var sampledBytes = 0
+    private var sampledItems = 0
+
+    init(options: SyncReadAheadOptions = .default, callbackQueue: DispatchQueue = .main,
+         itemBytes: @escaping (Item) -> Int, fetch: @escaping Fetch) {
+        self.options = options
+        self.callbackQueue = callbackQueue
+        self.itemBytes = itemBytes
+        self.fetch = fetch
+        counters.pageSize = max(options.initialPageSize, 1)
+    }
+
+    var statistics: Statistics {
+        queue.sync { counters }
+    }
+
+    /// Calls `body` for every item in order on the callback queue until it returns false or the collection
+    /// ends, then calls `completion` with the error that stopped the scan, if any.
+    func forEach(_ body: @escaping (Item) -> Bool, completion: @escaping (Error?) -> Void) {
+        queue.async {
+            Scan(paginator: self, body: body, completion: completion).start()
+        }
+    }
+}
+
+extension SyncReadAheadPaginator where Item == SyncItem {
+    convenience init(map: SyncMapStore, options: SyncReadAheadOptions = .default, callbackQueue: DispatchQueue = .main) {
+        self.init(options: options, callbackQueue: callbackQueue, itemBytes: { estimatedBytes(of: $0.data) }) { last, pageSize, completion in
+            // The start position is inclusive, so ask for one more item and drop the one already seen.
+            map.queryItems(startingAt: last?.key, pageSize: last == nil ? pageSize : pageSize + 1) { result in
+                completion(result.map { page in page.items.filter { $0.key != last?.key } })
+            }
+        }
+    }
+}
+
+extension SyncReadAheadPaginator where Item == SyncListItem {
+    convenience init(list: SyncListStore, options: SyncReadAheadOptions = .default, callbackQueue: DispatchQueue = .main) {
+        self.init(options: options, callbackQueue: callbackQueue, itemBytes: { estimatedBytes(of: $0.data) }) { last, pageSize, completion in
+            list.queryItems(startingAt: last.map { $0.index + 1 }, pageSize: pageSize) { result in
+                completion(result.map(\.items))
+            }
+        }
+    }
+}
+
+private extension SyncReadAheadPaginator {
+
+    /// State of one `forEach` call. Everything except `body` runs on the paginator queue.
+    final class Scan {
+        let paginator: SyncReadAheadPaginator
+        let body: (Item) -> Bool
+        let completion: (Error?) -> Void
+        var last: Item?
+        var buffered: [Item]?
+        var isFetching = false
+        var isWaiting = false
+        var isExhausted = false
+        var isFinished = false
+
+        init(paginator: SyncReadAheadPaginator, body: @escaping (Item) -> Bool, completion: @escaping (Error?) -> Void) {
+            self.paginator = paginator
+            self.body = body
+            self.completion = completion
+        }
+
+        func start() {
+            isWaiting = true
+            fetchNext()
+        }
+
+        func fetchNext() {
+            let pageSize = paginator.counters.pageSize
+            isFetching = true
+            paginator.fetch(last, pageSize) { result in
+                self.paginator.queue.async {
+                    self.received(result, requested: pageSize)
+                }
+            }
+        }
+
+        func received(_ result: Result<[Item], Error>, requested: Int) {
+            isFetching = false
+            switch result {
+            case .failure(let error):
+                finish(error)
+            case .success(let items):
+                paginator.counters.pages += 1
+                paginator.sample(items)
+                last = items.last ?? last
+                isExhausted = items.count < requested
+                if isWaiting {
+                    deliver(items)
+                } else {
+                    buffered = items
+                }
+            }
+        }
+
+        func deliver(_ items: [Item]) {
+            isWaiting = false
+            if !isExhausted {
+                fetchNext()
+            }
+            paginator.callbackQueue.async {
+                let completed = items.allSatisfy(self.body)
+                self.paginator.queue.async {
+                    self.paginator.counters.items += items.count
+                    self.consumed(completed: completed)
+                }
+            }
+        }
+
+        func consumed(completed: Bool) {
+            guard !isFinished else {
+                return
+            }
+            guard completed else {
+                return finish(nil)
+            }
+            if let items = buffered {
+                buffered = nil
+                deliver(items)
+            } else if isFetching {
+                isWaiting = true
+                paginator.counters.stalls += 1
+                paginator.grow()
+            } else {
+                finish(nil)
+            }
+        }
+
+        func finish(_ error: Error?) {
+            guard !isFinished else {
+                return
+            }
+            isFinished = true
+            paginator.callbackQueue.async {
+                self.completion(error)
+            }
+        }
+    }
+
+    func sample(_ items: [Item]) {
+        guard let item = items.first else {
+            return
+        }
+        sampledBytes += itemBytes(item)
+        sampledItems += 1
+    }
+
+    func grow() {
+        var limit = options.maxPageSize
+        if sampledItems > 0 {
+            let averageBytes = max(sampledBytes / sampledItems, 1)
+            limit = min(limit, max(options.maxPageBytes / averageBytes, 1))
+        }
+        counters.pageSize = min(counters.pageSize * 2, limit)
+    }
+}
@@ -0,0 +1,249 @@
+//
+//  SyncStore.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+typealias SyncData = [String: Any]
+
+/// Swift form of `TWSDataMutator`: receives the current value and returns the new one, or nil to abort.
+typealias SyncMutator = (SyncData?) -> SyncData?
+
+/// Serialized size of `data`, used for the byte budgets of the helpers.
+func estimatedBytes(of data: SyncData) -> Int {
+    (try? JSONSerialization.data(withJSONObject: data).count) ?? 0
+}
+
+/// TTL sent with an item write. Nil, meaning no metadata, for no TTL and for `TWSDurationInfinity`, which
+/// clamped to `Int32` would otherwise become a TTL of about 68 years.
+func itemTtl(_ ttl: TWSDuration?) -> Int32? {
+    guard let ttl = ttl, ttl != TWSDurationInfinity else {
+        return nil
+    }
+    return Int32(clamping: ttl)
+}
+
+/// A map item detached from `TWSMapItem`, as cached and compared by the helpers.
+struct SyncItem {
+    let key: String
+    let data: SyncData
+    let dateUpdated: Date?
+}
+
+/// A list item detached from `TWSListItem`.
+struct SyncListItem {
+    let index: TWSItemIndex
+    let data: SyncData
+    let dateUpdated: Date?
+}
+
+/// One page of a map query, i.e. the part of `TWSMapPaginator` the helpers need.
+protocol SyncMapPage {
+    var items: [SyncItem] { get }
+    var hasNextPage: Bool { get }
+    func nextPage(completion: @escaping (Result<SyncMapPage, Error>) -> Void)
+}
+
+/// One page of a list query, i.e. the part of `TWSListPaginator` the helpers need.
+protocol SyncListPage {
+    var items: [SyncListItem] { get }
+    var hasNextPage: Bool { get }
+    func nextPage(completion: @escaping (Result<SyncListPage, Error>) -> Void)
+}
+
+/// The part of `TWSMap` the Sync helpers in this folder build on. Keeping it behind a protocol lets
+/// the helpers run against a local stand-in in tests and benchmarks.
+protocol SyncMapStore: AnyObject {
+    var sid: String { get }
+    func setItem(withKey key: String, data: SyncData, ttl: TWSDuration?, completion: @escaping (Error?) -> Void)
+    func removeItem(withKey key: String, completion: @escaping (Error?) -> Void)
+    func mutateItem(withKey key: String, mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void)
+    /// Queries in ascending key order, starting at `startKey` inclusive or at the first item when nil.
+    func queryItems(startingAt startKey: String?, pageSize: Int, completion: @escaping (Result<SyncMapPage, Error>) -> Void)
+}
+
+/// The part of `TWSList` the Sync helpers in this folder build on.
+protocol SyncListStore: AnyObject {
+    var sid: String { get }
+    func addItem(withData data: SyncData, ttl: TWSDuration?, completion: @escaping (Result<TWSItemIndex, Error>) -> Void)
+    /// Queries in ascending index order, starting at `startIndex` inclusive or at the first item when nil.
+    func queryItems(startingAt startIndex: TWSItemIndex?, pageSize: Int, completion: @escaping (Result<SyncListPage, Error>) -> Void)
+}
+
+/// The part of `TWSDocument` the Sync helpers in this folder build on.
+protocol SyncDocumentStore: AnyObject {
+    var sid: String { get }
+    func mutateData(with mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void)
+}
+
+/// The part of `TWSStream` the Sync helpers in this folder build on.
+protocol SyncStreamStore: AnyObject {
+    var sid: String { get }
+    /// Publishes one message and completes with its message SID.
+    func publishMessage(withData data: SyncData, completion: @escaping (Result<String, Error>) -> Void)
+}
+
+/// The part of `TwilioSyncClient` the token refresher builds on.
+protocol SyncTokenConsumer: AnyObject {
+    func updateAccessToken(_ token: String, completion: @escaping (Error?) -> Void)
+}
+
+enum SyncStoreError: LocalizedError {
+    case missingItem
+    case unknown
+
+    var errorDescription: String? {
+        switch self {
+        case .missingItem:
+            return "Sync reported success without returning an item"
+        case .unknown:
+            return "Sync operation failed without an error"
+        }
+    }
+}
+
+extension TWSResult {
+    var failure: Error? {
+        isSuccessful ? nil : (error ?? SyncStoreError.unknown)
+    }
+
+    func pageResult(_ page: SyncMapPage?) -> Result<SyncMapPage, Error> {
+        if let error = failure {
+            return .failure(error)
+        }
+        return page.map { .success($0) } ?? .failure(SyncStoreError.missingItem)
+    }
+
+    func pageResult(_ page: SyncListPage?) -> Result<SyncListPage, Error> {
+        if let error = failure {
+            return .failure(error)
+        }
+        return page.map { .success($0) } ?? .failure(SyncStoreError.missingItem)
+    }
+}
+
+extension TWSMap: SyncMapStore {
+    func setItem(withKey key: String, data: SyncData, ttl: TWSDuration?, completion: @escaping (Error?) -> Void) {
+        setItem(withKey: key, data: data, metadata: itemTtl(ttl).flatMap { TWSMapItemMetadata.withTtl($0) }) { result, _ in
+            completion(result.failure)
+        }
+    }
+
+    func removeItem(withKey key: String, completion: @escaping (Error?) -> Void) {
+        removeItem(withKey: key) { result in
+            completion(result.failure)
+        }
+    }
+
+    func mutateItem(withKey key: String, mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        mutateItem(withKey: key, mutator: { current in
+            mutator(current as? SyncData).map { NSMutableDictionary(dictionary: $0) }
+        }, metadata: nil) { result, item in
+            completion(result.failure.map { .failure($0) } ?? .success(item?.data))
+        }
+    }
+
+    func queryItems(startingAt startKey: String?, pageSize: Int, completion: @escaping (Result<SyncMapPage, Error>) -> Void) {
+        let options = TWSMapQueryOptions().withPageSize(UInt(pageSize))
+        if let startKey = startKey {
+            options.withStartPosition(startKey)
+        }
+        queryItems(with: options) { result, paginator in
+            completion(result.pageResult(paginator))
+        }
+    }
+}
+
+extension SyncItem {
+    init(_ item: TWSMapItem) {
+        self.init(key: item.key, data: item.data, dateUpdated: item.dateUpdated)
+    }
+}
+
+extension TWSMapPaginator: SyncMapPage {
+    var items: [SyncItem] {
+        getItems().map(SyncItem.init)
+    }
+
+    func nextPage(completion: @escaping (Result<SyncMapPage, Error>) -> Void) {
+        requestNextPage { result, paginator in
+            completion(result.pageResult(paginator))
+        }
+    }
+}
+
+extension TWSDocument: SyncDocumentStore {
+    func mutateData(with mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        mutateData(with: { current in
+            mutator(current as? SyncData).map { NSMutableDictionary(dictionary: $0) }
+        }, metadata: nil) { result, data in
+            completion(result.failure.map { .failure($0) } ?? .success(data))
+        }
+    }
+}
+
+extension TWSList: SyncListStore {
+    func addItem(withData data: SyncData, ttl: TWSDuration?, completion: @escaping (Result<TWSItemIndex, Error>) -> Void) {
+        addItem(withData: data, metadata: itemTtl(ttl).flatMap { TWSListItemMetadata.withTtl($0) }) { result, item in
+            if let error = result.failure {
+                completion(.failure(error))
+            } else if let item = item {
+                completion(.success(item.index))
+            } else {
+                completion(.failure(SyncStoreError.missingItem))
+            }
+        }
+    }
+
+    func queryItems(startingAt startIndex: TWSItemIndex?, pageSize: Int, completion: @escaping (Result<SyncListPage, Error>) -> Void) {
+        let options = TWSListQueryOptions().withPageSize(UInt(pageSize))
+        if let startIndex = startIndex {
+            options.withStartPosition(startIndex)
+        }
+        queryItems(with: options) { result, paginator in
+            completion(result.pageResult(paginator))
+        }
+    }
+}
+
+extension SyncListItem {
+    init(_ item: TWSListItem) {
+        self.init(index: item.index, data: item.data, dateUpdated: item.dateUpdated)
+    }
+}
+
+extension TWSListPaginator: SyncListPage {
+    var items: [SyncListItem] {
+        getItems().map(SyncListItem.init)
+    }
+
+    func nextPage(completion: @escaping (Result<SyncListPage, Error>) -> Void) {
+        requestNextPage { result, paginator in
+            completion(result.pageResult(paginator))
+        }
+    }
+}
+
+extension TWSStream: SyncStreamStore {
+    func publishMessage(withData data: SyncData, completion: @escaping (Result<String, Error>) -> Void) {
+        publishMessage(withData: data) { result, messageSid in
+            if let error = result.failure {
+                completion(.failure(error))
+            } else if let messageSid = messageSid {
+                completion(.success(messageSid))
+            } else {
+                completion(.failure(SyncStoreError.missingItem))
+            }
+        }
+    }
+}
+
+extension TwilioSyncClient: SyncTokenConsumer {
+    func updateAccessToken(_ token: String, completion: @escaping (Error?) -> Void) {
+        updateToken(token) { result in
+            completion(result.failure)
+        }
+    }
+}
@@ -0,0 +1,219 @@
+//
+//  SyncStreamPublisher.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// Fire-and-forget publishing onto a Sync stream at rates above one round-trip per message.
+///
+/// `publishMessageWithData:` sends one message per call and Twilsock has no public multi-message frame,
+/// so the publisher packs queued messages into one stream message, `{"__batch": [...], "__batchFormat": 1}`,
+/// under the 4 KB stream message limit. Subscribers unpack with `SyncStreamPublisher.messages(in:)`, which
+/// only unpacks that exact envelope; a message that looks like one is always sent inside an envelope, so it
+/// reaches subscribers unchanged. Messages wait at most `linger` for company before a partial batch goes out.
+///
+/// Outstanding publishes are bounded by a credit window that adapts to acks: it grows by one credit per
+/// window's worth of acks that arrive within `targetAckLatency`, and shrinks when acks slow down or a
+/// publish fails. The outbound queue holds at most `maxQueuedMessages`; when it is full, `dropPolicy`
+/// decides whether the new or the oldest message is discarded. Messages evicted from the queue and the
+/// messages of a failed publish are not retried; they are handed to `onFailure`.
+final class SyncStreamPublisher {
+
+    enum DropPolicy {
+        case dropNewest
+        case dropOldest
+    }
+
+    struct Options {
+        var maxQueuedMessages = 1_000
+        var dropPolicy = DropPolicy.dropOldest
+        var maxBatchMessages = 64
+        var maxBatchBytes = 4 * 1024 - 64
+        var linger: DispatchTimeInterval = .milliseconds(2)
+        var initialWindow = 4
+        var maxWindow = 64
+        var targetAckLatency: TimeInterval = 0.25
+
+        static let `default` = Options()
+    }
+
+    struct Statistics {
+        var submitted = 0
+        var acknowledged = 0
+        var dropped = 0
+        var failed = 0
+        var batches = 0
+        var window = 0
+    }
+
+    static let batchKey = "__batch"
+    static let batchFormatKey = "__batchFormat"
+    static let batchFormat = 1
+
+    /// Called on `callbackQueue` with messages that will not be delivered: the batch of a failed publish,
+    /// or an older message evicted under `.dropOldest` with `SyncStreamPublisherError.evicted`.
+    var onFailure: ((_ messages: [SyncData], _ error: Error) -> Void)?
+
+    private let stream: SyncStreamStore
+    private let options: Options
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.stream-publisher")
+    private var pending: [QueuedMessage] = []
+    private var head = 0
+    private var inFlight = 0
+    private var window: Double
+    private var isLingerScheduled = false
+    private var counters = Statistics()
+
+    init(stream: SyncStreamStore, options: Options = .default, callbackQueue: DispatchQueue = .main) {
+        self.stream = stream
+        self.options = options
+        self.callbackQueue = callbackQueue
+        window = Double(options.initialWindow)
+    }
+
+    var statistics: Statistics {
+        queue.sync {
+            var statistics = counters
+            statistics.window = Int(window)
+            return statistics
+        }
+    }
+
+    /// Queues `data` for publishing. Returns false when the message is dropped: it is larger than a batch
+    /// may be, or the queue is full under `.dropNewest`.
+    @discardableResult
+    func publish(_ data: SyncData) -> Bool {
+        let bytes = estimatedBytes(of: data)
+        return queue.sync {
+            counters.submitted += 1
+            guard bytes > 0, bytes < options.maxBatchBytes else {
+                counters.dropped += 1
+                return false
+            }
+            if pending.count - head >= options.maxQueuedMessages {
+                counters.dropped += 1
+                guard options.dropPolicy == .dropOldest else {
+                    return false
+                }
+                report([pending[head].data], error: SyncStreamPublisherError.evicted)
+                head += 1
+            }
+            pending.append(QueuedMessage(data: data, bytes: bytes, enqueued: DispatchTime.now()))
+            pump()
+            return true
+        }
+    }
+
+    /// The messages carried by one received stream message, whether batched or published on its own.
+    static func messages(in data: SyncData) -> [SyncData] {
+        guard data.count == 2, data[batchFormatKey] as? Int == batchFormat, let messages = data[batchKey] as? [SyncData] else {
+            return [data]
+        }
+        return messages
+    }
+}
+
+enum SyncStreamPublisherError: LocalizedError {
+    case evicted
+
+    var errorDescription: String? {
+        switch self {
+        case .evicted:
+            return "The message was evicted from a full publish queue"
+        }
+    }
+}
+
+private struct QueuedMessage {
+    let data: SyncData
+    let bytes: Int
+    let enqueued: DispatchTime
+}
+
+private extension SyncStreamPublisher {
+
+    /// Sends batches while credits are available. Called on `queue`.
+    func pump() {
+        while inFlight < max(Int(window), 1), head < pending.count {
+            guard let batch = takeBatch() else {
+                return
+            }
+            send(batch)
+        }
+    }
+
+    /// Removes the next batch from the queue, or returns nil and schedules a retry while a partial batch lingers.
+    func takeBatch() -> [QueuedMessage]? {
+        var end = head
+        var bytes = 0
+        while end < pending.count, end - head < options.maxBatchMessages, bytes + pending[end].bytes + 1 <= options.maxBatchBytes {
+            bytes += pending[end].bytes + 1
+            end += 1
+        }
+        let isFull = end < pending.count || end - head == options.maxBatchMessages
+        guard isFull || DispatchTime.now() >= pending[head].enqueued + options.linger else {
+            if !isLingerScheduled {
+                isLingerScheduled = true
+                queue.asyncAfter(deadline: pending[head].enqueued + options.linger) {
+                    self.isLingerScheduled = false
+                    self.pump()
+                }
+            }
+            return nil
+        }
+        let batch = Array(pending[head..<end])
+        head = end
+        if head > 1_024, head * 2 > pending.count {
+            pending.removeFirst(head)
+            head = 0
+        }
+        return batch
+    }
+
+    func send(_ batch: [QueuedMessage]) {
+        inFlight += 1
+        counters.batches += 1
+        let data = envelope(batch.map(\.data))
+        let sent = DispatchTime.now()
+        stream.publishMessage(withData: data) { result in
+            self.queue.async {
+                self.inFlight -= 1
+                let latency = Double(DispatchTime.now().uptimeNanoseconds - sent.uptimeNanoseconds) / 1_000_000_000
+                switch result {
+                case .success:
+                    self.counters.acknowledged += batch.count
+                    if latency <= self.options.targetAckLatency {
+                        self.window = min(self.window + 1 / self.window, Double(self.options.maxWindow))
+                    } else {
+                        self.window = max(self.window * 0.75, 1)
+                    }
+                case .failure(let error):
+                    self.counters.failed += batch.count
+                    self.window = max(self.window / 2, 1)
+                    self.report(batch.map(\.data), error: error)
+                }
+                self.pump()
+            }
+        }
+    }
+
+    /// A lone message goes out as is unless it carries `batchKey`, so it can never pass for an envelope.
+    func envelope(_ messages: [SyncData]) -> SyncData {
+        if messages.count == 1, messages[0][SyncStreamPublisher.batchKey] == nil {
+            return messages[0]
+        }
+        return [SyncStreamPublisher.batchKey: messages, SyncStreamPublisher.batchFormatKey: SyncStreamPublisher.batchFormat]
+    }
+
+    func report(_ messages: [SyncData], error: Error) {
+        guard let onFailure = onFailure else {
+            return
+        }
+        callbackQueue.async {
+            onFailure(messages, error)
+        }
+    }
+}
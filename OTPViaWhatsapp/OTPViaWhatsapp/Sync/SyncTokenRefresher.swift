@@ -0,0 +1,201 @@
+//
+//  SyncTokenRefresher.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// An access token and the moment it stops being accepted.
+struct SyncAccessToken {
+    let jwt: String
+    let expiresAt: Date
+
+    init(jwt: String, expiresAt: Date) {
+        self.jwt = jwt
+        self.expiresAt = expiresAt
+    }
+
+    /// Reads the expiry from the `exp` claim; nil when the token is not a JWT carrying one.
+    init?(jwt: String) {
+        let segments = jwt.split(separator: ".")
+        guard segments.count == 3 else {
+            return nil
+        }
+        var payload = segments[1].replacingOccurrences(of: "-", with: "+").replacingOccurrences(of: "_", with: "/")
+        payload += String(repeating: "=", count: (4 - payload.count % 4) % 4)
+        guard let data = Data(base64Encoded: payload),
+              let claims = (try? JSONSerialization.jsonObject(with: data)) as? [String: Any],
+              let exp = claims["exp"] as? NSNumber else {
+            return nil
+        }
+        self.init(jwt: jwt, expiresAt: Date(timeIntervalSince1970: exp.doubleValue))
+    }
+}
+
+/// Fetches access tokens for the Sync client, usually from the app's backend.
+protocol SyncTokenProvider: AnyObject {
+    func fetchToken(completion: @escaping (Result<SyncAccessToken, Error>) -> Void)
+}
+
+/// Keeps the Sync client's token fresh ahead of expiry instead of when the client asks for it.
+///
+/// `syncClientTokenWillExpire` leaves the fetch and the `updateToken` round-trip to the moment the
+/// client already needs the new token, and the app's own requests that carry the token stall meanwhile.
+/// The refresher fetches `refreshMargin` before expiry, swaps the token into the client and into
+/// `withValidToken(_:)` callers in one step once the client accepted it, and runs every trigger that
+/// arrives during a refresh, including the client's own delegate calls, on that same refresh. A token that
+/// lives no longer than `refreshMargin` is refreshed halfway through its lifetime instead, so short-lived
+/// tokens do not refresh back to back. A failed refresh is retried with a delay doubling from `retryDelay`
+/// up to `maxRetryDelay`, and keeps being retried after the current token expired. While the token is valid,
+/// no retry is scheduled later than `expiryLead` before its expiry, so the last one can still land in time.
+final class SyncTokenRefresher {
+
+    struct Options {
+        var refreshMargin: TimeInterval = 60
+        var retryDelay: TimeInterval = 5
+        var maxRetryDelay: TimeInterval = 60
+        var expiryLead: TimeInterval = 1
+
+        static let `default` = Options()
+    }
+
+    struct Statistics {
+        var refreshes = 0
+        var failures = 0
+        var coalescedTriggers = 0
+        /// Requests that had to wait for a refresh because the token had already expired.
+        var stalledRequests = 0
+    }
+
+    private let provider: SyncTokenProvider
+    private let client: SyncTokenConsumer
+    private let options: Options
+    private let callbackQueue: DispatchQueue
+    private let queue = DispatchQueue(label: "com.otpviawhatsapp.sync.token-refresher")
+    private var token: SyncAccessToken?
+    private var waiters: [(Result<String, Error>) -> Void] = []
+    private var isRefreshing = false
+    private var consecutiveFailures = 0
+    private var scheduledRefresh: DispatchWorkItem?
+    private var stats = Statistics()
+
+    init(provider: SyncTokenProvider, client: SyncTokenConsumer, options: Options = .default, callbackQueue: DispatchQueue = .main) {
+        self.provider = provider
+        self.client = client
+        self.options = options
+        self.callbackQueue = callbackQueue
+    }
+
+    deinit {
+        scheduledRefresh?.cancel()
+    }
+
+    var statistics: Statistics {
+        queue.sync { stats }
+    }
+
+    /// Starts from the token the client was created with and schedules its refresh.
+    func start(with token: SyncAccessToken) {
+        queue.async {
+            self.token = token
+            self.scheduleRefresh()
+        }
+    }
+
+    /// Refreshes now unless a refresh is already running. Call from `syncClientTokenWillExpire` and
+    /// `syncClientTokenExpired`.
+    func refresh() {
+        queue.async {
+            self.startRefresh()
+        }
+    }
+
+    /// Passes the current token to `body` right away while it is valid, otherwise after the next refresh.
+    func withValidToken(_ body: @escaping (Result<String, Error>) -> Void) {
+        queue.async {
+            if let token = self.token, token.expiresAt > Date() {
+                self.callbackQueue.async { body(.success(token.jwt)) }
+                return
+            }
+            self.stats.stalledRequests += 1
+            self.waiters.append(body)
+            self.startRefresh()
+        }
+    }
+}
+
+private extension SyncTokenRefresher {
+
+    func startRefresh() {
+        guard !isRefreshing else {
+            stats.coalescedTriggers += 1
+            return
+        }
+        isRefreshing = true
+        scheduledRefresh?.cancel()
+        scheduledRefresh = nil
+        provider.fetchToken { [weak self] result in
+            guard let strongSelf = self else {
+                return
+            }
+            switch result {
+            case .success(let token):
+                strongSelf.client.updateAccessToken(token.jwt) { error in
+                    strongSelf.queue.async {
+                        strongSelf.finishRefresh(error.map { .failure($0) } ?? .success(token))
+                    }
+                }
+            case .failure(let error):
+                strongSelf.queue.async {
+                    strongSelf.finishRefresh(.failure(error))
+                }
+            }
+        }
+    }
+
+    func finishRefresh(_ result: Result<SyncAccessToken, Error>) {
+        isRefreshing = false
+        switch result {
+        case .success(let token):
+            self.token = token
+            stats.refreshes += 1
+            consecutiveFailures = 0
+            scheduleRefresh()
+        case .failure:
+            stats.failures += 1
+            consecutiveFailures += 1
+            scheduleRetry()
+        }
+        let waiters = self.waiters
+        self.waiters.removeAll()
+        let delivered = result.map(\.jwt)
+        callbackQueue.async {
+            waiters.forEach { $0(delivered) }
+        }
+    }
+
+    func scheduleRefresh() {
+        guard let token = token else {
+            return
+        }
+        let lifetime = token.expiresAt.timeIntervalSinceNow
+        schedule(after: max(lifetime - options.refreshMargin, lifetime * 0.5))
+    }
+
+    /// Backs off exponentially, but retries no later than `expiryLead` before a still valid token expires.
+    func scheduleRetry() {
+        let backoff = min(options.retryDelay * pow(2, Double(consecutiveFailures - 1)), options.maxRetryDelay)
+        let untilLastRetry = (token?.expiresAt.timeIntervalSinceNow ?? 0) - options.expiryLead
+        schedule(after: untilLastRetry > 0 ? min(backoff, untilLastRetry) : backoff)
+    }
+
+    func schedule(after delay: TimeInterval) {
+        scheduledRefresh?.cancel()
+        let work = DispatchWorkItem { [weak self] in
+            self?.startRefresh()
+        }
+        scheduledRefresh = work
+        queue.asyncAfter(deadline: .now() + max(delay, 0), execute: work)
+    }
+}
@@ -0,0 +1,127 @@
+//
+//  SyncTypedMap.swift
+//  OTPViaWhatsapp
+//
+
+import Foundation
+import TwilioSyncClient
+
+/// Converts one entity's item payloads to and from `Value`.
+///
+/// Sync does not expose the wire bytes of an item, only the `TWSData` dictionary it already parsed, so
+/// `decode(_:)` reads that dictionary in place with `SyncDataDecoder` rather than serializing it back to
+/// JSON first. Payloads that are still bytes, such as the records of a `SyncCacheSnapshot`, are decoded
+/// directly with `decode(bytes:)` and never become dictionaries at all.
+struct SyncPayloadCodec<Value: Codable> {
+
+    private let decoder = SyncDataDecoder()
+    private let jsonDecoder = JSONDecoder()
+    private let jsonEncoder = JSONEncoder()
+
+    init() {
+        // Dates are written as seconds since 1970, and read from bytes by the same rule `SyncDataDecoder` uses.
+        jsonEncoder.dateEncodingStrategy = .secondsSince1970
+        jsonDecoder.dateDecodingStrategy = SyncDataDecoder.dateDecodingStrategy
+    }
+
+    func decode(_ data: SyncData) throws -> Value {
+        try decoder.decode(Value.self, from: data)
+    }
+
+    func decode(bytes: Data) throws -> Value {
+        try jsonDecoder.decode(Value.self, from: bytes)
+    }
+
+    func encode(_ value: Value) throws -> SyncData {
+        let bytes = try jsonEncoder.encode(value)
+        guard let data = try JSONSerialization.jsonObject(with: bytes) as? SyncData else {
+            throw SyncPayloadError.notAnObject
+        }
+        return data
+    }
+}
+
+enum SyncPayloadError: LocalizedError {
+    case notAnObject
+
+    var errorDescription: String? {
+        switch self {
+        case .notAnObject:
+            return "Sync item payloads must encode to a JSON object"
+        }
+    }
+}
+
+/// A map whose items all share the payload type `Value`.
+///
+/// Wraps a `SyncMapStore` so callers read and write structs instead of `TWSData`. Use one instance per
+/// map, i.e. per schema. Items that do not decode are reported as failures rather than skipped.
+final class SyncTypedMap<Value: Codable> {
+
+    let store: SyncMapStore
+    let codec = SyncPayloadCodec<Value>()
+
+    init(_ store: SyncMapStore) {
+        self.store = store
+    }
+
+    func setItem(_ value: Value, forKey key: String, ttl: TWSDuration? = nil, completion: @escaping (Error?) -> Void) {
+        do {
+            store.setItem(withKey: key, data: try codec.encode(value), ttl: ttl, completion: completion)
+        } catch {
+            completion(error)
+        }
+    }
+
+    /// Typed `mutateItem`. A stored value that fails to decode aborts the mutation with the decoding error.
+    func mutateItem(forKey key: String, mutator: @escaping (Value?) -> Value?, completion: @escaping (Result<Value?, Error>) -> Void) {
+        let codec = self.codec
+        var failure: Error?
+        store.mutateItem(withKey: key, mutator: { current in
+            do {
+                failure = nil
+                let value = try current.map { try codec.decode($0) }
+                return try mutator(value).map { try codec.encode($0) }
+            } catch {
+                failure = error
+                return nil
+            }
+        }, completion: { result in
+            if let failure = failure {
+                return completion(.failure(failure))
+            }
+            completion(result.flatMap { data in Result { try data.map { try codec.decode($0) } } })
+        })
+    }
+
+    /// One page of items in ascending key order, decoded.
+    func queryItems(startingAt startKey: String? = nil, pageSize: Int,
+                    completion: @escaping (Result<[(key: String, value: Value)], Error>) -> Void) {
+        let codec = self.codec
+        store.queryItems(startingAt: startKey, pageSize: pageSize) { result in
+            completion(result.flatMap { page in
+                Result { try page.items.map { ($0.key, try codec.decode($0.data)) } }
+            })
+        }
+    }
+
+    /// Decodes every cached item of this map straight from the snapshot bytes.
+    func values(in snapshot: SyncCacheSnapshot) throws -> [(key: String, value: Value)] {
+        var values: [(key: String, value: Value)] = []
+        values.reserveCapacity(snapshot.count)
+        var failure: Error?
+        snapshot.forEachPayload { key, payload in
+            do {
+                values.append((key, try codec.decode(bytes: payload)))
+                return true
+            } catch {
+                failure = error
+                return false
+            }
+        }
+        if let failure = failure {
+            throw failure
+        }
+        return values
+    }
+}
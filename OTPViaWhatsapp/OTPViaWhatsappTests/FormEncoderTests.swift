@@ -0,0 +1,91 @@
+//
+//  FormEncoderTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import TwilioVerifySDK
+
+final class FormEncoderTests: XCTestCase {
+
+    private let optionalValue: String? = "optional"
+
+    private lazy var parameters: [Parameter] = [
+        Parameter(name: "FriendlyName", value: "Puja's iPhone"),
+        Parameter(name: "FactorType", value: "push"),
+        Parameter(name: "Binding.PublicKey", value: "MFkwEwYHKoZIzj0C+AQYI/KoZIzj0DAQcDQgAE=="),
+        Parameter(name: "Config.NotificationToken", value: "0a1b2c3d 4e5f&a=b?c#d"),
+        Parameter(name: "Metadata", value: "{\"os\":\"iOS\",\"emoji\":\"✅\",\"name\":\"Pújä\"}"),
+        Parameter(name: "Status", value: ["pending", "approved"]),
+        Parameter(name: "Counts", value: [1, -42, Int.max]),
+        Parameter(name: "PageSize", value: 50),
+        Parameter(name: "Negative", value: Int.min),
+        Parameter(name: "Enabled", value: true),
+        Parameter(name: "Disabled", value: false),
+        Parameter(name: "Ratio", value: 0.25),
+        Parameter(name: "Number", value: NSNumber(value: 7)),
+        Parameter(name: "Optional", value: optionalValue as Any),
+        Parameter(name: "Empty", value: ""),
+        Parameter(name: "NoValues", value: [String]())
+    ]
+
+    func testEncodingIsByteCompatibleWithPercentEncodedPairs() {
+        var params = Parameters()
+        params.addAll(parameters)
+
+        XCTAssertEqual(params.asString(), legacyEncoded(parameters))
+        XCTAssertEqual(params.asFormData(), legacyEncoded(parameters).data(using: .utf8))
+    }
+
+    func testAllowedTableMatchesCharacterSet() {
+        for byte in UInt8.min...UInt8.max {
+            let string = String(decoding: [byte], as: UTF8.self)
+            var encoder = FormEncoder()
+            encoder.append(Parameter(name: "k", value: string))
+            XCTAssertEqual(encoder.string, "k=\(string)".addingPercentEncoding(withAllowedCharacters: .customURLQueryAllowed))
+        }
+    }
+
+    func testUpdateReplacesValueKeepingOrder() {
+        var params = Parameters()
+        params.addAll([Parameter(name: "a", value: 1), Parameter(name: "b", value: 2)])
+        params.addAll([Parameter(name: "a", value: 3)])
+
+        XCTAssertEqual(params.asString(), "a=3&b=2")
+    }
+
+    func testPerformanceFormEncoding() {
+        var params = Parameters()
+        params.addAll(parameters)
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for _ in 0..<10_000 {
+                _ = params.asFormData()
+            }
+        }
+    }
+
+    func testPerformanceLegacyEncoding() {
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for _ in 0..<10_000 {
+                _ = legacyEncoded(parameters).data(using: .utf8)
+            }
+        }
+    }
+}
+
+private extension FormEncoderTests {
+    func legacyEncoded(_ parameters: [Parameter]) -> String {
+        var data = [String]()
+        parameters.forEach { parameter in
+            if let values = parameter.value as? [Any] {
+                values.forEach {
+                    data.append(parameter.name + "[]=\($0)")
+                }
+            } else {
+                data.append(parameter.name + "=\(parameter.value)")
+            }
+        }
+        return data.map { $0.addingPercentEncoding(withAllowedCharacters: .customURLQueryAllowed) ?? "" }.joined(separator: "&")
+    }
+}
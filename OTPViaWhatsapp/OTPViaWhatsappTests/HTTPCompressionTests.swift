@@ -0,0 +1,97 @@
+//
+//  HTTPCompressionTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import TwilioVerifySDK
+
+final class HTTPCompressionTests: XCTestCase {
+
+    private let factorBody: Data = {
+        let metadata = (0..<32).map { "\"key\($0)\":\"value-\($0)-\(String(repeating: "x", count: 24))\"" }.joined(separator: ",")
+        let body = "FriendlyName=iPhone&FactorType=push&Binding.PublicKey=\(String(repeating: "MFkwEwYHKoZIzj0CAQYIKoZIzj0DAQcDQgAE", count: 4))" +
+            "&Binding.Alg=ES256&Config.SdkVersion=2.2.2&Config.AppId=com.twilio.otp&Config.NotificationPlatform=apn" +
+            "&Config.NotificationToken=\(String(repeating: "0a1b2c3d", count: 8))&Metadata={\(metadata)}"
+        return Data(body.utf8)
+    }()
+
+    func testGzipRoundTrip() throws {
+        let compressed = try HTTPCompression.gzip(factorBody)
+
+        XCTAssertEqual(Array(compressed.prefix(2)), [0x1F, 0x8B])
+        XCTAssertLessThan(compressed.count, factorBody.count)
+        XCTAssertEqual(try HTTPCompression.decompress(compressed, encoding: .gzip), factorBody)
+    }
+
+    func testDecodeIfNeededSkipsAlreadyDecodedBody() throws {
+        let json = Data("{\"sid\":\"YF123\"}".utf8)
+        let headers: [AnyHashable: Any] = ["content-encoding": "gzip"]
+
+        XCTAssertEqual(try HTTPCompression.decodeIfNeeded(json, headers: headers), json)
+        XCTAssertEqual(try HTTPCompression.decodeIfNeeded(try HTTPCompression.gzip(json), headers: headers), json)
+    }
+
+    func testZlibTrailerIsVerified() throws {
+        let gzip = try HTTPCompression.gzip(factorBody)
+        let deflate = gzip.dropFirst(HTTPCompression.Constants.gzipHeader.count).dropLast(HTTPCompression.Constants.gzipTrailerSize)
+        let adler = Adler32.checksum(factorBody)
+        var zlib = Data([0x78, 0x9C]) + deflate + Data([24, 16, 8, 0].map { UInt8(truncatingIfNeeded: adler >> $0) })
+
+        XCTAssertEqual(try HTTPCompression.decompress(zlib, encoding: .deflate), factorBody)
+        zlib[zlib.count - 1] ^= 0xFF
+        XCTAssertThrowsError(try HTTPCompression.decompress(zlib, encoding: .deflate))
+    }
+
+    func testBrotliIsDecoded() throws {
+        guard #available(iOS 15.0, *) else {
+            throw XCTSkip("Brotli decoding needs iOS 15")
+        }
+        // {"sid":"YF123"} as a single uncompressed brotli meta-block.
+        let brotli = Data([0xE0, 0x00, 0x10, 0x7B, 0x22, 0x73, 0x69, 0x64, 0x22, 0x3A, 0x22, 0x59, 0x46, 0x31, 0x32, 0x33,
+                           0x22, 0x7D, 0x03])
+        let json = Data("{\"sid\":\"YF123\"}".utf8)
+        let headers: [AnyHashable: Any] = ["content-encoding": "br"]
+
+        XCTAssertEqual(try HTTPCompression.decompress(brotli, encoding: .brotli), json)
+        XCTAssertEqual(try HTTPCompression.decodeIfNeeded(brotli, headers: headers), json)
+        XCTAssertEqual(try HTTPCompression.decodeIfNeeded(json, headers: headers), json)
+        XCTAssertTrue(ContentEncoding.accepted.contains(.brotli))
+    }
+
+    func testInvalidHeaderThrows() throws {
+        var compressed = try HTTPCompression.gzip(factorBody)
+        compressed[2] = 0x00
+
+        XCTAssertThrowsError(try HTTPCompression.decompress(compressed, encoding: .gzip))
+        XCTAssertThrowsError(try HTTPCompression.decompress(factorBody, encoding: .deflate))
+    }
+
+    func testBuilderCompressesOnlyAboveThreshold() throws {
+        let helper = RequestHelper(authorization: BasicAuthorization(username: "token", password: "jwt"),
+                                   compression: CompressionConfig(compressRequestBody: true, threshold: 64))
+        let small = try URLRequestBuilder(withURL: "https://verify.twilio.com/v2/Services", requestHelper: helper)
+            .setHTTPMethod(.post)
+            .setParameters([Parameter(name: "AuthPayload", value: "jwt")])
+            .build()
+        let large = try URLRequestBuilder(withURL: "https://verify.twilio.com/v2/Services", requestHelper: helper)
+            .setHTTPMethod(.post)
+            .setParameters([Parameter(name: "AuthPayload", value: String(repeating: "a", count: 512))])
+            .build()
+
+        XCTAssertNil(small.value(forHTTPHeaderField: HTTPHeader.Constant.contentEncoding))
+        XCTAssertEqual(large.value(forHTTPHeaderField: HTTPHeader.Constant.contentEncoding), ContentEncoding.gzip.value)
+        XCTAssertTrue(large.value(forHTTPHeaderField: HTTPHeader.Constant.acceptEncoding)?.contains("gzip") == true)
+    }
+
+    func testPerformanceGzipFactorBody() throws {
+        let compressed = try HTTPCompression.gzip(factorBody)
+        XCTAssertLessThan(compressed.count, factorBody.count)
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for _ in 0..<100 {
+                _ = try? HTTPCompression.gzip(factorBody)
+            }
+        }
+    }
+}
@@ -0,0 +1,59 @@
+//
+//  HTTPHeadersTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import TwilioVerifySDK
+
+final class HTTPHeadersTests: XCTestCase {
+
+    func testNamesMatchCaseInsensitivelyAndKeepFirstPosition() {
+        var headers = HTTPHeaders()
+
+        headers.addAll([.accept("application/json"), .userAgent("OTPViaWhatsapp/1.0"),
+                        HTTPHeader(key: "accept", value: "text/plain"), HTTPHeader(key: "X-Request-Id", value: "42")])
+
+        XCTAssertEqual(headers.map(\.key), ["accept", "User-Agent", "X-Request-Id"])
+        XCTAssertEqual(headers.value(for: "ACCEPT"), "text/plain")
+        XCTAssertEqual(headers.value(for: "x-request-id"), "42")
+        XCTAssertNil(headers.value(for: "Content-Type"))
+        XCTAssertEqual(headers.dictionary, ["accept": "text/plain", "User-Agent": "OTPViaWhatsapp/1.0", "X-Request-Id": "42"])
+    }
+
+    func testPerformanceBuildAndLookupHeaders() {
+        let common = commonHeaders()
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for _ in 0..<10_000 {
+                var headers = HTTPHeaders()
+                headers.addAll(common)
+                XCTAssertNotNil(headers.value(for: HTTPHeader.Constant.contentType))
+                _ = headers.dictionary
+            }
+        }
+    }
+
+    func testPerformanceBuildAndLookupMultiMapHeaders() {
+        let common = commonHeaders()
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for _ in 0..<10_000 {
+                var headers: [String: Set<String>] = [:]
+                common.forEach { headers[$0.key.lowercased(), default: []].insert($0.value) }
+                XCTAssertNotNil(headers[HTTPHeader.Constant.contentType.lowercased()])
+                _ = headers.mapValues { $0.joined(separator: ",") }
+            }
+        }
+    }
+}
+
+private extension HTTPHeadersTests {
+
+    /// The headers every Verify request carries, plus a per-request one.
+    func commonHeaders() -> [HTTPHeader] {
+        [.accept("application/json"), .contentType("application/x-www-form-urlencoded"),
+         .acceptEncoding([.gzip]), .userAgent("OTPViaWhatsapp/1.0 (iPhone; iOS 17.0) TwilioVerify/2.2"),
+         .authorization(username: "token", password: "secret"), HTTPHeader(key: "X-Request-Id", value: UUID().uuidString)]
+    }
+}
@@ -0,0 +1,334 @@
+//
+//  LocalSyncStore.swift
+//  OTPViaWhatsappTests
+//
+
+import Foundation
+import TwilioSyncClient
+@testable import OTPViaWhatsapp
+
+/// In-memory Sync map that completes each request asynchronously after a fixed latency,
+/// standing in for a Twilsock round-trip. Mutations use optimistic concurrency like the
+/// service: a write that lost the race to another one re-runs its mutator.
+final class LocalSyncMap: SyncMapStore {
+    let sid: String
+    var failingKeys: Set<String> = []
+    /// Report a mutation whose mutator returned `nil` as a failure instead of success with the current value.
+    var failsAbortedMutations = false
+
+    private let latency: DispatchTimeInterval
+    private let queue = DispatchQueue(label: "LocalSyncMap")
+    private var items: [String: SyncData] = [:]
+    private var revisions: [String: Int] = [:]
+    private var dates: [String: Date] = [:]
+    private var inFlight = 0
+    private(set) var requestCount = 0
+    private(set) var maxConcurrentRequests = 0
+    private(set) var conflictCount = 0
+
+    init(sid: String = "MP00000000000000000000000000000000", latency: DispatchTimeInterval = .milliseconds(1)) {
+        self.sid = sid
+        self.latency = latency
+    }
+
+    var itemCount: Int {
+        queue.sync { items.count }
+    }
+
+    func item(forKey key: String) -> SyncData? {
+        queue.sync { items[key] }
+    }
+
+    /// Fills the map directly, without simulated round-trips.
+    func seed(_ items: [SyncItem]) {
+        queue.sync {
+            for item in items {
+                self.items[item.key] = item.data
+                dates[item.key] = item.dateUpdated
+                revisions[item.key, default: 0] += 1
+            }
+        }
+    }
+
+    func setItem(withKey key: String, data: SyncData, ttl: TWSDuration?, completion: @escaping (Error?) -> Void) {
+        request {
+            guard !self.failingKeys.contains(key) else {
+                return SyncStoreError.unknown
+            }
+            self.write(data, forKey: key)
+            return nil
+        } completion: { completion($0) }
+    }
+
+    func removeItem(withKey key: String, completion: @escaping (Error?) -> Void) {
+        request {
+            self.items[key] = nil
+            self.dates[key] = nil
+            self.revisions[key, default: 0] += 1
+            return nil
+        } completion: { completion($0) }
+    }
+
+    func mutateItem(withKey key: String, mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        queue.async {
+            self.attemptMutation(ofKey: key, mutator: mutator, completion: completion)
+        }
+    }
+
+    func queryItems(startingAt startKey: String?, pageSize: Int, completion: @escaping (Result<SyncMapPage, Error>) -> Void) {
+        queue.async {
+            self.requestCount += 1
+            let items = self.items.keys.filter { $0 >= startKey ?? "" }.sorted().map { key in
+                SyncItem(key: key, data: self.items[key] ?? [:], dateUpdated: self.dates[key])
+            }
+            let page = LocalSyncMapPage(map: self, items: items, range: 0..<min(pageSize, items.count))
+            self.queue.asyncAfter(deadline: .now() + self.latency) {
+                completion(.success(page))
+            }
+        }
+    }
+
+    fileprivate func deliver(_ page: LocalSyncMapPage, completion: @escaping (Result<SyncMapPage, Error>) -> Void) {
+        queue.async {
+            self.requestCount += 1
+            self.queue.asyncAfter(deadline: .now() + self.latency) {
+                completion(.success(page))
+            }
+        }
+    }
+
+    private func attemptMutation(ofKey key: String, mutator: @escaping SyncMutator,
+                                 completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        requestCount += 1
+        let revision = revisions[key, default: 0]
+        guard let data = mutator(items[key]) else {
+            return completion(failsAbortedMutations ? .failure(SyncStoreError.unknown) : .success(items[key]))
+        }
+        queue.asyncAfter(deadline: .now() + latency) {
+            guard self.revisions[key, default: 0] == revision else {
+                self.conflictCount += 1
+                return self.attemptMutation(ofKey: key, mutator: mutator, completion: completion)
+            }
+            self.write(data, forKey: key)
+            completion(.success(data))
+        }
+    }
+
+    private func write(_ data: SyncData, forKey key: String) {
+        items[key] = data
+        dates[key] = Date()
+        revisions[key, default: 0] += 1
+    }
+
+    private func request(_ apply: @escaping () -> Error?, completion: @escaping (Error?) -> Void) {
+        queue.async {
+            self.requestCount += 1
+            self.inFlight += 1
+            self.maxConcurrentRequests = max(self.maxConcurrentRequests, self.inFlight)
+            self.queue.asyncAfter(deadline: .now() + self.latency) {
+                self.inFlight -= 1
+                completion(apply())
+            }
+        }
+    }
+}
+
+/// Page over the items a `LocalSyncMap` held when the query started.
+struct LocalSyncMapPage: SyncMapPage {
+    fileprivate let map: LocalSyncMap
+    fileprivate let all: [SyncItem]
+    fileprivate let range: Range<Int>
+
+    fileprivate init(map: LocalSyncMap, items: [SyncItem], range: Range<Int>) {
+        self.map = map
+        all = items
+        self.range = range
+    }
+
+    var items: [SyncItem] {
+        Array(all[range])
+    }
+
+    var hasNextPage: Bool {
+        range.upperBound < all.count
+    }
+
+    func nextPage(completion: @escaping (Result<SyncMapPage, Error>) -> Void) {
+        let next = range.upperBound..<min(range.upperBound + range.count, all.count)
+        map.deliver(LocalSyncMapPage(map: map, items: all, range: next), completion: completion)
+    }
+}
+
+final class LocalSyncList: SyncListStore {
+    let sid = "ES00000000000000000000000000000000"
+
+    private let latency: DispatchTimeInterval
+    private let queue = DispatchQueue(label: "LocalSyncList")
+    private var items: [SyncData] = []
+    private(set) var requestCount = 0
+
+    init(latency: DispatchTimeInterval = .milliseconds(1)) {
+        self.latency = latency
+    }
+
+    /// Fills the list directly, without simulated round-trips.
+    func seed(_ items: [SyncData]) {
+        queue.sync { self.items.append(contentsOf: items) }
+    }
+
+    func addItem(withData data: SyncData, ttl: TWSDuration?, completion: @escaping (Result<TWSItemIndex, Error>) -> Void) {
+        queue.async {
+            self.items.append(data)
+            completion(.success(TWSItemIndex(self.items.count - 1)))
+        }
+    }
+
+    func queryItems(startingAt startIndex: TWSItemIndex?, pageSize: Int, completion: @escaping (Result<SyncListPage, Error>) -> Void) {
+        queue.async {
+            self.requestCount += 1
+            let lower = min(Int(startIndex ?? 0), self.items.count)
+            let upper = min(lower + pageSize, self.items.count)
+            let page = LocalSyncListPage(list: self, pageSize: pageSize, hasNextPage: upper < self.items.count, items: (lower..<upper).map {
+                SyncListItem(index: TWSItemIndex($0), data: self.items[$0], dateUpdated: nil)
+            })
+            self.queue.asyncAfter(deadline: .now() + self.latency) {
+                completion(.success(page))
+            }
+        }
+    }
+}
+
+struct LocalSyncListPage: SyncListPage {
+    let list: LocalSyncList
+    let pageSize: Int
+    let hasNextPage: Bool
+    let items: [SyncListItem]
+
+    func nextPage(completion: @escaping (Result<SyncListPage, Error>) -> Void) {
+        list.queryItems(startingAt: (items.last?.index ?? -1) + 1, pageSize: pageSize, completion: completion)
+    }
+}
+
+/// In-memory Sync document whose mutations complete after a fixed latency.
+final class LocalSyncDocument: SyncDocumentStore {
+    let sid = "ET00000000000000000000000000000000"
+
+    private let latency: DispatchTimeInterval
+    private let queue = DispatchQueue(label: "LocalSyncDocument")
+    private var value: SyncData?
+
+    init(latency: DispatchTimeInterval = .milliseconds(1)) {
+        self.latency = latency
+    }
+
+    var data: SyncData? {
+        queue.sync { value }
+    }
+
+    func mutateData(with mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        queue.asyncAfter(deadline: .now() + latency) {
+            guard let data = mutator(self.value) else {
+                return completion(.success(self.value))
+            }
+            self.value = data
+            completion(.success(data))
+        }
+    }
+}
+
+/// Shared downlink for the stand-ins: responses are transferred one after another at a fixed byte rate,
+/// so concurrent queries slow each other down like they do on one Twilsock connection.
+final class LocalSyncLink {
+    private let queue = DispatchQueue(label: "LocalSyncLink")
+    private let bytesPerSecond: Double
+
+    init(bytesPerSecond: Double) {
+        self.bytesPerSecond = bytesPerSecond
+    }
+
+    func transfer(bytes: Int, completion: @escaping () -> Void) {
+        queue.async {
+            Thread.sleep(forTimeInterval: Double(bytes) / self.bytesPerSecond)
+            completion()
+        }
+    }
+}
+
+/// `LocalSyncMap` whose query responses travel over a `LocalSyncLink`.
+final class LinkedSyncMap: SyncMapStore {
+    private let map: LocalSyncMap
+    private let link: LocalSyncLink
+
+    init(map: LocalSyncMap, link: LocalSyncLink) {
+        self.map = map
+        self.link = link
+    }
+
+    var sid: String {
+        map.sid
+    }
+
+    func setItem(withKey key: String, data: SyncData, ttl: TWSDuration?, completion: @escaping (Error?) -> Void) {
+        map.setItem(withKey: key, data: data, ttl: ttl, completion: completion)
+    }
+
+    func removeItem(withKey key: String, completion: @escaping (Error?) -> Void) {
+        map.removeItem(withKey: key, completion: completion)
+    }
+
+    func mutateItem(withKey key: String, mutator: @escaping SyncMutator, completion: @escaping (Result<SyncData?, Error>) -> Void) {
+        map.mutateItem(withKey: key, mutator: mutator, completion: completion)
+    }
+
+    func queryItems(startingAt startKey: String?, pageSize: Int, completion: @escaping (Result<SyncMapPage, Error>) -> Void) {
+        map.queryItems(startingAt: startKey, pageSize: pageSize) { [link] result in
+            let bytes = (try? result.get())?.items.reduce(0) { $0 + estimatedBytes(of: $1.data) } ?? 0
+            link.transfer(bytes: bytes) { completion(result) }
+        }
+    }
+}
+
+/// In-memory Sync stream. Publishes share one simulated connection: each costs `frameCost` of serialized
+/// send time and is acknowledged `latency` later. Publishes beyond `capacity` unacknowledged ones are
+/// rejected, like the service's rate limiting.
+final class LocalSyncStream: SyncStreamStore {
+    let sid = "TO00000000000000000000000000000000"
+    /// Called on the stream's queue with the unpacked messages of every acknowledged publish.
+    var onMessages: (([SyncData]) -> Void)?
+
+    private let latency: DispatchTimeInterval
+    private let frameCost: TimeInterval
+    private let capacity: Int
+    private let queue = DispatchQueue(label: "LocalSyncStream")
+    private let connection = DispatchQueue(label: "LocalSyncStream.connection")
+    private var inFlight = 0
+    private(set) var publishCount = 0
+    private(set) var rejectedCount = 0
+
+    init(latency: DispatchTimeInterval = .milliseconds(5), frameCost: TimeInterval = 0.000_2, capacity: Int = .max) {
+        self.latency = latency
+        self.frameCost = frameCost
+        self.capacity = capacity
+    }
+
+    func publishMessage(withData data: SyncData, completion: @escaping (Result<String, Error>) -> Void) {
+        queue.async {
+            self.publishCount += 1
+            guard self.inFlight < self.capacity else {
+                self.rejectedCount += 1
+                return self.queue.asyncAfter(deadline: .now() + self.latency) {
+                    completion(.failure(SyncStoreError.unknown))
+                }
+            }
+            self.inFlight += 1
+            self.connection.async {
+                Thread.sleep(forTimeInterval: self.frameCost)
+                self.queue.asyncAfter(deadline: .now() + self.latency) {
+                    self.inFlight -= 1
+                    self.onMessages?(SyncStreamPublisher.messages(in: data))
+                    completion(.success("TZ\(self.publishCount)"))
+                }
+            }
+        }
+    }
+}
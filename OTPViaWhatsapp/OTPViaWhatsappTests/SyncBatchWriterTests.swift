@@ -0,0 +1,89 @@
+//
+//  SyncBatchWriterTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+import TwilioSyncClient
+
+final class SyncBatchWriterTests: XCTestCase {
+
+    func testSetItemsReturnsResultPerItemInOrder() {
+        let map = LocalSyncMap()
+        map.failingKeys = ["session-3"]
+        let writer = SyncBatchWriter(limits: SyncBatchLimits(maxChunkItems: 4, maxInFlight: 2), callbackQueue: .global())
+        let items = (0..<10).map { (key: "session-\($0)", data: ["attempts": $0] as SyncData) }
+        let done = expectation(description: "batch")
+
+        writer.setItems(items, in: map) { results in
+            XCTAssertEqual(results.count, 10)
+            XCTAssertNil(try? results[3].get())
+            XCTAssertEqual(results.filter { (try? $0.get()) != nil }.count, 9)
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 5)
+
+        XCTAssertEqual(map.itemCount, 9)
+        XCTAssertLessThanOrEqual(map.maxConcurrentRequests, 2)
+    }
+
+    func testOversizedItemFailsWithoutRequest() {
+        let map = LocalSyncMap()
+        let writer = SyncBatchWriter(limits: SyncBatchLimits(maxItemBytes: 64), callbackQueue: .global())
+        let done = expectation(description: "batch")
+
+        writer.setItems([(key: "small", data: ["code": "123456"]),
+                         (key: "large", data: ["code": String(repeating: "9", count: 128)])], in: map) { results in
+            XCTAssertNotNil(try? results[0].get())
+            guard case .failure(SyncBatchError.itemTooLarge(position: 1, _)) = results[1] else {
+                return XCTFail("Expected the oversized item to fail locally")
+            }
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 5)
+
+        XCTAssertEqual(map.requestCount, 1)
+    }
+
+    func testRemoveAndAddItems() {
+        let map = LocalSyncMap()
+        let list = LocalSyncList()
+        let writer = SyncBatchWriter(callbackQueue: .global())
+        let done = expectation(description: "batch")
+        done.expectedFulfillmentCount = 3
+
+        writer.setItems([(key: "a", data: [:]), (key: "b", data: [:])], in: map) { _ in
+            writer.removeItems(withKeys: ["a", "b"], from: map) { results in
+                XCTAssertEqual(results.count, 2)
+                XCTAssertEqual(map.itemCount, 0)
+                done.fulfill()
+            }
+            done.fulfill()
+        }
+        writer.addItems([["to": "+15550100"], ["to": "+15550101"]], to: list) { results in
+            XCTAssertEqual(results.compactMap { try? $0.get() }, [0, 1])
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 5)
+    }
+
+    func testInfiniteTTLIsSentWithoutMetadata() {
+        XCTAssertNil(itemTtl(nil))
+        XCTAssertNil(itemTtl(TWSDurationInfinity))
+        XCTAssertEqual(itemTtl(300), 300)
+    }
+
+    func testPerformanceBatchWriteTenThousandItems() {
+        let items = (0..<10_000).map { (key: "session-\($0)", data: ["phone": "+1555\($0)", "attempts": 1] as SyncData) }
+        let writer = SyncBatchWriter(callbackQueue: .global())
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let map = LocalSyncMap(latency: .microseconds(500))
+            let done = expectation(description: "batch")
+            writer.setItems(items, in: map) { _ in done.fulfill() }
+            wait(for: [done], timeout: 60)
+            XCTAssertNotNil(map.item(forKey: "session-9999"))
+        }
+    }
+}
@@ -0,0 +1,124 @@
+//
+//  SyncBulkOpenerTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncBulkOpenerTests: XCTestCase {
+
+    func testResultsComeBackInRequestOrderAndFailuresStayLocal() {
+        let server = LocalOpenServer(failing: ["missing"])
+        let opener = SyncBulkOpener<String, String>(callbackQueue: .global(), open: server.open)
+        let done = expectation(description: "opened")
+        var reported: [Int] = []
+        var results: [Result<String, Error>] = []
+        let lock = NSLock()
+
+        opener.open(["otp-sessions", "missing", "devices"], onOpen: { position, _ in
+            lock.lock()
+            reported.append(position)
+            lock.unlock()
+        }, completion: {
+            results = $0
+            done.fulfill()
+        })
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(results.map { try? $0.get() }, ["MP-otp-sessions", nil, "MP-devices"])
+        lock.lock()
+        XCTAssertEqual(Set(reported), [0, 1, 2])
+        lock.unlock()
+    }
+
+    func testConcurrentOpensAreBounded() {
+        let server = LocalOpenServer()
+        let opener = SyncBulkOpener<String, String>(options: .init(maxConcurrentOpens: 4), callbackQueue: .global(), open: server.open)
+        let done = expectation(description: "opened")
+
+        opener.open((0..<20).map { "entity-\($0)" }) { results in
+            XCTAssertEqual(results.count, 20)
+            done.fulfill()
+        }
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(server.maxConcurrentOpens, 4)
+    }
+
+    func testEmptyRequestListCompletes() {
+        let opener = SyncBulkOpener<String, String>(callbackQueue: .global(), open: LocalOpenServer().open)
+        let done = expectation(description: "opened")
+
+        opener.open([]) { results in
+            XCTAssertTrue(results.isEmpty)
+            done.fulfill()
+        }
+        waitForExpectations(timeout: 1)
+    }
+
+    func testPerformanceOpenFiftyEntitiesOneAfterAnother() {
+        let names = (0..<50).map { "entity-\($0)" }
+
+        measure(metrics: [XCTClockMetric()]) {
+            let server = LocalOpenServer()
+            let done = expectation(description: "opened")
+            func openNext(_ remaining: ArraySlice<String>) {
+                guard let name = remaining.first else {
+                    return done.fulfill()
+                }
+                server.open(name) { _ in openNext(remaining.dropFirst()) }
+            }
+            openNext(names[...])
+            wait(for: [done], timeout: 30)
+        }
+    }
+
+    func testPerformanceOpenFiftyEntitiesInBulk() {
+        let names = (0..<50).map { "entity-\($0)" }
+
+        measure(metrics: [XCTClockMetric()]) {
+            let server = LocalOpenServer()
+            let opener = SyncBulkOpener<String, String>(callbackQueue: .global(), open: server.open)
+            let done = expectation(description: "opened")
+            opener.open(names) { _ in done.fulfill() }
+            wait(for: [done], timeout: 30)
+        }
+    }
+}
+
+/// Stands in for the Sync subscription handshake: every open sends one frame over a shared connection
+/// (`frameCost` each, one at a time) and is answered one `latency` later.
+private final class LocalOpenServer {
+    private let failing: Set<String>
+    private let latency: DispatchTimeInterval
+    private let frameCost: TimeInterval
+    private let queue = DispatchQueue(label: "LocalOpenServer")
+    private let connection = DispatchQueue(label: "LocalOpenServer.connection")
+    private var inFlight = 0
+    private var maxInFlight = 0
+
+    init(failing: Set<String> = [], latency: DispatchTimeInterval = .milliseconds(20), frameCost: TimeInterval = 0.000_2) {
+        self.failing = failing
+        self.latency = latency
+        self.frameCost = frameCost
+    }
+
+    var maxConcurrentOpens: Int {
+        queue.sync { maxInFlight }
+    }
+
+    func open(_ name: String, completion: @escaping (Result<String, Error>) -> Void) {
+        queue.async {
+            self.inFlight += 1
+            self.maxInFlight = max(self.maxInFlight, self.inFlight)
+        }
+        connection.async {
+            Thread.sleep(forTimeInterval: self.frameCost)
+            self.queue.asyncAfter(deadline: .now() + self.latency) {
+                self.inFlight -= 1
+                completion(self.failing.contains(name) ? .failure(SyncStoreError.unknown) : .success("MP-\(name)"))
+            }
+        }
+    }
+}
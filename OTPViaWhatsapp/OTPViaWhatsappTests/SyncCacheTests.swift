@@ -0,0 +1,139 @@
+//
+//  SyncCacheTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncCacheTests: XCTestCase {
+
+    private var directory: URL!
+    private var cache: SyncCache!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        cache = SyncCache(directory: directory)
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    func testStoredItemsAreServedFromSnapshot() throws {
+        let date = Date(timeIntervalSince1970: 1_700_000_000)
+        try cache.store([SyncItem(key: "+15550100", data: ["code": "123456", "attempts": 2], dateUpdated: date),
+                         SyncItem(key: "+15550101", data: ["code": "654321"], dateUpdated: nil)], forEntity: "otp-sessions")
+
+        let snapshot = try XCTUnwrap(cache.snapshot(forEntity: "otp-sessions"))
+
+        XCTAssertEqual(snapshot.count, 2)
+        XCTAssertEqual(snapshot.first?.key, "+15550100")
+        XCTAssertEqual(snapshot.first?.dateUpdated, date)
+        XCTAssertEqual(snapshot.item(forKey: "+15550101")?.data["code"] as? String, "654321")
+        XCTAssertNil(snapshot.item(forKey: "+15550101")?.dateUpdated)
+        XCTAssertNil(snapshot.item(forKey: "+15550102"))
+    }
+
+    func testTruncatedFileIsDiscarded() throws {
+        try cache.store([SyncItem(key: "a", data: ["value": 1], dateUpdated: nil)], forEntity: "map")
+        let url = try XCTUnwrap(FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil).first)
+        let stored = try Data(contentsOf: url)
+
+        for cut in [3, stored.count - 1] {
+            try stored.prefix(cut).write(to: url)
+            XCTAssertNil(try cache.snapshot(forEntity: "map"), "cut at \(cut)")
+            XCTAssertFalse(FileManager.default.fileExists(atPath: url.path))
+        }
+    }
+
+    func testMissingFileHasNoSnapshot() throws {
+        XCTAssertNil(try cache.snapshot(forEntity: "map"))
+    }
+
+    func testUnreadableFileIsLeftUntouched() throws {
+        try cache.store([SyncItem(key: "a", data: ["value": 1], dateUpdated: nil)], forEntity: "map")
+        let url = try XCTUnwrap(FileManager.default.contentsOfDirectory(at: directory, includingPropertiesForKeys: nil).first)
+        let contents = try Data(contentsOf: url)
+        try FileManager.default.setAttributes([.posixPermissions: 0o000], ofItemAtPath: url.path)
+
+        XCTAssertThrowsError(try cache.snapshot(forEntity: "map"))
+        try FileManager.default.setAttributes([.posixPermissions: 0o600], ofItemAtPath: url.path)
+        XCTAssertEqual(try Data(contentsOf: url), contents)
+        XCTAssertEqual(try cache.snapshot(forEntity: "map")?.count, 1)
+    }
+
+    func testConcurrentFirstReadsShareOneIndex() throws {
+        let items = (0..<1_000).map { SyncItem(key: "+1555\($0)", data: ["code": "\($0)"], dateUpdated: nil) }
+        try cache.store(items, forEntity: "otp-sessions")
+        let snapshot = try XCTUnwrap(cache.snapshot(forEntity: "otp-sessions"))
+
+        DispatchQueue.concurrentPerform(iterations: 64) { index in
+            let key = "+1555\(index * 15)"
+            XCTAssertEqual(snapshot.item(forKey: key)?.data["code"] as? String, "\(index * 15)")
+        }
+    }
+
+    func testReconcileReportsChangesAndRewritesSnapshot() throws {
+        let date = Date(timeIntervalSince1970: 1_700_000_000)
+        try cache.store([SyncItem(key: "kept", data: [:], dateUpdated: date),
+                         SyncItem(key: "changed", data: [:], dateUpdated: date),
+                         SyncItem(key: "gone", data: [:], dateUpdated: date)], forEntity: "map")
+        let map = LocalSyncMap()
+        map.seed([SyncItem(key: "kept", data: [:], dateUpdated: date),
+                  SyncItem(key: "changed", data: ["v": 2], dateUpdated: date.addingTimeInterval(1)),
+                  SyncItem(key: "new", data: [:], dateUpdated: date)])
+        let done = expectation(description: "reconcile")
+
+        cache.reconcile(map, entity: "map", pageSize: 2) { result in
+            let changes = try? result.get()
+            XCTAssertEqual(changes?.added.map(\.key), ["new"])
+            XCTAssertEqual(changes?.updated.map(\.key), ["changed"])
+            XCTAssertEqual(changes?.removed, ["gone"])
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 5)
+
+        XCTAssertEqual(try cache.snapshot(forEntity: "map")?.revisions().keys.sorted(), ["changed", "kept", "new"])
+    }
+
+    func testUnchangedListItemsWithoutDateUpdatedAreNotReportedAgain() throws {
+        let list = LocalSyncList()
+        list.seed([["code": "123456", "attempts": 1], ["code": "654321"]])
+        XCTAssertEqual(try reconcile(list).added.count, 2)
+        XCTAssertTrue(try reconcile(list).isEmpty)
+
+        list.seed([["code": "111111"]])
+        let changes = try reconcile(list)
+
+        XCTAssertEqual(changes.added.map(\.key), ["2"])
+        XCTAssertTrue(changes.updated.isEmpty)
+        XCTAssertEqual(try cache.snapshot(forEntity: "list")?.item(forKey: "0")?.data["code"] as? String, "123456")
+    }
+
+    func testPerformanceTimeToFirstItemFiftyThousandItems() throws {
+        let items = (0..<50_000).map {
+            SyncItem(key: "+1555\($0)", data: ["code": "\($0 % 1_000_000)", "attempts": $0 % 5], dateUpdated: Date())
+        }
+        try cache.store(items, forEntity: "otp-sessions")
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            XCTAssertNotNil(try cache.snapshot(forEntity: "otp-sessions")?.first)
+        }
+    }
+}
+
+private extension SyncCacheTests {
+
+    func reconcile(_ list: SyncListStore) throws -> SyncCacheChanges {
+        var result: Result<SyncCacheChanges, Error>?
+        let done = expectation(description: "reconcile")
+        cache.reconcile(list, entity: "list") {
+            XCTAssertTrue(Thread.isMainThread)
+            result = $0
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 5)
+        return try XCTUnwrap(result).get()
+    }
+}
@@ -0,0 +1,269 @@
+//
+//  SyncEntityExecutorTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+import TwilioSyncClient
+@testable import OTPViaWhatsapp
+
+final class SyncEntityExecutorTests: XCTestCase {
+
+    func testEventsOfOneEntityKeepTheirOrder() {
+        let executor = SyncEntityExecutor()
+        let done = expectation(description: "delivered")
+        done.expectedFulfillmentCount = 4
+        let lock = NSLock()
+        var delivered: [String: [Int]] = [:]
+
+        for entity in ["MP1", "MP2", "MP3", "MP4"] {
+            for index in 0..<500 {
+                executor.async(entity: entity) {
+                    lock.lock()
+                    delivered[entity, default: []].append(index)
+                    lock.unlock()
+                    if index == 499 {
+                        done.fulfill()
+                    }
+                }
+            }
+        }
+        waitForExpectations(timeout: 5)
+
+        lock.lock()
+        XCTAssertEqual(delivered.count, 4)
+        delivered.values.forEach { XCTAssertEqual($0, Array(0..<500)) }
+        lock.unlock()
+    }
+
+    func testSlowHandlerDoesNotHoldUpOtherEntities() {
+        let executor = SyncEntityExecutor()
+        let fast = expectation(description: "fast entity delivered")
+        let start = DispatchTime.now()
+        var elapsed: UInt64 = 0
+
+        executor.async(entity: "slow") { Thread.sleep(forTimeInterval: 0.5) }
+        executor.async(entity: "fast") {
+            elapsed = DispatchTime.now().uptimeNanoseconds - start.uptimeNanoseconds
+            fast.fulfill()
+        }
+        waitForExpectations(timeout: 5)
+
+        XCTAssertLessThan(elapsed, 250_000_000)
+    }
+
+    func testPinnedEntityRunsOnItsQueue() {
+        let executor = SyncEntityExecutor()
+        let pinned = DispatchQueue(label: "pinned")
+        let key = DispatchSpecificKey<Bool>()
+        pinned.setSpecific(key: key, value: true)
+        let done = expectation(description: "delivered")
+
+        executor.setQueue(pinned, forEntity: "ui")
+        executor.async(entity: "ui") {
+            XCTAssertEqual(DispatchQueue.getSpecific(key: key), true)
+            done.fulfill()
+        }
+        waitForExpectations(timeout: 1)
+    }
+
+    func testMapEventsAreForwardedOnTheMapsQueue() {
+        let map = StubMap()
+        let (executor, recorder) = pinnedRecorder(forEntity: map.sid, expectedEvents: 6)
+        let wrapper = SyncExecutingMapDelegate(delegate: recorder, executor: executor)
+        let context = TWSEventContext()
+
+        wrapper.onMapOpened(map)
+        wrapper.onMap(map, itemAdded: TWSMapItem(), eventContext: context)
+        wrapper.onMap(map, itemUpdated: TWSMapItem(), previousItemData: [:], eventContext: context)
+        wrapper.onMap(map, itemRemovedWithKey: "+15550100", previousItemData: [:], eventContext: context)
+        wrapper.onMapCollectionRemoved(map, eventContext: context)
+        wrapper.onMap(map, errorOccurred: TWSError(domain: "sync", code: 1))
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.events, ["opened", "added", "updated", "removed", "collectionRemoved", "error"])
+    }
+
+    func testListEventsAreForwardedOnTheListsQueue() {
+        let list = StubList()
+        let (executor, recorder) = pinnedRecorder(forEntity: list.sid, expectedEvents: 6)
+        let wrapper = SyncExecutingListDelegate(delegate: recorder, executor: executor)
+        let context = TWSEventContext()
+
+        wrapper.onListOpened(list)
+        wrapper.onList(list, itemAdded: TWSListItem(), eventContext: context)
+        wrapper.onList(list, itemUpdated: TWSListItem(), previousItemData: [:], eventContext: context)
+        wrapper.onList(list, itemRemovedWithIndex: 0, previousItemData: [:], eventContext: context)
+        wrapper.onList(list, collectionRemovedWith: context)
+        wrapper.onList(list, errorOccurred: TWSError(domain: "sync", code: 1))
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.events, ["opened", "added", "updated", "removed", "collectionRemoved", "error"])
+    }
+
+    func testDocumentEventsAreForwardedOnTheDocumentsQueue() {
+        let document = StubDocument()
+        let (executor, recorder) = pinnedRecorder(forEntity: document.sid, expectedEvents: 4)
+        let wrapper = SyncExecutingDocumentDelegate(delegate: recorder, executor: executor)
+        let context = TWSEventContext()
+
+        wrapper.onDocumentOpened(document)
+        wrapper.onDocument(document, updated: ["sends": 1], previousData: [:], eventContext: context)
+        wrapper.onDocumentRemoved(document, previousData: ["sends": 1], eventContext: context)
+        wrapper.onDocument(document, errorOccurred: TWSError(domain: "sync", code: 1))
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.events, ["opened", "updated", "removed", "error"])
+    }
+
+    func testStreamEventsAreForwardedOnTheStreamsQueue() {
+        let stream = StubStream()
+        let (executor, recorder) = pinnedRecorder(forEntity: stream.sid, expectedEvents: 4)
+        let wrapper = SyncExecutingStreamDelegate(delegate: recorder, executor: executor)
+        let context = TWSEventContext()
+
+        wrapper.onStreamOpened(stream)
+        wrapper.onStream(stream, messagePublished: TWSStreamMessage(), eventContext: context)
+        wrapper.onStream(stream, removedWith: context)
+        wrapper.onStream(stream, errorOccurred: TWSError(domain: "sync", code: 1))
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.events, ["opened", "published", "removed", "error"])
+    }
+
+    /// The wrappers only move delegate events: work queued on the client queue after an event, such as an
+    /// operation completion, runs there while the entity's handler is still busy.
+    func testBusyHandlerDoesNotHoldUpTheClientQueue() {
+        let map = StubMap()
+        let client = DispatchQueue(label: "client")
+        let clientKey = DispatchSpecificKey<Bool>()
+        client.setSpecific(key: clientKey, value: true)
+        let (executor, recorder) = pinnedRecorder(forEntity: map.sid, expectedEvents: 1)
+        let release = DispatchSemaphore(value: 0)
+        recorder.onEvent = { _ = release.wait(timeout: .now() + 5) }
+        let wrapper = SyncExecutingMapDelegate(delegate: recorder, executor: executor)
+        let completed = expectation(description: "completion ran on the client queue")
+
+        client.async {
+            wrapper.onMapOpened(map)
+            client.async {
+                XCTAssertEqual(DispatchQueue.getSpecific(key: clientKey), true)
+                XCTAssertEqual(recorder.events, [])
+                completed.fulfill()
+                release.signal()
+            }
+        }
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.events, ["opened"])
+    }
+
+    func testPerformanceDeliveryWithSlowHandlerOnSharedQueue() {
+        let shared = DispatchQueue(label: "shared")
+        measureDeliveryWithSlowHandler { _, work in shared.async(execute: work) }
+    }
+
+    func testPerformanceDeliveryWithSlowHandlerOnEntityExecutor() {
+        let executor = SyncEntityExecutor()
+        measureDeliveryWithSlowHandler(dispatch: executor.async)
+    }
+}
+
+private extension SyncEntityExecutorTests {
+
+    /// Interleaves events for one entity whose handler takes 5 ms with events for fifteen fast entities,
+    /// and waits until the fast entities have seen all of theirs.
+    func measureDeliveryWithSlowHandler(dispatch: @escaping (String, @escaping () -> Void) -> Void) {
+        measure(metrics: [XCTClockMetric()]) {
+            let done = expectation(description: "fast entities delivered")
+            done.expectedFulfillmentCount = 15 * 20
+            for _ in 0..<20 {
+                dispatch("slow") { Thread.sleep(forTimeInterval: 0.005) }
+                for entity in 0..<15 {
+                    dispatch("fast-\(entity)") { done.fulfill() }
+                }
+            }
+            wait(for: [done], timeout: 30)
+        }
+    }
+
+    /// An executor with `entity` pinned to a queue of its own, and a recorder that checks every event arrives there.
+    func pinnedRecorder(forEntity entity: String, expectedEvents: Int) -> (SyncEntityExecutor, EventRecorder) {
+        let executor = SyncEntityExecutor()
+        let queue = DispatchQueue(label: "entity")
+        executor.setQueue(queue, forEntity: entity)
+        let delivered = expectation(description: "events of \(entity)")
+        delivered.expectedFulfillmentCount = expectedEvents
+        return (executor, EventRecorder(queue: queue, expectation: delivered))
+    }
+}
+
+private final class StubMap: TWSMap {
+    override var sid: String { "MP00000000000000000000000000000001" }
+}
+
+private final class StubList: TWSList {
+    override var sid: String { "ES00000000000000000000000000000001" }
+}
+
+private final class StubDocument: TWSDocument {
+    override var sid: String { "ET00000000000000000000000000000001" }
+}
+
+private final class StubStream: TWSStream {
+    override var sid: String { "TO00000000000000000000000000000001" }
+}
+
+/// Records the events of every entity type, asserting each one arrives on `queue`.
+private final class EventRecorder: NSObject, TWSMapDelegate, TWSListDelegate, TWSDocumentDelegate, TWSStreamDelegate {
+    var onEvent: (() -> Void)?
+
+    private let key = DispatchSpecificKey<Bool>()
+    private let expectation: XCTestExpectation
+    private let lock = NSLock()
+    private var recorded: [String] = []
+
+    init(queue: DispatchQueue, expectation: XCTestExpectation) {
+        self.expectation = expectation
+        queue.setSpecific(key: key, value: true)
+    }
+
+    var events: [String] {
+        lock.lock()
+        defer { lock.unlock() }
+        return recorded
+    }
+
+    func onMapOpened(_ map: TWSMap) { record("opened") }
+    func onMap(_ map: TWSMap, itemAdded item: TWSMapItem, eventContext: TWSEventContext) { record("added") }
+    func onMap(_ map: TWSMap, itemUpdated item: TWSMapItem, previousItemData: [String: Any], eventContext: TWSEventContext) { record("updated") }
+    func onMap(_ map: TWSMap, itemRemovedWithKey itemKey: String, previousItemData: [String: Any], eventContext: TWSEventContext) { record("removed") }
+    func onMapCollectionRemoved(_ map: TWSMap, eventContext: TWSEventContext) { record("collectionRemoved") }
+    func onMap(_ map: TWSMap, errorOccurred error: TWSError) { record("error") }
+
+    func onListOpened(_ list: TWSList) { record("opened") }
+    func onList(_ list: TWSList, itemAdded item: TWSListItem, eventContext: TWSEventContext) { record("added") }
+    func onList(_ list: TWSList, itemUpdated item: TWSListItem, previousItemData: [String: Any], eventContext: TWSEventContext) { record("updated") }
+    func onList(_ list: TWSList, itemRemovedWithIndex itemIndex: TWSItemIndex, previousItemData: [String: Any], eventContext: TWSEventContext) { record("removed") }
+    func onList(_ list: TWSList, collectionRemovedWith eventContext: TWSEventContext) { record("collectionRemoved") }
+    func onList(_ list: TWSList, errorOccurred error: TWSError) { record("error") }
+
+    func onDocumentOpened(_ document: TWSDocument) { record("opened") }
+    func onDocument(_ document: TWSDocument, updated data: [String: Any], previousData: [String: Any], eventContext: TWSEventContext) { record("updated") }
+    func onDocumentRemoved(_ document: TWSDocument, previousData: [String: Any], eventContext: TWSEventContext) { record("removed") }
+    func onDocument(_ document: TWSDocument, errorOccurred error: TWSError) { record("error") }
+
+    func onStreamOpened(_ stream: TWSStream) { record("opened") }
+    func onStream(_ stream: TWSStream, messagePublished message: TWSStreamMessage, eventContext: TWSEventContext) { record("published") }
+    func onStream(_ stream: TWSStream, removedWith eventContext: TWSEventContext) { record("removed") }
+    func onStream(_ stream: TWSStream, errorOccurred error: TWSError) { record("error") }
+
+    private func record(_ event: String) {
+        XCTAssertEqual(DispatchQueue.getSpecific(key: key), true, "\(event) was not delivered on the entity's queue")
+        onEvent?()
+        lock.lock()
+        recorded.append(event)
+        lock.unlock()
+        expectation.fulfill()
+    }
+}
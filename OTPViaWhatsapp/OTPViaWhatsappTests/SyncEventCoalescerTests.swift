@@ -0,0 +1,224 @@
+//
+//  SyncEventCoalescerTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncEventCoalescerTests: XCTestCase {
+
+    func testEventsForTheSameKeyKeepOnlyTheLatestVersion() {
+        let coalescer = SyncEventCoalescer(options: .init(window: .milliseconds(20), maxPendingKeys: 100))
+        let recorder = BatchRecorder(expectation: expectation(description: "batch"))
+        coalescer.delegate = recorder
+
+        for attempt in 0..<10 {
+            coalescer.ingest(change(key: "+15550100", attempt: attempt))
+        }
+        coalescer.ingest(change(key: "+15550101", attempt: 0))
+        coalescer.ingest(SyncItemChange(entitySid: "MP1", key: "+15550101", kind: .removed, isLocal: false))
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.batches.count, 1)
+        XCTAssertEqual(recorder.batches.first?.map(\.key), ["+15550100", "+15550101"])
+        guard case .upserted(let data) = recorder.batches.first?.first?.kind, case .removed = recorder.batches.first?.last?.kind else {
+            return XCTFail("Unexpected change kinds")
+        }
+        XCTAssertEqual(data["attempt"] as? Int, 9)
+        XCTAssertEqual(coalescer.statistics.events, 12)
+        XCTAssertEqual(coalescer.statistics.delivered, 2)
+    }
+
+    func testCollectionRemovalReplacesThePendingChangesOfItsEntity() {
+        let coalescer = SyncEventCoalescer(options: .init(window: .milliseconds(20), maxPendingKeys: 100))
+        let recorder = BatchRecorder(expectation: expectation(description: "batch"))
+        coalescer.delegate = recorder
+
+        coalescer.ingest(change(key: "+15550100", attempt: 0))
+        coalescer.ingest(SyncItemChange(entitySid: "MP2", key: "+15550101", kind: .upserted(["attempt": 0]), isLocal: false))
+        coalescer.ingest(change(key: "+15550102", attempt: 0))
+        coalescer.ingest(SyncItemChange(entitySid: "MP1", key: "", kind: .collectionRemoved, isLocal: false))
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.batches.first?.map(\.entitySid), ["MP2", "MP1"])
+        guard case .collectionRemoved = recorder.batches.first?.last?.kind else {
+            return XCTFail("Unexpected change kind")
+        }
+    }
+
+    func testProducerWaitsWhileDeliveryIsBehind() {
+        let deliveryQueue = DispatchQueue(label: "delivery")
+        let coalescer = SyncEventCoalescer(options: .init(window: .seconds(10), maxPendingKeys: 10), deliveryQueue: deliveryQueue)
+        let recorder = BatchRecorder(expectation: nil, delay: 0.05)
+        coalescer.delegate = recorder
+        let produced = expectation(description: "produced")
+
+        DispatchQueue.global().async {
+            for index in 0..<30 {
+                coalescer.ingest(self.change(key: "key-\(index)", attempt: 0))
+            }
+            produced.fulfill()
+        }
+        wait(for: [produced], timeout: 5)
+
+        XCTAssertGreaterThan(coalescer.statistics.producerWaits, 0)
+        XCTAssertTrue(recorder.batches.allSatisfy { $0.count <= 10 })
+    }
+
+    func testEventsOnTheDeliveryQueueDoNotWait() {
+        let coalescer = SyncEventCoalescer(options: .init(window: .seconds(10), maxPendingKeys: 2))
+        let recorder = BatchRecorder(expectation: nil)
+        coalescer.delegate = recorder
+
+        for index in 0..<5 {
+            coalescer.ingest(change(key: "key-\(index)", attempt: 0))
+        }
+        let delivered = expectation(for: NSPredicate { _, _ in coalescer.statistics.delivered == 5 }, evaluatedWith: nil)
+        wait(for: [delivered], timeout: 5)
+
+        XCTAssertEqual(coalescer.statistics.overflows, 1)
+        XCTAssertEqual(coalescer.statistics.producerWaits, 0)
+    }
+
+    func testCoalescingKeepsTheDeliveryQueueMostlyIdleUnderASustainedStream() {
+        let perEvent = deliveryQueueLoad(coalesced: false)
+        let coalesced = deliveryQueueLoad(coalesced: true)
+        attach(perEvent, named: "Per-event delivery")
+        attach(coalesced, named: "Coalesced delivery")
+
+        XCTAssertLessThan(coalesced.busy, Constants.streamDuration * 0.05)
+        XCTAssertLessThan(coalesced.busy * 10, perEvent.busy)
+    }
+
+    func testPerformanceDeliveryQueueLoadPerEventDelivery() {
+        measure(metrics: [XCTCPUMetric()]) {
+            attach(deliveryQueueLoad(coalesced: false), named: "Per-event delivery")
+        }
+    }
+
+    func testPerformanceDeliveryQueueLoadCoalesced() {
+        measure(metrics: [XCTCPUMetric()]) {
+            attach(deliveryQueueLoad(coalesced: true), named: "Coalesced delivery")
+        }
+    }
+}
+
+private extension SyncEventCoalescerTests {
+
+    struct Constants {
+        static let eventsPerSecond = 10_000
+        static let streamDuration: TimeInterval = 1
+    }
+
+    func change(key: String, attempt: Int) -> SyncItemChange {
+        SyncItemChange(entitySid: "MP1", key: key, kind: .upserted(["attempt": attempt]), isLocal: false)
+    }
+
+    /// 10k updates spread over 500 OTP sessions.
+    func burst() -> [SyncItemChange] {
+        (0..<10_000).map { change(key: "+1555\($0 % 500)", attempt: $0) }
+    }
+
+    /// Streams `burst()` at `eventsPerSecond` to a serial queue standing in for main, one hop per event or
+    /// through a coalescer, and returns how long that queue spent handling the changes.
+    func deliveryQueueLoad(coalesced: Bool) -> DeliveryQueueLoad {
+        let deliveryQueue = DispatchQueue(label: "delivery")
+        let coalescer = SyncEventCoalescer(options: .init(window: .milliseconds(16)), deliveryQueue: deliveryQueue)
+        let recorder = LoadRecorder()
+        coalescer.delegate = recorder
+        let events = burst()
+        let start = DispatchTime.now().uptimeNanoseconds
+        for (index, change) in events.enumerated() {
+            let due = start + UInt64(index) * 1_000_000_000 / UInt64(Constants.eventsPerSecond)
+            let now = DispatchTime.now().uptimeNanoseconds
+            if due > now {
+                Thread.sleep(forTimeInterval: TimeInterval(due - now) / 1_000_000_000)
+            }
+            if coalesced {
+                coalescer.ingest(change)
+            } else {
+                deliveryQueue.async { recorder.eventCoalescer(coalescer, didReceive: [change]) }
+            }
+        }
+        let delivered = NSPredicate { _, _ in recorder.load.lastAttempt == events.count - 1 }
+        wait(for: [expectation(for: delivered, evaluatedWith: nil)], timeout: 5)
+        return recorder.load
+    }
+
+    func attach(_ load: DeliveryQueueLoad, named name: String) {
+        let attachment = XCTAttachment(string: "\(name): delivery queue busy \(Int(load.busy * 1_000)) ms in \(load.deliveries) deliveries")
+        attachment.lifetime = .keepAlways
+        add(attachment)
+    }
+}
+
+private struct DeliveryQueueLoad {
+    var busy: TimeInterval = 0
+    var deliveries = 0
+    var lastAttempt = -1
+}
+
+/// Delivery side that does `BatchRecorder.apply` plus a fixed cost per call, like a table update, and adds
+/// up the time spent in it.
+private final class LoadRecorder: SyncEventBatchDelegate {
+    private let lock = NSLock()
+    private var recorded = DeliveryQueueLoad()
+
+    var load: DeliveryQueueLoad {
+        lock.lock()
+        defer { lock.unlock() }
+        return recorded
+    }
+
+    func eventCoalescer(_ coalescer: SyncEventCoalescer, didReceive changes: [SyncItemChange]) {
+        let start = DispatchTime.now().uptimeNanoseconds
+        while DispatchTime.now().uptimeNanoseconds < start + 20_000 {}
+        BatchRecorder.apply(changes)
+        let attempts = changes.compactMap { change -> Int? in
+            guard case .upserted(let data) = change.kind else {
+                return nil
+            }
+            return data["attempt"] as? Int
+        }
+        let busy = TimeInterval(DispatchTime.now().uptimeNanoseconds - start) / 1_000_000_000
+        lock.lock()
+        recorded.busy += busy
+        recorded.deliveries += 1
+        recorded.lastAttempt = max(recorded.lastAttempt, attempts.max() ?? -1)
+        lock.unlock()
+    }
+}
+
+private final class BatchRecorder: SyncEventBatchDelegate {
+    private let lock = NSLock()
+    private let expectation: XCTestExpectation?
+    private let delay: TimeInterval
+    private var recorded: [[SyncItemChange]] = []
+
+    init(expectation: XCTestExpectation?, delay: TimeInterval = 0) {
+        self.expectation = expectation
+        self.delay = delay
+    }
+
+    var batches: [[SyncItemChange]] {
+        lock.lock()
+        defer { lock.unlock() }
+        return recorded
+    }
+
+    func eventCoalescer(_ coalescer: SyncEventCoalescer, didReceive changes: [SyncItemChange]) {
+        Thread.sleep(forTimeInterval: delay)
+        BatchRecorder.apply(changes)
+        lock.lock()
+        recorded.append(changes)
+        lock.unlock()
+        expectation?.fulfill()
+    }
+
+    /// Stand-in for the UI work a delegate does per change.
+    static func apply(_ changes: [SyncItemChange]) {
+        var phones = Set<String>()
+        changes.forEach { phones.insert($0.key) }
+    }
+}
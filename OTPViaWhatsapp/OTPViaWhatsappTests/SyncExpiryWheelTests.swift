@@ -0,0 +1,113 @@
+//
+//  SyncExpiryWheelTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncExpiryWheelTests: XCTestCase {
+
+    private let origin = Date(timeIntervalSince1970: 1_700_000_000)
+
+    func testItemExpiresOnTheTickOfItsDeadline() {
+        let wheel = SyncExpiryWheel(now: origin)
+
+        wheel.track(entity: "MP1", key: "+15550100", expiresAt: origin + 0.25)
+
+        XCTAssertFalse(wheel.isExpired(entity: "MP1", key: "+15550100", now: origin + 0.2))
+        XCTAssertTrue(wheel.isExpired(entity: "MP1", key: "+15550100", now: origin + 0.25))
+        XCTAssertTrue(wheel.advance(to: origin + 0.2).isEmpty)
+        let changes = wheel.advance(to: origin + 0.35)
+        XCTAssertEqual(changes.map(\.key), ["+15550100"])
+        XCTAssertEqual(changes.first?.isLocal, true)
+    }
+
+    func testDeadlinesAcrossAllLevelsExpireOnTime() {
+        let wheel = SyncExpiryWheel(options: .init(resolution: 1), now: origin)
+        var generator = SystemRandomNumberGenerator()
+        let deadlines = (0..<2_000).map { _ in TimeInterval(Int.random(in: 1...400_000, using: &generator)) + 0.5 }
+        deadlines.enumerated().forEach { wheel.track(entity: "MP1", key: "\($0.offset)", expiresAt: origin + $0.element) }
+
+        var expired = Set<String>()
+        for checkpoint in stride(from: 1_000.0, through: 401_000, by: 25_000) {
+            wheel.advance(to: origin + checkpoint).forEach { expired.insert($0.key) }
+            let due = Set(deadlines.enumerated().filter { $0.element <= checkpoint }.map { "\($0.offset)" })
+            XCTAssertEqual(expired, due)
+        }
+    }
+
+    func testRetrackingReplacesTheDeadlineAndUntrackingCancelsIt() {
+        let wheel = SyncExpiryWheel(now: origin)
+
+        wheel.track(entity: "MP1", key: "moved", expiresAt: origin + 1)
+        wheel.track(entity: "MP1", key: "moved", expiresAt: origin + 10)
+        wheel.track(entity: "MP1", key: "cancelled", expiresAt: origin + 1)
+        wheel.untrack(entity: "MP1", key: "cancelled")
+
+        XCTAssertTrue(wheel.advance(to: origin + 5).isEmpty)
+        XCTAssertEqual(wheel.advance(to: origin + 10.5).map(\.key), ["moved"])
+        XCTAssertEqual(wheel.statistics.tracked, 0)
+    }
+
+    func testServerEventsAreReconciledWithLocalExpiry() {
+        let wheel = SyncExpiryWheel(now: origin)
+        ["confirmed", "revived", "live"].forEach { wheel.track(entity: "MP1", key: $0, expiresAt: origin + ($0 == "live" ? 60 : 1)) }
+        _ = wheel.advance(to: origin + 2)
+
+        XCTAssertNil(wheel.reconcile(SyncItemChange(entitySid: "MP1", key: "confirmed", kind: .removed, isLocal: false)))
+        XCTAssertNotNil(wheel.reconcile(SyncItemChange(entitySid: "MP1", key: "revived", kind: .upserted(["code": "123456"]), isLocal: false)))
+        XCTAssertNotNil(wheel.reconcile(SyncItemChange(entitySid: "MP1", key: "live", kind: .removed, isLocal: false)))
+
+        XCTAssertFalse(wheel.isExpired(entity: "MP1", key: "revived", now: origin + 2))
+        XCTAssertTrue(wheel.advance(to: origin + 120).isEmpty)
+        XCTAssertEqual(wheel.statistics.confirmed, 1)
+        XCTAssertEqual(wheel.statistics.revived, 1)
+    }
+
+    func testCollectionRemovalUntracksItsItems() {
+        let wheel = SyncExpiryWheel(now: origin)
+        wheel.track(entity: "MP1", key: "+15550100", expiresAt: origin + 1)
+        wheel.track(entity: "MP2", key: "+15550101", expiresAt: origin + 1)
+
+        XCTAssertNotNil(wheel.reconcile(SyncItemChange(entitySid: "MP1", key: "", kind: .collectionRemoved, isLocal: false)))
+        XCTAssertEqual(wheel.advance(to: origin + 2).map(\.key), ["+15550101"])
+    }
+
+    func testTimerHandsExpiredItemsToTheDelegate() {
+        let wheel = SyncExpiryWheel(options: .init(resolution: 0.01), callbackQueue: .global())
+        let recorder = ExpiryRecorder(expectation: expectation(description: "expired"))
+        wheel.delegate = recorder
+
+        wheel.track(entity: "MP1", key: "+15550100", expiresAt: Date(timeIntervalSinceNow: 0.05))
+        wheel.start()
+        waitForExpectations(timeout: 5)
+        wheel.stop()
+
+        XCTAssertEqual(recorder.keys, ["+15550100"])
+    }
+
+    func testPerformanceTrackAndExpireOneMillionTTLs() {
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let wheel = SyncExpiryWheel(now: origin)
+            for index in 0..<1_000_000 {
+                wheel.track(entity: "MP1", key: "otp-\(index)", expiresAt: origin + TimeInterval(index % 6_000) / 10)
+            }
+            XCTAssertEqual(wheel.advance(to: origin + 601).count, 1_000_000)
+        }
+    }
+}
+
+private final class ExpiryRecorder: SyncExpiryDelegate {
+    private let expectation: XCTestExpectation
+    private(set) var keys: [String] = []
+
+    init(expectation: XCTestExpectation) {
+        self.expectation = expectation
+    }
+
+    func expiryWheel(_ wheel: SyncExpiryWheel, didExpire changes: [SyncItemChange]) {
+        keys += changes.map(\.key)
+        expectation.fulfill()
+    }
+}
@@ -0,0 +1,108 @@
+//
+//  SyncMapIndexTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncMapIndexTests: XCTestCase {
+
+    func testEqualityRangeAndPrefixLookups() {
+        let index = SyncMapIndex(entitySid: "MP1", fields: ["phone", "attempts"])
+        index.load([session("s1", phone: "+15550100", attempts: 1),
+                    session("s2", phone: "+15550100", attempts: 3),
+                    session("s3", phone: "+15550199", attempts: 2),
+                    session("s4", phone: "+4420700", attempts: 5),
+                    SyncItem(key: "s5", data: ["phone": ["not": "indexable"]], dateUpdated: nil)])
+
+        XCTAssertEqual(index.keys(where: "phone", equals: "+15550100"), ["s1", "s2"])
+        XCTAssertEqual(index.keys(where: "attempts", in: 2..<5), ["s3", "s2"])
+        XCTAssertEqual(index.keys(where: "attempts", in: 2...5), ["s3", "s2", "s4"])
+        XCTAssertEqual(index.keys(where: "phone", hasPrefix: "+1555"), ["s1", "s2", "s3"])
+        XCTAssertEqual(index.keys(where: "phone", hasPrefix: "+49"), [])
+        XCTAssertEqual(index.keys(where: "unknown", equals: 1), [])
+    }
+
+    func testItemChangesMoveAndRemoveEntries() {
+        let index = SyncMapIndex(entitySid: "MP1", fields: ["phone"])
+        index.load([session("s1", phone: "+15550100", attempts: 0), session("s2", phone: "+15550100", attempts: 0)])
+
+        index.apply([SyncItemChange(entitySid: "MP1", key: "s1", kind: .upserted(["phone": "+15550200"]), isLocal: false),
+                     SyncItemChange(entitySid: "MP1", key: "s2", kind: .removed, isLocal: false),
+                     SyncItemChange(entitySid: "MP1", key: "s3", kind: .upserted(["phone": "+15550100"]), isLocal: true),
+                     SyncItemChange(entitySid: "MP2", key: "s4", kind: .upserted(["phone": "+15550100"]), isLocal: false)])
+
+        XCTAssertEqual(index.keys(where: "phone", equals: "+15550100"), ["s3"])
+        XCTAssertEqual(index.keys(where: "phone", equals: "+15550200"), ["s1"])
+        XCTAssertEqual(index.count, 2)
+
+        index.apply([SyncItemChange(entitySid: "MP1", key: "", kind: .collectionRemoved, isLocal: false)])
+        XCTAssertEqual(index.keys(where: "phone", equals: "+15550200"), [])
+        XCTAssertEqual(index.count, 0)
+    }
+
+    func testIndexLoadsFromCacheSnapshot() throws {
+        let items = (0..<20).map { session("s\($0)", phone: "+1555\($0 % 4)", attempts: $0) }
+        let snapshot = try XCTUnwrap(SyncCacheSnapshot(entity: "MP1", storage: SyncCacheSnapshot.encode(items)))
+        let index = SyncMapIndex(entitySid: "MP1", fields: ["phone"])
+
+        index.load(snapshot)
+
+        XCTAssertEqual(index.keys(where: "phone", equals: "+15553"), ["s11", "s15", "s19", "s3", "s7"])
+    }
+
+    func testPerformanceFindSessionsByPhoneWithPaginatedScan() {
+        let map = LocalSyncMap()
+        map.seed(hundredThousandSessions())
+
+        measure(metrics: [XCTClockMetric()]) {
+            let done = expectation(description: "scanned")
+            var matches: [String] = []
+            scan(map, pageSize: 1_000, matching: "+15550042") { keys in
+                matches = keys
+                done.fulfill()
+            }
+            wait(for: [done], timeout: 60)
+            XCTAssertEqual(matches.count, 10)
+        }
+    }
+
+    func testPerformanceFindSessionsByPhoneWithIndex() {
+        let index = SyncMapIndex(entitySid: "MP1", fields: ["phone"])
+        index.load(hundredThousandSessions())
+
+        measure(metrics: [XCTClockMetric()]) {
+            for _ in 0..<1_000 {
+                XCTAssertEqual(index.keys(where: "phone", equals: "+15550042").count, 10)
+            }
+        }
+    }
+}
+
+private extension SyncMapIndexTests {
+
+    func session(_ key: String, phone: String, attempts: Int) -> SyncItem {
+        SyncItem(key: key, data: ["phone": phone, "attempts": attempts, "status": "pending"], dateUpdated: nil)
+    }
+
+    /// 100k sessions spread over 10k phone numbers.
+    func hundredThousandSessions() -> [SyncItem] {
+        (0..<100_000).map { session(String(format: "session-%06d", $0), phone: String(format: "+1555%04d", $0 % 10_000), attempts: $0 % 5) }
+    }
+
+    func scan(_ map: SyncMapStore, pageSize: Int, matching phone: String, completion: @escaping ([String]) -> Void) {
+        var matches: [String] = []
+        func collect(_ result: Result<SyncMapPage, Error>) {
+            guard let page = try? result.get() else {
+                return completion(matches)
+            }
+            matches += page.items.filter { $0.data["phone"] as? String == phone }.map(\.key)
+            guard page.hasNextPage else {
+                return completion(matches)
+            }
+            page.nextPage(completion: collect)
+        }
+        map.queryItems(startingAt: nil, pageSize: pageSize, completion: collect)
+    }
+}
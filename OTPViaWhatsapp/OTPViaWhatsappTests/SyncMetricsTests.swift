@@ -0,0 +1,157 @@
+//
+//  SyncMetricsTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+import TwilioSyncClient
+@testable import OTPViaWhatsapp
+
+final class SyncMetricsTests: XCTestCase {
+
+    func testHistogramPercentilesStayWithinBucketPrecision() {
+        let histogram = SyncHistogram()
+
+        (1...10_000).forEach(histogram.record)
+        let snapshot = histogram.snapshot
+
+        XCTAssertEqual(snapshot.count, 10_000)
+        XCTAssertEqual(snapshot.min, 1)
+        XCTAssertEqual(snapshot.max, 10_000)
+        XCTAssertEqual(snapshot.mean, 5_000.5, accuracy: 0.01)
+        XCTAssertEqual(snapshot.value(atPercentile: 0), 1)
+        XCTAssertEqual(Double(snapshot.value(atPercentile: 0.5)), 5_000, accuracy: 5_000 * 0.04)
+        XCTAssertEqual(Double(snapshot.value(atPercentile: 0.99)), 9_900, accuracy: 9_900 * 0.04)
+        XCTAssertEqual(snapshot.value(atPercentile: 1), 10_000)
+    }
+
+    func testMeasuredMapRecordsLatencyBytesAndErrors() {
+        let map = LocalSyncMap()
+        map.failingKeys = ["broken"]
+        let metrics = SyncMetrics()
+        let measured = SyncMeasuredMap(map, metrics: metrics, countsBytes: true)
+        let done = expectation(description: "written")
+        done.expectedFulfillmentCount = 2
+
+        measured.setItem(withKey: "+15550100", data: ["code": "123456"], ttl: nil) { _ in done.fulfill() }
+        measured.setItem(withKey: "broken", data: ["code": "654321"], ttl: nil) { _ in done.fulfill() }
+        waitForExpectations(timeout: 5)
+        let snapshot = metrics.snapshot()
+
+        XCTAssertEqual(snapshot.histograms[SyncMetrics.Name.latency(of: "map.set")]?.count, 2)
+        XCTAssertGreaterThanOrEqual(snapshot.histograms[SyncMetrics.Name.latency(of: "map.set")]?.min ?? 0, 1_000)
+        XCTAssertEqual(snapshot.counters[SyncMetrics.Name.bytesOut], 2 * estimatedBytes(of: ["code": "123456"]))
+        XCTAssertEqual(snapshot.counters[SyncMetrics.Name.errors], 1)
+    }
+
+    func testMeasuredListDocumentAndStreamRecordTheirOwnLatencies() {
+        let metrics = SyncMetrics()
+        let list = SyncMeasuredList(LocalSyncList(), metrics: metrics, countsBytes: true)
+        let document = SyncMeasuredDocument(LocalSyncDocument(), metrics: metrics, countsBytes: true)
+        let stream = SyncMeasuredStream(LocalSyncStream(latency: .milliseconds(1), capacity: 0), metrics: metrics)
+        let done = expectation(description: "operations")
+        done.expectedFulfillmentCount = 4
+
+        list.addItem(withData: ["code": "123456"], ttl: nil) { _ in done.fulfill() }
+        list.queryItems(startingAt: nil, pageSize: 10) { _ in done.fulfill() }
+        document.mutateData(with: { _ in ["sends": 1] }) { _ in done.fulfill() }
+        stream.publishMessage(withData: ["code": "123456"]) { _ in done.fulfill() }
+        waitForExpectations(timeout: 5)
+        let snapshot = metrics.snapshot()
+
+        ["list.add", "list.query", "document.mutate", "stream.publish"].forEach { operation in
+            XCTAssertEqual(snapshot.histograms[SyncMetrics.Name.latency(of: operation)]?.count, 1, operation)
+        }
+        XCTAssertEqual(snapshot.counters[SyncMetrics.Name.bytesOut], estimatedBytes(of: ["code": "123456"]) + estimatedBytes(of: ["sends": 1]))
+        XCTAssertEqual(snapshot.counters[SyncMetrics.Name.errors], 1)
+    }
+
+    func testOnlyConnectsAfterTheFirstCountAsReconnects() {
+        let metrics = SyncMetrics()
+
+        [TWSClientConnectionState.connecting, .connected, .disconnected, .connecting, .connected, .connected]
+            .forEach(metrics.recordConnectionState)
+
+        XCTAssertEqual(metrics.snapshot().counters[SyncMetrics.Name.reconnects], 1)
+    }
+
+    func testSnapshotsArePushedToTheDelegate() {
+        let metrics = SyncMetrics(callbackQueue: .global())
+        let reporter = Reporter(expectation: expectation(description: "reported"))
+        metrics.delegate = reporter
+        metrics.counter("otp.sent").increment(by: 3)
+
+        metrics.startReporting(every: .milliseconds(10))
+        waitForExpectations(timeout: 5)
+        metrics.stopReporting()
+
+        XCTAssertEqual(reporter.snapshot?.counters["otp.sent"], 3)
+    }
+
+    func testCoalescerRecordsBacklogAndDeliveryLag() {
+        let metrics = SyncMetrics()
+        let coalescer = SyncEventCoalescer(options: .init(window: .milliseconds(20)), deliveryQueue: .global(), metrics: metrics)
+        let delivered = expectation(for: NSPredicate { _, _ in coalescer.statistics.delivered == 5 }, evaluatedWith: nil)
+
+        (0..<5).forEach { coalescer.ingest(SyncItemChange(entitySid: "MP1", key: "key-\($0)", kind: .removed, isLocal: false)) }
+        wait(for: [delivered], timeout: 5)
+        Thread.sleep(forTimeInterval: 0.01)
+        let snapshot = metrics.snapshot()
+
+        XCTAssertEqual(snapshot.histograms[SyncMetrics.Name.eventBacklog]?.max, 5)
+        XCTAssertGreaterThanOrEqual(snapshot.histograms[SyncMetrics.Name.eventDeliveryLag]?.min ?? 0, 20_000)
+    }
+
+    func testPerformanceRecordOneMillionLatencies() {
+        let histogram = SyncHistogram()
+        let counter = SyncCounter()
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for value in 0..<1_000_000 {
+                histogram.record(value & 0xFFFF)
+                counter.increment()
+            }
+        }
+    }
+
+    func testPerformanceMapWritesWithoutMetrics() {
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            writeTenThousandItems(to: LocalSyncMap(latency: .nanoseconds(0)))
+        }
+    }
+
+    func testPerformanceMapWritesWithMetrics() {
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            writeTenThousandItems(to: SyncMeasuredMap(LocalSyncMap(latency: .nanoseconds(0)), metrics: SyncMetrics()))
+        }
+    }
+}
+
+private extension SyncMetricsTests {
+
+    func writeTenThousandItems(to map: SyncMapStore) {
+        let done = expectation(description: "written")
+        done.expectedFulfillmentCount = 10_000
+        for index in 0..<10_000 {
+            map.setItem(withKey: "+1555\(index)", data: ["status": "sent"], ttl: nil) { _ in done.fulfill() }
+        }
+        wait(for: [done], timeout: 30)
+    }
+}
+
+private final class Reporter: SyncMetricsDelegate {
+    private let expectation: XCTestExpectation
+    private(set) var snapshot: SyncMetrics.Snapshot?
+
+    init(expectation: XCTestExpectation) {
+        self.expectation = expectation
+    }
+
+    func syncMetrics(_ metrics: SyncMetrics, didReport snapshot: SyncMetrics.Snapshot) {
+        guard self.snapshot == nil else {
+            return
+        }
+        self.snapshot = snapshot
+        expectation.fulfill()
+    }
+}
@@ -0,0 +1,139 @@
+//
+//  SyncMutationCombinerTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncMutationCombinerTests: XCTestCase {
+
+    private let writers = 16
+    private let incrementsPerWriter = 20
+
+    func testConcurrentMutatorsAreFoldedIntoFewerWrites() {
+        let map = LocalSyncMap()
+        let combiner = SyncMutationCombiner(callbackQueue: .global())
+        let done = expectation(description: "mutations")
+        done.expectedFulfillmentCount = writers
+
+        DispatchQueue.concurrentPerform(iterations: writers) { _ in
+            combiner.mutateItem(withKey: "+15550100", in: map, mutator: increment) { result in
+                XCTAssertNotNil(try? result.get())
+                done.fulfill()
+            }
+        }
+        wait(for: [done], timeout: 5)
+
+        XCTAssertEqual(map.item(forKey: "+15550100")?["sends"] as? Int, writers)
+        XCTAssertEqual(combiner.statistics.submitted, writers)
+        XCTAssertLessThan(combiner.statistics.writes, writers)
+        XCTAssertEqual(combiner.statistics.conflicts, 0)
+    }
+
+    func testAbortedMutatorDoesNotStopTheQueue() {
+        let map = LocalSyncMap(latency: .milliseconds(20))
+        let combiner = SyncMutationCombiner(callbackQueue: .global())
+        let done = expectation(description: "mutations")
+        done.expectedFulfillmentCount = 3
+
+        combiner.mutateItem(withKey: "counter", in: map, mutator: increment) { _ in done.fulfill() }
+        combiner.mutateItem(withKey: "counter", in: map, mutator: { _ in nil }) { result in
+            XCTAssertNil(try? result.get())
+            done.fulfill()
+        }
+        combiner.mutateItem(withKey: "counter", in: map, mutator: increment) { result in
+            XCTAssertEqual((try? result.get())?["sends"] as? Int, 2)
+            done.fulfill()
+        }
+        wait(for: [done], timeout: 5)
+    }
+
+    func testWriteWhereEveryMutatorAbortsCompletesAsAborted() {
+        let map = LocalSyncMap(latency: .milliseconds(20))
+        map.failsAbortedMutations = true
+        let combiner = SyncMutationCombiner(callbackQueue: .global())
+        let done = expectation(description: "mutations")
+        done.expectedFulfillmentCount = 3
+
+        combiner.mutateItem(withKey: "counter", in: map, mutator: increment) { _ in done.fulfill() }
+        (0..<2).forEach { _ in
+            combiner.mutateItem(withKey: "counter", in: map, mutator: { _ in nil }) { result in
+                switch result {
+                case .success(let data):
+                    XCTAssertNil(data)
+                case .failure(let error):
+                    XCTFail("aborted mutator failed with \(error)")
+                }
+                done.fulfill()
+            }
+        }
+        wait(for: [done], timeout: 5)
+
+        XCTAssertEqual(map.item(forKey: "counter")?["sends"] as? Int, 1)
+        XCTAssertEqual(combiner.statistics.writes, 2)
+        XCTAssertEqual(combiner.statistics.failures, 0)
+    }
+
+    func testConflictReplaysQueuedMutatorsOnFreshValue() {
+        let map = LocalSyncMap(latency: .milliseconds(20))
+        let combiner = SyncMutationCombiner(callbackQueue: .global())
+        let done = expectation(description: "mutations")
+        done.expectedFulfillmentCount = 2
+
+        map.setItem(withKey: "counter", data: ["sends": 10], ttl: nil) { _ in done.fulfill() }
+        combiner.mutateItem(withKey: "counter", in: map, mutator: increment) { _ in done.fulfill() }
+        wait(for: [done], timeout: 5)
+
+        XCTAssertEqual(map.item(forKey: "counter")?["sends"] as? Int, 11)
+        XCTAssertEqual(combiner.statistics.conflicts, 1)
+    }
+
+    func testPerformanceContendedCounterDirect() {
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let map = LocalSyncMap()
+            runContention { done in
+                map.mutateItem(withKey: "+15550100", mutator: self.increment) { _ in done() }
+            }
+            XCTAssertEqual(map.item(forKey: "+15550100")?["sends"] as? Int, self.writers * self.incrementsPerWriter)
+        }
+    }
+
+    func testPerformanceContendedCounterCombined() {
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let map = LocalSyncMap()
+            let combiner = SyncMutationCombiner(callbackQueue: .global())
+            runContention { done in
+                combiner.mutateItem(withKey: "+15550100", in: map, mutator: self.increment) { _ in done() }
+            }
+            XCTAssertEqual(map.item(forKey: "+15550100")?["sends"] as? Int, self.writers * self.incrementsPerWriter)
+            XCTAssertLessThan(combiner.statistics.writes, self.writers * self.incrementsPerWriter)
+        }
+    }
+}
+
+private extension SyncMutationCombinerTests {
+
+    func increment(_ current: SyncData?) -> SyncData? {
+        var data = current ?? [:]
+        data["sends"] = (data["sends"] as? Int ?? 0) + 1
+        return data
+    }
+
+    /// Runs `writers` concurrent writers that each apply `incrementsPerWriter` mutations one after another.
+    func runContention(_ mutate: @escaping (@escaping () -> Void) -> Void) {
+        let done = expectation(description: "writers")
+        done.expectedFulfillmentCount = writers
+        let increments = incrementsPerWriter
+        for _ in 0..<writers {
+            func next(_ remaining: Int) {
+                guard remaining > 0 else {
+                    return done.fulfill()
+                }
+                mutate { next(remaining - 1) }
+            }
+            DispatchQueue.global().async { next(increments) }
+        }
+        wait(for: [done], timeout: 120)
+    }
+}
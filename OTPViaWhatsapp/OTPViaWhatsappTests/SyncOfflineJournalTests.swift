@@ -0,0 +1,216 @@
+//
+//  SyncOfflineJournalTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncOfflineJournalTests: XCTestCase {
+
+    private var directory: URL!
+    private var fileURL: URL!
+
+    override func setUpWithError() throws {
+        directory = FileManager.default.temporaryDirectory.appendingPathComponent(UUID().uuidString, isDirectory: true)
+        fileURL = directory.appendingPathComponent("journal.log")
+    }
+
+    override func tearDownWithError() throws {
+        try? FileManager.default.removeItem(at: directory)
+    }
+
+    func testMutationsReplayInOrderOnReconnect() throws {
+        let map = LocalSyncMap(sid: "MP1")
+        map.seed([SyncItem(key: "stale", data: ["code": "000000"], dateUpdated: nil)])
+        let journal = try SyncOfflineJournal(fileURL: fileURL, callbackQueue: .global())
+        journal.register(map)
+
+        try journal.append(.setItem(key: "+15550100", data: ["code": "123456"], ttl: 300), toEntity: "MP1")
+        try journal.append(.mergeItem(key: "+15550100", fields: ["attempts": 1]), toEntity: "MP1")
+        try journal.append(.removeItem(key: "stale"), toEntity: "MP1")
+        XCTAssertEqual(journal.statistics.pending, 2)
+        XCTAssertEqual(map.requestCount, 0)
+
+        journal.connectionStateChanged(.connected)
+        wait(for: [drained(journal)], timeout: 5)
+
+        XCTAssertEqual(map.item(forKey: "+15550100") as NSDictionary?, ["code": "123456", "attempts": 1])
+        XCTAssertNil(map.item(forKey: "stale"))
+        XCTAssertEqual(journal.statistics.replayed, 2)
+    }
+
+    func testWritesToTheSameKeyAreCompacted() throws {
+        let map = LocalSyncMap(sid: "MP1")
+        let journal = try SyncOfflineJournal(fileURL: fileURL, callbackQueue: .global())
+        journal.register(map)
+
+        for attempt in 1...100 {
+            try journal.append(.mergeItem(key: "+15550100", fields: ["attempts": attempt]), toEntity: "MP1")
+        }
+        journal.connectionStateChanged(.connected)
+        wait(for: [drained(journal)], timeout: 5)
+
+        XCTAssertEqual(journal.statistics.compacted, 99)
+        XCTAssertEqual(map.requestCount, 1)
+        XCTAssertEqual(map.item(forKey: "+15550100")?["attempts"] as? Int, 100)
+    }
+
+    func testTornWritesAreCutOffOnOpen() throws {
+        var boundaries: [Int] = []
+        do {
+            let journal = try SyncOfflineJournal(fileURL: fileURL, options: .init(synchronizesAppends: false))
+            for index in 0..<50 {
+                try journal.append(.setItem(key: "key-\(index)", data: ["index": index], ttl: nil), toEntity: "MP1")
+                boundaries.append(try fileSize())
+            }
+        }
+        let complete = try Data(contentsOf: fileURL)
+
+        for cut in boundaries[0] - 1..<complete.count {
+            try complete.prefix(cut).write(to: fileURL)
+            let journal = try SyncOfflineJournal(fileURL: fileURL, options: .init(synchronizesAppends: false))
+            let intact = boundaries.filter { $0 <= cut }.count
+            XCTAssertEqual(journal.statistics.pending, intact, "cut at \(cut)")
+
+            try journal.append(.setItem(key: "after-crash", data: ["index": -1], ttl: nil), toEntity: "MP1")
+            XCTAssertEqual(try SyncOfflineJournal(fileURL: fileURL).statistics.pending, intact + 1, "cut at \(cut)")
+        }
+    }
+
+    func testCorruptRecordEndsTheJournal() throws {
+        do {
+            let journal = try SyncOfflineJournal(fileURL: fileURL)
+            try journal.append(.setItem(key: "a", data: ["value": 1], ttl: nil), toEntity: "MP1")
+            try journal.append(.setItem(key: "b", data: ["value": 2], ttl: nil), toEntity: "MP1")
+        }
+        var data = try Data(contentsOf: fileURL)
+        data[data.count - 2] ^= 0xFF
+        try data.write(to: fileURL)
+
+        XCTAssertEqual(try SyncOfflineJournal(fileURL: fileURL).statistics.pending, 1)
+    }
+
+    func testUnreadableJournalIsLeftUntouched() throws {
+        do {
+            let journal = try SyncOfflineJournal(fileURL: fileURL)
+            try journal.append(.setItem(key: "a", data: ["value": 1], ttl: nil), toEntity: "MP1")
+        }
+        let contents = try Data(contentsOf: fileURL)
+        try FileManager.default.setAttributes([.posixPermissions: 0o000], ofItemAtPath: fileURL.path)
+
+        XCTAssertThrowsError(try SyncOfflineJournal(fileURL: fileURL))
+        try FileManager.default.setAttributes([.posixPermissions: 0o600], ofItemAtPath: fileURL.path)
+        XCTAssertEqual(try Data(contentsOf: fileURL), contents)
+        XCTAssertEqual(try SyncOfflineJournal(fileURL: fileURL).statistics.pending, 1)
+    }
+
+    func testOnlyUnacknowledgedMutationsSurviveReopen() throws {
+        let map = LocalSyncMap(sid: "MP1")
+        map.failingKeys = ["key-7"]
+        do {
+            let journal = try SyncOfflineJournal(fileURL: fileURL, options: .init(maxBatchSize: 4, maxAttempts: 100, retryDelay: 0.01,
+                                                                                  maxRetryDelay: 0.05),
+                                                 callbackQueue: .global())
+            journal.register(map)
+            for index in 0..<10 {
+                try journal.append(.setItem(key: "key-\(index)", data: ["index": index], ttl: nil), toEntity: "MP1")
+            }
+            journal.connectionStateChanged(.connected)
+            let settled = NSPredicate { _, _ in journal.statistics.replayed == 9 && journal.statistics.pending == 1 }
+            wait(for: [expectation(for: settled, evaluatedWith: nil)], timeout: 5)
+        }
+
+        XCTAssertEqual(try SyncOfflineJournal(fileURL: fileURL).statistics.pending, 1)
+    }
+
+    func testFailuresWhileDisconnectedDoNotCountAsAttempts() throws {
+        let map = LocalSyncMap(sid: "MP1", latency: .milliseconds(50))
+        map.failingKeys = ["+15550100"]
+        let journal = try SyncOfflineJournal(fileURL: fileURL, options: .init(maxAttempts: 1), callbackQueue: .global())
+        journal.register(map)
+        journal.connectionStateChanged(.connected)
+
+        try journal.append(.setItem(key: "+15550100", data: ["code": "123456"], ttl: 300), toEntity: "MP1")
+        journal.connectionStateChanged(.disconnected)
+        Thread.sleep(forTimeInterval: 0.2)
+        XCTAssertEqual(journal.statistics.dropped, 0)
+        XCTAssertEqual(journal.statistics.pending, 1)
+
+        map.failingKeys = []
+        journal.connectionStateChanged(.connected)
+        wait(for: [drained(journal)], timeout: 5)
+
+        XCTAssertEqual(journal.statistics.replayed, 1)
+        XCTAssertEqual(map.item(forKey: "+15550100") as NSDictionary?, ["code": "123456"])
+    }
+
+    func testAppendsWaitForTheScheduledRetry() throws {
+        let map = LocalSyncMap(sid: "MP1")
+        map.failingKeys = ["broken"]
+        let journal = try SyncOfflineJournal(fileURL: fileURL, options: .init(maxAttempts: 100, retryDelay: 0.5, maxRetryDelay: 0.5),
+                                             callbackQueue: .global())
+        journal.register(map)
+        journal.connectionStateChanged(.connected)
+
+        try journal.append(.setItem(key: "broken", data: ["value": 1], ttl: nil), toEntity: "MP1")
+        let failed = NSPredicate { _, _ in map.requestCount == 1 && journal.statistics.batches == 1 }
+        wait(for: [expectation(for: failed, evaluatedWith: nil)], timeout: 5)
+        Thread.sleep(forTimeInterval: 0.05)
+        try journal.append(.setItem(key: "fine", data: ["value": 2], ttl: nil), toEntity: "MP1")
+        Thread.sleep(forTimeInterval: 0.1)
+        XCTAssertEqual(journal.statistics.batches, 1)
+
+        let retried = NSPredicate { _, _ in journal.statistics.replayed == 1 }
+        wait(for: [expectation(for: retried, evaluatedWith: nil)], timeout: 5)
+        XCTAssertEqual(map.item(forKey: "fine")?["value"] as? Int, 2)
+    }
+
+    func testMutationIsDroppedAfterMaxAttempts() throws {
+        let map = LocalSyncMap(sid: "MP1")
+        map.failingKeys = ["broken"]
+        let journal = try SyncOfflineJournal(fileURL: fileURL, options: .init(maxAttempts: 1), callbackQueue: .global())
+        let reported = expectation(description: "failure reported")
+        journal.onFailure = { entity, _, _ in
+            XCTAssertEqual(entity, "MP1")
+            reported.fulfill()
+        }
+        journal.register(map)
+        journal.connectionStateChanged(.connected)
+
+        try journal.append(.setItem(key: "broken", data: ["value": 1], ttl: nil), toEntity: "MP1")
+        wait(for: [reported, drained(journal)], timeout: 5)
+
+        XCTAssertEqual(journal.statistics.dropped, 1)
+        XCTAssertEqual(try fileSize(), 4)
+    }
+
+    func testPerformanceReplayOneHundredThousandMutations() {
+        let options = XCTMeasureOptions()
+        options.invocationOptions = [.manuallyStart]
+
+        measure(metrics: [XCTClockMetric()], options: options) {
+            try? FileManager.default.removeItem(at: fileURL)
+            let maps = (0..<10).map { LocalSyncMap(sid: "MP\($0)", latency: .nanoseconds(0)) }
+            let journal = try! SyncOfflineJournal(fileURL: fileURL, options: .init(synchronizesAppends: false), callbackQueue: .global())
+            maps.forEach { journal.register($0) }
+            for index in 0..<100_000 {
+                try! journal.append(.setItem(key: "otp-\(index)", data: ["status": "sent"], ttl: 300), toEntity: "MP\(index % 10)")
+            }
+            startMeasuring()
+            journal.connectionStateChanged(.connected)
+            wait(for: [drained(journal)], timeout: 120)
+        }
+    }
+}
+
+private extension SyncOfflineJournalTests {
+
+    func drained(_ journal: SyncOfflineJournal) -> XCTestExpectation {
+        expectation(for: NSPredicate { _, _ in journal.statistics.pending == 0 }, evaluatedWith: nil)
+    }
+
+    func fileSize() throws -> Int {
+        try XCTUnwrap(FileManager.default.attributesOfItem(atPath: fileURL.path)[.size] as? Int)
+    }
+}
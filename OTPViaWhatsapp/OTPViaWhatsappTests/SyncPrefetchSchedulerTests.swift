@@ -0,0 +1,144 @@
+//
+//  SyncPrefetchSchedulerTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncPrefetchSchedulerTests: XCTestCase {
+
+    func testHigherPriorityEntityCompletesFirst() {
+        let scheduler = SyncPrefetchScheduler(options: .init(maxConcurrentPages: 1, pageSize: 10, maxBytesPerSecond: nil),
+                                              callbackQueue: .global())
+        var completed: [String] = []
+        let lock = NSLock()
+        let done = expectation(description: "prefetched")
+        done.expectedFulfillmentCount = 3
+        scheduler.onProgress = { progress in
+            guard progress.isComplete else {
+                return
+            }
+            lock.lock()
+            completed.append(progress.entity)
+            lock.unlock()
+            done.fulfill()
+        }
+
+        scheduler.beginInteractive()
+        scheduler.prefetch(seededMap(items: 50), entity: "low", priority: .low)
+        scheduler.prefetch(seededMap(items: 50), entity: "normal")
+        scheduler.prefetch(seededMap(items: 50), entity: "high", priority: .high)
+        scheduler.endInteractive()
+        wait(for: [done], timeout: 10)
+
+        XCTAssertEqual(completed, ["high", "normal", "low"])
+    }
+
+    func testNoPrefetchPageStartsDuringInteractiveOperation() {
+        let map = seededMap(items: 500)
+        let scheduler = SyncPrefetchScheduler(options: .init(pageSize: 10, maxBytesPerSecond: nil), callbackQueue: .global())
+        let done = expectation(description: "interactive")
+        var requestsDuringOperation = 0
+
+        scheduler.prefetch(map)
+        Thread.sleep(forTimeInterval: 0.02)
+        scheduler.performInteractive { finish in
+            DispatchQueue.global().asyncAfter(deadline: .now() + 0.01) {
+                let before = map.requestCount
+                Thread.sleep(forTimeInterval: 0.05)
+                requestsDuringOperation = map.requestCount - before
+                finish()
+                done.fulfill()
+            }
+        }
+        wait(for: [done], timeout: 5)
+
+        XCTAssertEqual(requestsDuringOperation, 0)
+    }
+
+    func testByteRateCapSlowsPrefetch() {
+        let map = seededMap(items: 200)
+        let scheduler = SyncPrefetchScheduler(options: .init(pageSize: 50, maxBytesPerSecond: 4 * 1024), callbackQueue: .global())
+        let done = expectation(description: "prefetched")
+        var progress: SyncPrefetchScheduler.Progress?
+        scheduler.onProgress = {
+            guard $0.isComplete else {
+                return
+            }
+            progress = $0
+            done.fulfill()
+        }
+        let start = Date()
+
+        scheduler.prefetch(map)
+        wait(for: [done], timeout: 10)
+
+        XCTAssertEqual(progress?.items, 200)
+        XCTAssertGreaterThan(progress?.bytes ?? 0, 6 * 1024)
+        // The first 4 KB go out at once; the debt of every later page but the last is waited off at 4 KB/s.
+        XCTAssertGreaterThan(Date().timeIntervalSince(start), 0.25)
+    }
+
+    func testPerformanceTimeToInteractiveWithAggressiveOpen() {
+        let maps = (0..<10).map { _ in seededMap(items: 2_000) }
+
+        measure(metrics: [XCTClockMetric()]) {
+            let link = LocalSyncLink(bytesPerSecond: 2 * 1024 * 1024)
+            maps.map { LinkedSyncMap(map: $0, link: link) }.forEach { map in
+                map.queryItems(startingAt: nil, pageSize: 2_000) { _ in }
+            }
+            attach(timeToInteractive: timeToInteractive(over: link, scheduler: nil))
+        }
+    }
+
+    func testPerformanceTimeToInteractiveWithPrefetchScheduler() {
+        let maps = (0..<10).map { _ in seededMap(items: 2_000) }
+
+        measure(metrics: [XCTClockMetric()]) {
+            let link = LocalSyncLink(bytesPerSecond: 2 * 1024 * 1024)
+            let scheduler = SyncPrefetchScheduler(options: .init(maxBytesPerSecond: nil), callbackQueue: .global())
+            maps.map { LinkedSyncMap(map: $0, link: link) }.forEach { scheduler.prefetch($0) }
+            attach(timeToInteractive: timeToInteractive(over: link, scheduler: scheduler))
+        }
+    }
+}
+
+private extension SyncPrefetchSchedulerTests {
+
+    func seededMap(items count: Int) -> LocalSyncMap {
+        let map = LocalSyncMap()
+        map.seed((0..<count).map {
+            SyncItem(key: String(format: "+1555%06d", $0), data: ["status": "delivered", "attempts": $0 % 5], dateUpdated: nil)
+        })
+        return map
+    }
+
+    /// Milliseconds until a 50-item query on a separate map completes while prefetch traffic shares the link.
+    func timeToInteractive(over link: LocalSyncLink, scheduler: SyncPrefetchScheduler?) -> Int {
+        let interactive = LinkedSyncMap(map: seededMap(items: 50), link: link)
+        let done = expectation(description: "interactive")
+        Thread.sleep(forTimeInterval: 0.01)
+        let start = Date()
+        let query = { (finish: @escaping () -> Void) in
+            interactive.queryItems(startingAt: nil, pageSize: 50) { _ in
+                finish()
+                done.fulfill()
+            }
+        }
+        if let scheduler = scheduler {
+            scheduler.performInteractive(query)
+        } else {
+            query {}
+        }
+        wait(for: [done], timeout: 30)
+        return Int(Date().timeIntervalSince(start) * 1000)
+    }
+
+    /// Keeps the measured time with the test report, next to the clock metric of the whole iteration.
+    func attach(timeToInteractive milliseconds: Int) {
+        let attachment = XCTAttachment(string: "Time to interactive: \(milliseconds) ms")
+        attachment.lifetime = .keepAlways
+        add(attachment)
+    }
+}
@@ -0,0 +1,107 @@
+//
+//  SyncReadAheadPaginatorTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncReadAheadPaginatorTests: XCTestCase {
+
+    func testListScanDeliversEveryItemInOrderAndGrowsPages() {
+        let list = LocalSyncList()
+        list.seed((0..<1_000).map { ["attempt": $0] })
+        let paginator = SyncReadAheadPaginator(list: list, options: SyncReadAheadOptions(initialPageSize: 10, maxPageSize: 200),
+                                               callbackQueue: .global())
+        var indexes: [Int] = []
+        let done = expectation(description: "scan")
+
+        paginator.forEach({ item in
+            indexes.append(Int(item.index))
+            return true
+        }, completion: { error in
+            XCTAssertNil(error)
+            done.fulfill()
+        })
+        wait(for: [done], timeout: 10)
+
+        XCTAssertEqual(indexes, Array(0..<1_000))
+        XCTAssertGreaterThan(paginator.statistics.pageSize, 10)
+        XCTAssertLessThanOrEqual(paginator.statistics.pageSize, 200)
+        XCTAssertLessThan(paginator.statistics.pages, 100)
+    }
+
+    func testMapScanSkipsInclusiveStartPosition() {
+        let map = LocalSyncMap()
+        map.seed((0..<250).map { SyncItem(key: String(format: "+1555%04d", $0), data: [:], dateUpdated: nil) })
+        let paginator = SyncReadAheadPaginator(map: map, options: SyncReadAheadOptions(initialPageSize: 20), callbackQueue: .global())
+        var keys: [String] = []
+        let done = expectation(description: "scan")
+
+        paginator.forEach({ item in
+            keys.append(item.key)
+            return true
+        }, completion: { _ in done.fulfill() })
+        wait(for: [done], timeout: 10)
+
+        XCTAssertEqual(keys.count, 250)
+        XCTAssertEqual(Set(keys).count, 250)
+        XCTAssertEqual(keys, keys.sorted())
+    }
+
+    func testStoppingEarlyCompletesWithoutError() {
+        let list = LocalSyncList()
+        list.seed((0..<500).map { ["attempt": $0] })
+        let paginator = SyncReadAheadPaginator(list: list, callbackQueue: .global())
+        var seen = 0
+        let done = expectation(description: "scan")
+
+        paginator.forEach({ _ in
+            seen += 1
+            return seen < 75
+        }, completion: { error in
+            XCTAssertNil(error)
+            done.fulfill()
+        })
+        wait(for: [done], timeout: 10)
+
+        XCTAssertEqual(seen, 75)
+    }
+
+    func testPerformanceFullScanWithPaginator() {
+        let list = LocalSyncList()
+        list.seed((0..<100_000).map { ["phone": "+1555\($0)", "status": "delivered"] })
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let done = expectation(description: "scan")
+            var count = 0
+            func consume(_ result: Result<SyncListPage, Error>) {
+                guard let page = try? result.get() else {
+                    return done.fulfill()
+                }
+                count += page.items.count
+                page.hasNextPage ? page.nextPage(completion: consume) : done.fulfill()
+            }
+            list.queryItems(startingAt: nil, pageSize: SyncReadAheadOptions.default.initialPageSize, completion: consume)
+            wait(for: [done], timeout: 120)
+            XCTAssertEqual(count, 100_000)
+        }
+    }
+
+    func testPerformanceFullScanWithReadAhead() {
+        let list = LocalSyncList()
+        list.seed((0..<100_000).map { ["phone": "+1555\($0)", "status": "delivered"] })
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let paginator = SyncReadAheadPaginator(list: list, callbackQueue: .global())
+            let done = expectation(description: "scan")
+            var count = 0
+            paginator.forEach({ _ in
+                count += 1
+                return true
+            }, completion: { _ in done.fulfill() })
+            wait(for: [done], timeout: 120)
+            XCTAssertEqual(count, 100_000)
+        }
+    }
+}
@@ -0,0 +1,206 @@
+//
+//  SyncStreamPublisherTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncStreamPublisherTests: XCTestCase {
+
+    func testQueuedMessagesAreBatchedInOrder() {
+        let stream = LocalSyncStream()
+        let publisher = SyncStreamPublisher(stream: stream)
+        let recorder = MessageRecorder(stream: stream, expected: 200, expectation: expectation(description: "acknowledged"))
+
+        (0..<200).forEach { publisher.publish(status(seq: $0)) }
+        waitForExpectations(timeout: 10)
+
+        XCTAssertEqual(recorder.sequence, Array(0..<200))
+        XCTAssertLessThan(stream.publishCount, 200)
+        XCTAssertEqual(publisher.statistics.acknowledged, 200)
+    }
+
+    func testFullQueueDropsOldestMessages() {
+        let stream = LocalSyncStream()
+        let publisher = SyncStreamPublisher(stream: stream, options: .init(maxQueuedMessages: 10, linger: .milliseconds(100)))
+        let recorder = MessageRecorder(stream: stream, expected: 10, expectation: expectation(description: "acknowledged"))
+
+        (0..<30).forEach { XCTAssertTrue(publisher.publish(status(seq: $0))) }
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(recorder.sequence, Array(20..<30))
+        XCTAssertEqual(publisher.statistics.dropped, 20)
+    }
+
+    func testFullQueueRejectsNewestMessages() {
+        let publisher = SyncStreamPublisher(stream: LocalSyncStream(),
+                                            options: .init(maxQueuedMessages: 10, dropPolicy: .dropNewest, linger: .seconds(1)))
+
+        let accepted = (0..<30).map { publisher.publish(status(seq: $0)) }
+
+        XCTAssertEqual(accepted.filter { $0 }.count, 10)
+        XCTAssertEqual(publisher.statistics.dropped, 20)
+    }
+
+    func testWindowShrinksWhenPublishesAreRejected() {
+        let stream = LocalSyncStream(capacity: 2)
+        let publisher = SyncStreamPublisher(stream: stream, options: .init(maxBatchMessages: 1, linger: .milliseconds(0), initialWindow: 16))
+
+        (0..<100).forEach { publisher.publish(status(seq: $0)) }
+        let settled = expectation(for: NSPredicate { _, _ in
+            let statistics = publisher.statistics
+            return statistics.acknowledged + statistics.failed == 100
+        }, evaluatedWith: nil)
+        wait(for: [settled], timeout: 10)
+
+        XCTAssertGreaterThan(stream.rejectedCount, 0)
+        XCTAssertLessThan(publisher.statistics.window, 16)
+    }
+
+    func testUndeliveredMessagesAreReported() {
+        let stream = LocalSyncStream(capacity: 1)
+        let publisher = SyncStreamPublisher(stream: stream, options: .init(maxQueuedMessages: 50, maxBatchMessages: 1,
+                                                                           linger: .milliseconds(0), initialWindow: 4),
+                                            callbackQueue: .global())
+        let lock = NSLock()
+        var reported: [Int] = []
+        publisher.onFailure = { messages, _ in
+            lock.lock()
+            reported += messages.compactMap { $0["seq"] as? Int }
+            lock.unlock()
+        }
+
+        (0..<100).forEach { publisher.publish(status(seq: $0)) }
+        let settled = expectation(for: NSPredicate { _, _ in
+            let statistics = publisher.statistics
+            lock.lock()
+            defer { lock.unlock() }
+            return statistics.acknowledged + statistics.failed + statistics.dropped == 100
+                && reported.count == statistics.failed + statistics.dropped
+        }, evaluatedWith: nil)
+        wait(for: [settled], timeout: 10)
+
+        XCTAssertGreaterThan(publisher.statistics.failed, 0)
+        XCTAssertGreaterThan(publisher.statistics.dropped, 0)
+    }
+
+    func testMessagesThatLookLikeEnvelopesArriveUnchanged() {
+        let stream = LocalSyncStream()
+        let publisher = SyncStreamPublisher(stream: stream, options: .init(linger: .milliseconds(0)))
+        let received = expectation(description: "received")
+        var messages: [SyncData] = []
+        stream.onMessages = {
+            messages += $0
+            received.fulfill()
+        }
+
+        publisher.publish([SyncStreamPublisher.batchKey: [["seq": 1]]])
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(messages.count, 1)
+        XCTAssertEqual(messages.first?[SyncStreamPublisher.batchKey] as? [[String: Int]], [["seq": 1]])
+    }
+
+    func testPerformancePublishTenThousandMessagesOneByOne() {
+        let messages = (0..<10_000).map(status)
+
+        measure(metrics: [XCTClockMetric()]) {
+            let stream = LocalSyncStream()
+            let recorder = MessageRecorder(stream: stream, expected: messages.count, expectation: expectation(description: "acknowledged"))
+            let start = Date()
+            messages.forEach { message in
+                recorder.markPublished(message)
+                stream.publishMessage(withData: message) { _ in }
+            }
+            wait(for: [recorder.expectation], timeout: 60)
+            report(recorder, count: messages.count, since: start)
+        }
+    }
+
+    func testPerformancePublishTenThousandMessagesThroughPipeline() {
+        let messages = (0..<10_000).map(status)
+
+        measure(metrics: [XCTClockMetric()]) {
+            let stream = LocalSyncStream()
+            let publisher = SyncStreamPublisher(stream: stream, options: .init(maxQueuedMessages: messages.count))
+            let recorder = MessageRecorder(stream: stream, expected: messages.count, expectation: expectation(description: "acknowledged"))
+            let start = Date()
+            messages.forEach { message in
+                recorder.markPublished(message)
+                publisher.publish(message)
+            }
+            wait(for: [recorder.expectation], timeout: 60)
+            report(recorder, count: messages.count, since: start)
+        }
+    }
+}
+
+private extension SyncStreamPublisherTests {
+
+    /// An OTP delivery status update, about 60 bytes of JSON.
+    func status(seq: Int) -> SyncData {
+        ["seq": seq, "phone": String(format: "+1555%06d", seq), "status": "delivered"]
+    }
+
+    /// Keeps the throughput and tail latency of one iteration with the test report.
+    func report(_ recorder: MessageRecorder, count: Int, since start: Date) {
+        let elapsed = Date().timeIntervalSince(start)
+        let attachment = XCTAttachment(string: "Published \(Int(Double(count) / elapsed)) msgs/s, "
+                                           + "p99 latency \(Int(recorder.latency(percentile: 0.99) * 1000)) ms")
+        attachment.lifetime = .keepAlways
+        add(attachment)
+    }
+}
+
+/// Records which messages a `LocalSyncStream` acknowledged, and when, relative to when they were published.
+private final class MessageRecorder {
+    let expectation: XCTestExpectation
+    private let expected: Int
+    private let lock = NSLock()
+    private var published: [Int: DispatchTime] = [:]
+    private var latencies: [TimeInterval] = []
+    private var received: [Int] = []
+
+    init(stream: LocalSyncStream, expected: Int, expectation: XCTestExpectation) {
+        self.expected = expected
+        self.expectation = expectation
+        stream.onMessages = { [weak self] in self?.record($0) }
+    }
+
+    var sequence: [Int] {
+        lock.lock()
+        defer { lock.unlock() }
+        return received
+    }
+
+    func markPublished(_ message: SyncData) {
+        lock.lock()
+        published[message["seq"] as? Int ?? -1] = DispatchTime.now()
+        lock.unlock()
+    }
+
+    func latency(percentile: Double) -> TimeInterval {
+        lock.lock()
+        defer { lock.unlock() }
+        let sorted = latencies.sorted()
+        return sorted.isEmpty ? 0 : sorted[min(Int(Double(sorted.count) * percentile), sorted.count - 1)]
+    }
+
+    private func record(_ messages: [SyncData]) {
+        let now = DispatchTime.now()
+        lock.lock()
+        for message in messages {
+            let seq = message["seq"] as? Int ?? -1
+            received.append(seq)
+            if let published = published[seq] {
+                latencies.append(Double(now.uptimeNanoseconds - published.uptimeNanoseconds) / 1_000_000_000)
+            }
+        }
+        let isComplete = received.count == expected
+        lock.unlock()
+        if isComplete {
+            expectation.fulfill()
+        }
+    }
+}
@@ -0,0 +1,210 @@
+//
+//  SyncTokenRefresherTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncTokenRefresherTests: XCTestCase {
+
+    func testExpiryIsReadFromTheJWT() {
+        let payload = Data(#"{"exp":1700000000,"grants":{}}"#.utf8).base64EncodedString()
+            .replacingOccurrences(of: "=", with: "")
+
+        let token = SyncAccessToken(jwt: "eyJhbGciOiJIUzI1NiJ9.\(payload).c2lnbmF0dXJl")
+
+        XCTAssertEqual(token?.expiresAt, Date(timeIntervalSince1970: 1_700_000_000))
+        XCTAssertNil(SyncAccessToken(jwt: "not-a-jwt"))
+    }
+
+    func testConcurrentTriggersShareOneRefresh() {
+        let server = LocalTokenServer(ttl: 60)
+        let client = LocalTokenClient()
+        let refresher = SyncTokenRefresher(provider: server, client: client, callbackQueue: .global())
+        let done = expectation(description: "tokens delivered")
+        done.expectedFulfillmentCount = 10
+
+        DispatchQueue.concurrentPerform(iterations: 10) { _ in
+            refresher.refresh()
+            refresher.withValidToken { result in
+                XCTAssertEqual(try? result.get(), "token-1")
+                done.fulfill()
+            }
+        }
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(server.fetchCount, 1)
+        XCTAssertEqual(client.tokens, ["token-1"])
+        XCTAssertEqual(refresher.statistics.refreshes, 1)
+    }
+
+    func testTokenIsRefreshedBeforeItExpires() {
+        let server = LocalTokenServer(ttl: 0.3)
+        let client = LocalTokenClient()
+        let refresher = SyncTokenRefresher(provider: server, client: client, options: .init(refreshMargin: 0.15),
+                                           callbackQueue: .global())
+        let refreshed = expectation(for: NSPredicate { _, _ in client.tokens.count == 2 }, evaluatedWith: nil)
+
+        refresher.start(with: SyncAccessToken(jwt: "token-0", expiresAt: Date(timeIntervalSinceNow: 0.3)))
+        wait(for: [refreshed], timeout: 5)
+
+        XCTAssertEqual(refresher.statistics.stalledRequests, 0)
+        XCTAssertEqual(client.tokens, ["token-1", "token-2"])
+    }
+
+    func testFailedRefreshIsRetriedWhileTheTokenIsValid() {
+        let server = LocalTokenServer(ttl: 60, failures: 1)
+        let client = LocalTokenClient()
+        let refresher = SyncTokenRefresher(provider: server, client: client, options: .init(refreshMargin: 0.5, retryDelay: 0.05),
+                                           callbackQueue: .global())
+        let refreshed = expectation(for: NSPredicate { _, _ in client.tokens.count == 1 }, evaluatedWith: nil)
+
+        refresher.start(with: SyncAccessToken(jwt: "token-0", expiresAt: Date(timeIntervalSinceNow: 1)))
+        wait(for: [refreshed], timeout: 5)
+
+        XCTAssertEqual(refresher.statistics.failures, 1)
+        XCTAssertEqual(server.fetchCount, 2)
+    }
+
+    func testLastRetryLandsBeforeTheTokenExpires() throws {
+        let server = LocalTokenServer(ttl: 60, failures: 1)
+        let client = LocalTokenClient()
+        let refresher = SyncTokenRefresher(provider: server, client: client,
+                                           options: .init(refreshMargin: 0.4, retryDelay: 10, expiryLead: 0.2),
+                                           callbackQueue: .global())
+        let refreshed = expectation(for: NSPredicate { _, _ in client.tokens.count == 1 }, evaluatedWith: nil)
+        let expiry = Date(timeIntervalSinceNow: 0.6)
+
+        refresher.start(with: SyncAccessToken(jwt: "token-0", expiresAt: expiry))
+        wait(for: [refreshed], timeout: 5)
+
+        XCTAssertEqual(server.fetchCount, 2)
+        XCTAssertLessThan(try XCTUnwrap(client.acceptedDates.first), expiry)
+    }
+
+    func testFailedRefreshKeepsRetryingAfterTheTokenExpired() {
+        let server = LocalTokenServer(ttl: 60, failures: 4)
+        let client = LocalTokenClient()
+        let refresher = SyncTokenRefresher(provider: server, client: client,
+                                           options: .init(refreshMargin: 0.5, retryDelay: 0.02, maxRetryDelay: 0.05),
+                                           callbackQueue: .global())
+        let refreshed = expectation(for: NSPredicate { _, _ in client.tokens.count == 1 }, evaluatedWith: nil)
+
+        refresher.start(with: SyncAccessToken(jwt: "token-0", expiresAt: Date(timeIntervalSinceNow: -1)))
+        wait(for: [refreshed], timeout: 5)
+
+        XCTAssertEqual(refresher.statistics.failures, 4)
+        XCTAssertEqual(server.fetchCount, 5)
+        XCTAssertEqual(client.tokens, ["token-5"])
+    }
+
+    func testTokensShorterThanTheMarginRefreshHalfwayThrough() {
+        let server = LocalTokenServer(ttl: 1)
+        let client = LocalTokenClient()
+        let refresher = SyncTokenRefresher(provider: server, client: client, options: .init(refreshMargin: 60),
+                                           callbackQueue: .global())
+        let refreshed = expectation(for: NSPredicate { _, _ in client.tokens.count == 1 }, evaluatedWith: nil)
+
+        refresher.start(with: SyncAccessToken(jwt: "token-0", expiresAt: Date(timeIntervalSinceNow: 0.2)))
+        wait(for: [refreshed], timeout: 5)
+        Thread.sleep(forTimeInterval: 0.2)
+
+        XCTAssertEqual(server.fetchCount, 1)
+        XCTAssertEqual(client.tokens, ["token-1"])
+    }
+
+    func testProactiveRefreshDoesNotStallRequests() {
+        XCTAssertGreaterThan(stalledRequests(refreshMargin: 0), 0)
+        XCTAssertEqual(stalledRequests(refreshMargin: 0.06), 0)
+    }
+
+    func testPerformanceRequestsWithRefreshOnExpiry() {
+        measure(metrics: [XCTClockMetric()]) {
+            _ = stalledRequests(refreshMargin: 0)
+        }
+    }
+
+    func testPerformanceRequestsWithProactiveRefresh() {
+        measure(metrics: [XCTClockMetric()]) {
+            _ = stalledRequests(refreshMargin: 0.06)
+        }
+    }
+}
+
+private extension SyncTokenRefresherTests {
+
+    /// Sends 200 requests one after another, 2 ms apart, under 100 ms tokens, and returns how many had
+    /// to wait for a refresh.
+    func stalledRequests(refreshMargin: TimeInterval) -> Int {
+        let server = LocalTokenServer(ttl: 0.1)
+        let refresher = SyncTokenRefresher(provider: server, client: LocalTokenClient(), options: .init(refreshMargin: refreshMargin),
+                                           callbackQueue: .global())
+        refresher.start(with: SyncAccessToken(jwt: "token-0", expiresAt: Date(timeIntervalSinceNow: 0.1)))
+        for _ in 0..<200 {
+            let sent = expectation(description: "request sent")
+            refresher.withValidToken { _ in sent.fulfill() }
+            wait(for: [sent], timeout: 5)
+            Thread.sleep(forTimeInterval: 0.002)
+        }
+        return refresher.statistics.stalledRequests
+    }
+}
+
+/// Stands in for the app's token endpoint: answers after `latency` with a token living `ttl` seconds,
+/// failing the first `failures` fetches.
+private final class LocalTokenServer: SyncTokenProvider {
+    private let ttl: TimeInterval
+    private let latency: TimeInterval
+    private let queue = DispatchQueue(label: "LocalTokenServer")
+    private var failures: Int
+    private var fetches = 0
+
+    init(ttl: TimeInterval, latency: TimeInterval = 0.02, failures: Int = 0) {
+        self.ttl = ttl
+        self.latency = latency
+        self.failures = failures
+    }
+
+    var fetchCount: Int {
+        queue.sync { fetches }
+    }
+
+    func fetchToken(completion: @escaping (Result<SyncAccessToken, Error>) -> Void) {
+        queue.asyncAfter(deadline: .now() + latency) {
+            self.fetches += 1
+            guard self.failures == 0 else {
+                self.failures -= 1
+                return completion(.failure(SyncStoreError.unknown))
+            }
+            completion(.success(SyncAccessToken(jwt: "token-\(self.fetches)",
+                                                expiresAt: Date(timeIntervalSinceNow: self.ttl))))
+        }
+    }
+}
+
+/// Stands in for `TwilioSyncClient.updateToken`, one round-trip of `latency`.
+private final class LocalTokenClient: SyncTokenConsumer {
+    private let latency: TimeInterval
+    private let queue = DispatchQueue(label: "LocalTokenClient")
+    private var accepted: [(token: String, date: Date)] = []
+
+    init(latency: TimeInterval = 0.01) {
+        self.latency = latency
+    }
+
+    var tokens: [String] {
+        queue.sync { accepted.map(\.token) }
+    }
+
+    var acceptedDates: [Date] {
+        queue.sync { accepted.map(\.date) }
+    }
+
+    func updateAccessToken(_ token: String, completion: @escaping (Error?) -> Void) {
+        queue.asyncAfter(deadline: .now() + latency) {
+            self.accepted.append((token, Date()))
+            completion(nil)
+        }
+    }
+}
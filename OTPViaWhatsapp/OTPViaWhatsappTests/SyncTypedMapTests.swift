@@ -0,0 +1,197 @@
+//
+//  SyncTypedMapTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import OTPViaWhatsapp
+
+final class SyncTypedMapTests: XCTestCase {
+
+    func testDecoderReadsNestedValuesInPlace() throws {
+        let data: SyncData = ["phone": "+15550100", "code": "123456", "attempts": 2, "verified": false,
+                              "sentAt": 1_700_000_000, "channels": ["whatsapp", "sms"],
+                              "device": ["model": "iPhone", "build": NSNull()]]
+
+        let session = try SyncDataDecoder().decode(OTPSession.self, from: data)
+
+        XCTAssertEqual(session, OTPSession(phone: "+15550100", code: "123456", attempts: 2, verified: false,
+                                           sentAt: Date(timeIntervalSince1970: 1_700_000_000), channels: ["whatsapp", "sms"],
+                                           device: .init(model: "iPhone", build: nil)))
+    }
+
+    func testDecoderReportsMissingKeysWithTheirPath() {
+        XCTAssertThrowsError(try SyncDataDecoder().decode(OTPSession.Device.self, from: ["build": "21A"])) { error in
+            guard case DecodingError.keyNotFound(let key, _) = error else {
+                return XCTFail("Unexpected error \(error)")
+            }
+            XCTAssertEqual(key.stringValue, "model")
+        }
+    }
+
+    func testTypedItemsRoundTripThroughTheStore() {
+        let typed = SyncTypedMap<OTPSession>(LocalSyncMap())
+        let done = expectation(description: "queried")
+        var values: [OTPSession] = []
+
+        typed.setItem(session(0), forKey: "+15550000") { error in
+            XCTAssertNil(error)
+            typed.mutateItem(forKey: "+15550000", mutator: { current in
+                var session = current
+                session?.attempts += 1
+                return session
+            }, completion: { result in
+                XCTAssertEqual((try? result.get())?.attempts, 1)
+                typed.queryItems(pageSize: 10) { result in
+                    values = ((try? result.get()) ?? []).map(\.value)
+                    done.fulfill()
+                }
+            })
+        }
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(values, [OTPSession(phone: "+15550000", code: "000000", attempts: 1, verified: false,
+                                           sentAt: Date(timeIntervalSince1970: 1_700_000_000), channels: ["whatsapp"],
+                                           device: nil)])
+    }
+
+    func testMutationAbortsWhenStoredValueDoesNotDecode() {
+        let map = LocalSyncMap()
+        map.seed([SyncItem(key: "+15550000", data: ["phone": 42], dateUpdated: nil)])
+        let done = expectation(description: "mutated")
+
+        SyncTypedMap<OTPSession>(map).mutateItem(forKey: "+15550000", mutator: { $0 }) { result in
+            guard case .failure(let error) = result else {
+                return XCTFail("Expected a decoding failure")
+            }
+            XCTAssertTrue(error is DecodingError)
+            done.fulfill()
+        }
+        waitForExpectations(timeout: 5)
+
+        XCTAssertEqual(map.item(forKey: "+15550000")?.data["phone"] as? Int, 42)
+    }
+
+    func testCachedPayloadsDecodeFromRawBytes() throws {
+        let codec = SyncPayloadCodec<OTPSession>()
+        let items = try (0..<3).map { SyncItem(key: "+1555000\($0)", data: try codec.encode(session($0)), dateUpdated: nil) }
+        let snapshot = try XCTUnwrap(SyncCacheSnapshot(entity: "otp-sessions", storage: SyncCacheSnapshot.encode(items)))
+
+        let values = try SyncTypedMap<OTPSession>(LocalSyncMap()).values(in: snapshot)
+
+        XCTAssertEqual(values.map(\.value), (0..<3).map(session))
+        XCTAssertNotNil(snapshot.payload(forKey: "+15550001"))
+    }
+
+    func testInPlaceAndByteDecodingAgree() throws {
+        let codec = SyncPayloadCodec<Receipt>()
+        let data = try codec.encode(receipt)
+
+        XCTAssertEqual(try codec.decode(data), receipt)
+        XCTAssertEqual(try codec.decode(bytes: JSONSerialization.data(withJSONObject: data)), receipt)
+    }
+
+    func testLossyValuesFailOnBothDecodePaths() throws {
+        let codec = SyncPayloadCodec<Receipt>()
+        let valid = try codec.encode(receipt)
+        let lossy: [(key: String, value: Any)] = [("attempts", 300), ("attempts", -1), ("attempts", 1.5),
+                                                   ("verified", 1), ("signature", "not base64!")]
+
+        for (key, value) in lossy {
+            var data = valid
+            data[key] = value
+            XCTAssertThrowsError(try codec.decode(data), "\(key): \(value)")
+            XCTAssertThrowsError(try codec.decode(bytes: JSONSerialization.data(withJSONObject: data)), "\(key): \(value)")
+        }
+    }
+
+    func testISO8601DatesDecodeOnBothPaths() throws {
+        let codec = SyncPayloadCodec<Receipt>()
+        var data = try codec.encode(receipt)
+        data["sentAt"] = "2023-11-14T22:13:20Z"
+
+        XCTAssertEqual(try codec.decode(data).sentAt, receipt.sentAt)
+        XCTAssertEqual(try codec.decode(bytes: JSONSerialization.data(withJSONObject: data)).sentAt, receipt.sentAt)
+    }
+
+    func testPerformanceDecodeTenThousandItemsViaJSONRoundTrip() {
+        let items = tenThousandItems()
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric(), XCTMemoryMetric()]) {
+            let decoder = JSONDecoder()
+            decoder.dateDecodingStrategy = .secondsSince1970
+            let sessions = items.compactMap { data in
+                (try? JSONSerialization.data(withJSONObject: data)).flatMap { try? decoder.decode(OTPSession.self, from: $0) }
+            }
+            XCTAssertEqual(sessions.count, items.count)
+        }
+    }
+
+    func testPerformanceDecodeTenThousandItemsInPlace() {
+        let items = tenThousandItems()
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric(), XCTMemoryMetric()]) {
+            let codec = SyncPayloadCodec<OTPSession>()
+            let sessions = items.compactMap { try? codec.decode($0) }
+            XCTAssertEqual(sessions.count, items.count)
+        }
+    }
+
+    func testPerformanceDecodeTenThousandItemsFromRawBytes() throws {
+        let items = tenThousandItems().enumerated().map { SyncItem(key: String(format: "+1555%06d", $0), data: $1, dateUpdated: nil) }
+        let snapshot = try XCTUnwrap(SyncCacheSnapshot(entity: "otp-sessions", storage: SyncCacheSnapshot.encode(items)))
+        let typed = SyncTypedMap<OTPSession>(LocalSyncMap())
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric(), XCTMemoryMetric()]) {
+            XCTAssertEqual((try? typed.values(in: snapshot))?.count, items.count)
+        }
+    }
+}
+
+private struct OTPSession: Codable, Equatable {
+    struct Device: Codable, Equatable {
+        let model: String
+        let build: String?
+    }
+
+    let phone: String
+    let code: String
+    var attempts: Int
+    let verified: Bool
+    let sentAt: Date
+    let channels: [String]
+    let device: Device?
+}
+
+/// Covers the types whose JSON form `SyncDataDecoder` must read exactly like `JSONDecoder`.
+private struct Receipt: Codable, Equatable {
+    let attempts: UInt8
+    let verified: Bool
+    let signature: Data
+    let amount: Decimal
+    let sentAt: Date
+}
+
+private extension SyncTypedMapTests {
+
+    var receipt: Receipt {
+        Receipt(attempts: 3, verified: true, signature: Data([0, 1, 254, 255]), amount: Decimal(12.5),
+                sentAt: Date(timeIntervalSince1970: 1_700_000_000))
+    }
+
+    func session(_ index: Int) -> OTPSession {
+        OTPSession(phone: "+1555000\(index)", code: String(repeating: "\(index)", count: 6), attempts: 0, verified: false,
+                   sentAt: Date(timeIntervalSince1970: 1_700_000_000), channels: ["whatsapp"], device: nil)
+    }
+
+    /// Payloads as Sync hands them out: Foundation objects parsed from JSON.
+    func tenThousandItems() -> [SyncData] {
+        (0..<10_000).map { index in
+            let json = """
+            {"phone":"+1555\(index)","code":"\(100_000 + index)","attempts":\(index % 5),"verified":\(index % 2 == 0),
+             "sentAt":\(1_700_000_000 + index),"channels":["whatsapp","sms"],"device":{"model":"iPhone15,2","build":"21A"}}
+            """
+            return (try? JSONSerialization.jsonObject(with: Data(json.utf8))) as? SyncData ?? [:]
+        }
+    }
+}
@@ -0,0 +1,243 @@
+//
+//  TwilioVerifyConcurrencyTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import TwilioVerifySDK
+
+final class TwilioVerifyConcurrencyTests: XCTestCase {
+
+    private var twilioVerify: MockTwilioVerify!
+
+    override func setUp() {
+        super.setUp()
+        twilioVerify = MockTwilioVerify()
+    }
+
+    func testAsyncApprovalFlow() async throws {
+        let factor = try await XCTUnwrap(twilioVerify.getAllFactors().first)
+        let challenge = try await twilioVerify.getChallenge(challengeSid: "YC123", factorSid: factor.sid)
+        try await twilioVerify.updateChallenge(withPayload: UpdatePushChallengePayload(factorSid: factor.sid, challengeSid: challenge.sid, status: .approved))
+
+        XCTAssertEqual(twilioVerify.approvedChallenges, ["YC123"])
+    }
+
+    func testAsyncFailureThrowsTwilioVerifyError() async {
+        twilioVerify.error = .networkError(error: NetworkError.invalidData)
+
+        do {
+            _ = try await twilioVerify.getChallenge(challengeSid: "YC123", factorSid: "YF123")
+            XCTFail("Expected an error")
+        } catch {
+            XCTAssertTrue(error is TwilioVerifyError)
+        }
+    }
+
+    func testCancelledTaskDoesNotStartOperation() async {
+        let twilioVerify = self.twilioVerify!
+        let task = Task { () -> Challenge in
+            withUnsafeCurrentTask { $0?.cancel() }
+            return try await twilioVerify.getChallenge(challengeSid: "YC123", factorSid: "YF123")
+        }
+
+        do {
+            _ = try await task.value
+            XCTFail("Expected a cancellation")
+        } catch {
+            XCTAssertTrue(error is CancellationError)
+        }
+        XCTAssertEqual(twilioVerify.operations, 0)
+    }
+
+    func testFactorStoreLoadsOnceAndTracksChanges() async throws {
+        let store = FactorStore(twilioVerify: twilioVerify)
+
+        async let first = store.allFactors()
+        async let second = store.allFactors()
+        _ = try await (first, second)
+        try await store.deleteFactor(withSid: "YF123")
+
+        let factors = try await store.allFactors()
+        XCTAssertTrue(factors.isEmpty)
+        XCTAssertEqual(twilioVerify.factorLoads, 1)
+    }
+
+    func testFactorStoreDiscardsALoadThatRacesADelete() async throws {
+        twilioVerify.loadDelay = 0.2
+        let store = FactorStore(twilioVerify: twilioVerify)
+
+        async let loading = store.allFactors()
+        try await Task.sleep(nanoseconds: 20_000_000)
+        try await store.deleteFactor(withSid: "YF123")
+
+        let factors = try await loading
+        XCTAssertTrue(factors.isEmpty)
+        XCTAssertEqual(twilioVerify.factorLoads, 2)
+    }
+
+    func testPerformanceClosureApproval() {
+        let twilioVerify = self.twilioVerify!
+        let lock = NSLock()
+        var threads = Set<pthread_t>()
+        let recordThread = {
+            lock.lock()
+            threads.insert(pthread_self())
+            lock.unlock()
+        }
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let expectation = self.expectation(description: "approvals")
+            expectation.expectedFulfillmentCount = Constants.approvals
+            for _ in 0..<Constants.approvals {
+                twilioVerify.getAllFactors(success: { factors in
+                    recordThread()
+                    twilioVerify.getChallenge(challengeSid: "YC123", factorSid: factors[0].sid, success: { challenge in
+                        recordThread()
+                        let payload = UpdatePushChallengePayload(factorSid: challenge.factorSid, challengeSid: challenge.sid, status: .approved)
+                        twilioVerify.updateChallenge(withPayload: payload, success: {
+                            expectation.fulfill()
+                        }, failure: { _ in })
+                    }, failure: { _ in })
+                }, failure: { _ in })
+            }
+            wait(for: [expectation], timeout: 10)
+        }
+        XCTAssertFalse(threads.isEmpty)
+    }
+
+    func testPerformanceAsyncApproval() {
+        let twilioVerify = self.twilioVerify!
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            let expectation = self.expectation(description: "approvals")
+            let approvals = Task { () -> Int in
+                var hops = 0
+                var thread = pthread_self()
+                for _ in 0..<Constants.approvals {
+                    let factors = try await twilioVerify.getAllFactors()
+                    let challenge = try await twilioVerify.getChallenge(challengeSid: "YC123", factorSid: factors[0].sid)
+                    try await twilioVerify.updateChallenge(withPayload: UpdatePushChallengePayload(factorSid: challenge.factorSid, challengeSid: challenge.sid, status: .approved))
+                    if pthread_self() != thread {
+                        hops += 1
+                        thread = pthread_self()
+                    }
+                }
+                return hops
+            }
+            Task {
+                let hops = try await approvals.value
+                XCTAssertLessThanOrEqual(hops, Constants.approvals)
+                expectation.fulfill()
+            }
+            wait(for: [expectation], timeout: 10)
+        }
+    }
+}
+
+private extension TwilioVerifyConcurrencyTests {
+    struct Constants {
+        static let approvals = 500
+    }
+}
+
+final class MockTwilioVerify: TwilioVerify {
+    var error: TwilioVerifyError?
+    var delay: TimeInterval = 0
+    var loadDelay: TimeInterval = 0
+    private(set) var lastToken: VerifyCancellationToken?
+    private(set) var operations = 0
+    private(set) var factorLoads = 0
+    private(set) var approvedChallenges: [String] = []
+    private var storedSids = ["YF123"]
+    private let queue = DispatchQueue(label: "MockTwilioVerify", attributes: .concurrent)
+    private let lock = NSLock()
+
+    func createFactor(withPayload payload: FactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        return complete(MockFactor(sid: "YF123"), success: success, failure: failure)
+    }
+
+    func verifyFactor(withPayload payload: VerifyFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        return complete(MockFactor(sid: payload.sid), success: success, failure: failure)
+    }
+
+    func updateFactor(withPayload payload: UpdateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        return complete(MockFactor(sid: payload.sid), success: success, failure: failure)
+    }
+
+    func getAllFactors(success: @escaping FactorListSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        var factors: [Factor] = []
+        record {
+            factorLoads += 1
+            factors = storedSids.map { MockFactor(sid: $0) }
+        }
+        return complete(factors, after: loadDelay, success: success, failure: failure)
+    }
+
+    func deleteFactor(withSid sid: String, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        record { storedSids.removeAll { $0 == sid } }
+        return complete((), success: success, failure: failure)
+    }
+
+    func getChallenge(challengeSid: String, factorSid: String, success: @escaping ChallengeSuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        return complete(MockChallenge(sid: challengeSid, factorSid: factorSid), success: success, failure: failure)
+    }
+
+    func updateChallenge(withPayload payload: UpdateChallengePayload, success: @escaping EmptySuccessBlock, failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        record { approvedChallenges.append(payload.challengeSid) }
+        return complete((), success: success, failure: failure)
+    }
+
+    func getAllChallenges(withPayload payload: ChallengeListPayload, success: @escaping (ChallengeList) -> (), failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        let list = FactorChallengeList(challenges: [MockChallenge(sid: "YC123", factorSid: payload.factorSid)],
+                                       metadata: ChallengeListMetadata(page: 0, pageSize: payload.pageSize, previousPageToken: nil, nextPageToken: nil))
+        return complete(list, success: success, failure: failure)
+    }
+
+    func clearLocalStorage() throws {}
+
+    private func record(_ update: () -> Void) {
+        lock.lock()
+        update()
+        lock.unlock()
+    }
+
+    private func complete<T>(_ value: T, after delay: TimeInterval? = nil, success: @escaping (T) -> (), failure: @escaping TwilioVerifyErrorBlock) -> VerifyCancellationToken {
+        record { operations += 1 }
+        let error = self.error
+        let token = VerifyCancellationToken()
+        record { lastToken = token }
+        queue.asyncAfter(deadline: .now() + (delay ?? self.delay)) {
+            guard token.finish() else {
+                return
+            }
+            if let error = error {
+                failure(error)
+            } else {
+                success(value)
+            }
+        }
+        return token
+    }
+}
+
+struct MockFactor: Factor {
+    var status: FactorStatus = .verified
+    let sid: String
+    let friendlyName = "iPhone"
+    let accountSid = "AC123"
+    let serviceSid = "VA123"
+    let identity = "identity"
+    let type: FactorType = .push
+    let createdAt = Date()
+    let metadata: [String: String]? = nil
+}
+
+struct MockChallenge: Challenge {
+    let sid: String
+    let challengeDetails = ChallengeDetails(message: "Approve sign in", fields: [], date: nil)
+    let hiddenDetails: [String: String]? = nil
+    let factorSid: String
+    let status: ChallengeStatus = .pending
+    let createdAt = Date()
+    let updatedAt = Date()
+    let expirationDate = Date().addingTimeInterval(300)
+}
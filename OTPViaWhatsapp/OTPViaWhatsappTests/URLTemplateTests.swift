@@ -0,0 +1,77 @@
+//
+//  URLTemplateTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import TwilioVerifySDK
+
+final class URLTemplateTests: XCTestCase {
+
+    private let baseURL = "https://verify.twilio.com/v2/"
+    private let path = FactorAPIClient.Constants.verifyFactorURL
+
+    func testRenderMatchesStringReplacementForPlainValues() throws {
+        let url = try URLTemplate(baseURL + path).render([.serviceSid: "VA123", .identity: "user@example.com", .factorSid: "YF456"])
+
+        XCTAssertEqual(url, legacyURL(serviceSid: "VA123", identity: "user@example.com", factorSid: "YF456"))
+    }
+
+    func testInsertedValuesAreEscapedAsPathSegments() throws {
+        let url = try URLTemplate(baseURL + path).render([.serviceSid: "VA123", .identity: "ana/dev ops?#é", .factorSid: "YF456"])
+
+        XCTAssertEqual(url.absoluteString, "https://verify.twilio.com/v2/Services/VA123/Entities/ana%2Fdev%20ops%3F%23%C3%A9/Factors/YF456")
+        XCTAssertEqual(url.pathComponents.count, 8)
+    }
+
+    func testMissingPlaceholderThrows() {
+        XCTAssertThrowsError(try URLTemplate(baseURL + path).render([.serviceSid: "VA123", .identity: "user"]))
+    }
+
+    func testPlaceholdersMatchAPIConstants() {
+        XCTAssertEqual(URLTemplate.Placeholder.serviceSid.rawValue, APIConstants.serviceSidPath)
+        XCTAssertEqual(URLTemplate.Placeholder.identity.rawValue, APIConstants.identityPath)
+        XCTAssertEqual(URLTemplate.Placeholder.factorSid.rawValue, APIConstants.factorSidPath)
+        XCTAssertEqual(URLTemplate.Placeholder.challengeSid.rawValue, APIConstants.challengeSidPath)
+    }
+
+    func testCacheRendersPerServiceAndIdentity() throws {
+        let cache = URLTemplateCache(baseURL: baseURL, limit: 1)
+
+        let first = try cache.url(for: path, serviceSid: "VA1", identity: "alice", values: [.factorSid: "YF1"])
+        let second = try cache.url(for: path, serviceSid: "VA1", identity: "bob", values: [.factorSid: "YF2"])
+        let third = try cache.url(for: path, serviceSid: "VA1", identity: "alice", values: [.factorSid: "YF3"])
+
+        XCTAssertEqual(first.absoluteString, "https://verify.twilio.com/v2/Services/VA1/Entities/alice/Factors/YF1")
+        XCTAssertEqual(second.absoluteString, "https://verify.twilio.com/v2/Services/VA1/Entities/bob/Factors/YF2")
+        XCTAssertEqual(third.absoluteString, "https://verify.twilio.com/v2/Services/VA1/Entities/alice/Factors/YF3")
+    }
+
+    func testPerformanceTemplateURL() {
+        let cache = URLTemplateCache(baseURL: baseURL)
+
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for index in 0..<10_000 {
+                _ = try? cache.url(for: path, serviceSid: "VA123", identity: "user@example.com", values: [.factorSid: "YF\(index)"])
+            }
+        }
+    }
+
+    func testPerformanceLegacyURL() {
+        measure(metrics: [XCTCPUMetric(), XCTClockMetric()]) {
+            for index in 0..<10_000 {
+                _ = legacyURL(serviceSid: "VA123", identity: "user@example.com", factorSid: "YF\(index)")
+            }
+        }
+    }
+}
+
+private extension URLTemplateTests {
+    func legacyURL(serviceSid: String, identity: String, factorSid: String) -> URL? {
+        let url = "\(baseURL)\(path)"
+            .replacingOccurrences(of: APIConstants.serviceSidPath, with: serviceSid)
+            .replacingOccurrences(of: APIConstants.identityPath, with: identity)
+            .replacingOccurrences(of: APIConstants.factorSidPath, with: factorSid)
+        return url.addingPercentEncoding(withAllowedCharacters: .urlQueryAllowed).flatMap { URL(string: $0) }
+    }
+}
@@ -0,0 +1,297 @@
+//
+//  VerifyCancellationTokenTests.swift
+//  OTPViaWhatsappTests
+//
+
+import XCTest
+@testable import TwilioVerifySDK
+
+final class VerifyCancellationTokenTests: XCTestCase {
+
+    func testCancelRunsHandlersOnceAndCancelsNestedTokens() {
+        var cancellations = 0
+        let token = VerifyCancellationToken { cancellations += 1 }
+        let nested = VerifyCancellationToken()
+        token.add(nested)
+
+        token.cancel()
+        token.cancel()
+
+        XCTAssertTrue(token.isCancelled)
+        XCTAssertTrue(nested.isCancelled)
+        XCTAssertEqual(cancellations, 1)
+    }
+
+    func testHandlerAddedAfterCancelRunsImmediately() {
+        let token = VerifyCancellationToken()
+        token.cancel()
+        var handled = false
+
+        token.onCancel { handled = true }
+
+        XCTAssertTrue(handled)
+    }
+
+    func testCancelAfterFinishHasNoEffect() {
+        var handled = false
+        let token = VerifyCancellationToken { handled = true }
+
+        XCTAssertTrue(token.finish())
+        token.cancel()
+
+        XCTAssertFalse(token.isCancelled)
+        XCTAssertFalse(handled)
+    }
+
+    func testNetworkAdapterCancelAbortsTaskWithoutCallbacks() {
+        let configuration = URLSessionConfiguration.ephemeral
+        configuration.protocolClasses = [StalledURLProtocol.self]
+        let adapter = NetworkAdapter(withSession: URLSession(configuration: configuration))
+        let stopped = expectation(forNotification: StalledURLProtocol.stoppedNotification, object: nil)
+        let callback = expectation(description: "no callback")
+        callback.isInverted = true
+
+        // swiftlint:disable:next force_unwrapping
+        let token = adapter.execute(URLRequest(url: URL(string: "https://verify.twilio.com/v2/Services")!), success: { _ in
+            callback.fulfill()
+        }, failure: { _ in
+            callback.fulfill()
+        })
+        token.cancel()
+
+        wait(for: [stopped, callback], timeout: 1)
+    }
+
+    func testCancelledRepositorySkipsMappingAndSaving() {
+        let apiClient = DeferredFactorAPIClient()
+        let storage = CountingStorage()
+        let repository = FactorRepository(apiClient: apiClient, storage: storage)
+        let callback = expectation(description: "no callback")
+        callback.isInverted = true
+
+        let token = repository.verify(MockFactor(sid: "YF123"), payload: "payload", success: { _ in
+            callback.fulfill()
+        }, failure: { _ in
+            callback.fulfill()
+        })
+        token.cancel()
+        apiClient.respond(with: Data("{\"status\":\"verified\"}".utf8))
+
+        wait(for: [callback], timeout: 0.5)
+        XCTAssertTrue(apiClient.token.isCancelled)
+        XCTAssertEqual(storage.saves, 0)
+    }
+
+    func testFactorSavedAfterCancelIsDeleted() {
+        let repository = DeferredFactorProvider()
+        let keyStorage = CountingKeyStorage()
+        let factory = PushFactory(repository: repository, keyStorage: keyStorage)
+        let callback = expectation(description: "no callback")
+        callback.isInverted = true
+
+        let token = factory.createFactor(withAccessToken: "token", friendlyName: "iPhone", serviceSid: "VA123", identity: "identity",
+                                         pushToken: nil, metadata: nil, success: { _ in
+            callback.fulfill()
+        }, failure: { _ in
+            callback.fulfill()
+        })
+        token.cancel()
+        repository.respond(with: PushFactor(sid: "YF123", friendlyName: "iPhone", accountSid: "AC123", serviceSid: "VA123",
+                                            identity: "identity", createdAt: Date(), config: Config(credentialSid: "CR123")))
+
+        wait(for: [callback], timeout: 0.5)
+        XCTAssertEqual(keyStorage.deletedAliases.count, 1)
+        XCTAssertEqual(repository.deletedSids, ["YF123"])
+        XCTAssertEqual(repository.remotelyDeletedSids, [])
+    }
+
+    func testFactorCreatedWhileCancellingIsDeletedFromTheAPI() {
+        let repository = DeferredFactorProvider()
+        repository.factorOnCancel = PushFactor(sid: "YF123", friendlyName: "iPhone", accountSid: "AC123", serviceSid: "VA123",
+                                               identity: "identity", createdAt: Date(), config: Config(credentialSid: "CR123"))
+        let keyStorage = CountingKeyStorage()
+        let factory = PushFactory(repository: repository, keyStorage: keyStorage)
+        let callback = expectation(description: "no callback")
+        callback.isInverted = true
+
+        let token = factory.createFactor(withAccessToken: "token", friendlyName: "iPhone", serviceSid: "VA123", identity: "identity",
+                                         pushToken: nil, metadata: nil, success: { _ in
+            callback.fulfill()
+        }, failure: { _ in
+            callback.fulfill()
+        })
+        token.cancel()
+
+        wait(for: [callback], timeout: 0.5)
+        XCTAssertEqual(repository.remotelyDeletedSids, ["YF123"])
+        XCTAssertEqual(repository.remotelyDeletedAliases.count, 1)
+        XCTAssertEqual(keyStorage.deletedAliases, repository.remotelyDeletedAliases)
+    }
+
+    func testCancellingAsyncTaskCancelsOperation() async {
+        let twilioVerify = MockTwilioVerify()
+        twilioVerify.delay = 5
+        let task = Task { try await twilioVerify.getChallenge(challengeSid: "YC123", factorSid: "YF123") }
+
+        while twilioVerify.lastToken == nil {
+            await Task.yield()
+        }
+        task.cancel()
+
+        do {
+            _ = try await task.value
+            XCTFail("Expected a cancellation")
+        } catch {
+            XCTAssertTrue(error is CancellationError)
+        }
+        XCTAssertEqual(twilioVerify.lastToken?.isCancelled, true)
+    }
+}
+
+private final class StalledURLProtocol: URLProtocol {
+    static let stoppedNotification = Notification.Name("StalledURLProtocolStopped")
+
+    override class func canInit(with request: URLRequest) -> Bool {
+        true
+    }
+
+    override class func canonicalRequest(for request: URLRequest) -> URLRequest {
+        request
+    }
+
+    override func startLoading() {}
+
+    override func stopLoading() {
+        NotificationCenter.default.post(name: StalledURLProtocol.stoppedNotification, object: nil)
+    }
+}
+
+private final class DeferredFactorAPIClient: FactorAPIClientProtocol {
+    private(set) var token = VerifyCancellationToken()
+    private var success: SuccessResponseBlock?
+
+    func respond(with data: Data) {
+        success?(NetworkResponse(data: data, headers: [:]))
+    }
+
+    func create(withPayload payload: CreateFactorPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        hold(success)
+    }
+
+    func verify(_ factor: Factor, authPayload: String, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        hold(success)
+    }
+
+    func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        hold { _ in success() }
+    }
+
+    func update(_ factor: Factor, updateFactorDataPayload: UpdateFactorDataPayload, success: @escaping SuccessResponseBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        hold(success)
+    }
+
+    // Delivers the response even after cancellation, like a request that already completed on the wire.
+    private func hold(_ success: @escaping SuccessResponseBlock) -> VerifyCancellationToken {
+        self.success = success
+        token = VerifyCancellationToken()
+        return token
+    }
+}
+
+private final class CountingStorage: StorageProvider {
+    let version = 1
+    private(set) var saves = 0
+
+    func save(_ data: Data, withKey key: String) throws {
+        saves += 1
+    }
+
+    func get(_ key: String) throws -> Data {
+        throw StorageError.error("Not found")
+    }
+
+    func removeValue(for key: String) throws {}
+
+    func getAll() throws -> [Data] {
+        []
+    }
+
+    func clear() throws {}
+}
+
+/// Hands the created factor back even after cancellation, like a repository that saved it just before.
+/// With `factorOnCancel` set, the factor arrives while the cancellation is still running.
+private final class DeferredFactorProvider: FactorProvider {
+    var factorOnCancel: Factor?
+    private(set) var deletedSids: [String] = []
+    private(set) var remotelyDeletedSids: [String] = []
+    private(set) var remotelyDeletedAliases: [String] = []
+    private var success: FactorSuccessBlock?
+
+    func respond(with factor: Factor) {
+        success?(factor)
+    }
+
+    func create(withPayload payload: CreateFactorPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        self.success = success
+        return VerifyCancellationToken { [weak self] in
+            guard let factor = self?.factorOnCancel else {
+                return
+            }
+            self?.respond(with: factor)
+        }
+    }
+
+    func verify(_ factor: Factor, payload: String, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        .finished
+    }
+
+    func update(withPayload payload: UpdateFactorDataPayload, success: @escaping FactorSuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        .finished
+    }
+
+    func delete(_ factor: Factor, success: @escaping EmptySuccessBlock, failure: @escaping FailureBlock) -> VerifyCancellationToken {
+        remotelyDeletedSids.append(factor.sid)
+        remotelyDeletedAliases += [(factor as? PushFactor)?.keyPairAlias].compactMap { $0 }
+        success()
+        return .finished
+    }
+
+    func delete(_ factor: Factor) throws {
+        deletedSids.append(factor.sid)
+    }
+
+    func getAll() throws -> [Factor] {
+        []
+    }
+
+    func get(withSid sid: String) throws -> Factor {
+        throw StorageError.error("Not found")
+    }
+
+    func save(_ factor: Factor) throws -> Factor {
+        factor
+    }
+
+    func clearLocalStorage() throws {}
+}
+
+private final class CountingKeyStorage: KeyStorage {
+    private(set) var deletedAliases: [String] = []
+
+    func createKey(withAlias alias: String) throws -> String {
+        "public-key"
+    }
+
+    func sign(withAlias alias: String, message: String) throws -> Data {
+        Data()
+    }
+
+    func signAndEncode(withAlias alias: String, message: String) throws -> String {
+        ""
+    }
+
+    func deleteKey(withAlias alias: String) throws {
+        deletedAliases.append(alias)
+    }
+}